@@ -26,114 +26,69 @@
 #include "cat_operations.h"
 
 #include "catalog_po.h"
-#include "concurrency.h"
+#include "configuration.h"
 #include "progress.h"
 
-#include <map>
-#include <set>
 
-
-namespace
-{
-
-inline MergeStats::Key make_key_full(const CatalogItemPtr& i)
-{
-    return {i->GetRawString(), i->GetRawPluralString(), i->GetContext(), i->GetRawSymbolicId()};
-}
-
-template<auto MakeKey = make_key_full, typename TFunc>
-inline void build_item_keys(CatalogPtr cat, TFunc&& f)
+void ComputeMergeStats(MergeStats& r, CatalogPtr po, CatalogPtr refcat)
 {
-    for (auto& i: cat->items())
-    {
-        f(MakeKey(i), i);
-    }
+    Progress progress(1);
+    ComputeMergeStats(r, po->items(), refcat->items());
+    progress.increment();
 }
 
-template<auto MakeKey = make_key_full, typename T>
-inline void build_item_map(T& map, CatalogPtr cat)
-{
-    build_item_keys<MakeKey>(cat, [&](auto&& key, CatalogItemPtr i){ map.emplace(key, i); });
-}
 
-template<auto MakeKey = make_key_full, typename T>
-inline void build_item_set(T& map, CatalogPtr cat)
+MergeResult MergeCatalogWithReferencePO(POCatalogPtr catalog, POCatalogPtr ref, MergeStats *stats)
 {
-    build_item_keys<MakeKey>(cat, [&](auto&& key, CatalogItemPtr){ map.insert(key); });
-}
-
-} // anonymous namespace
-
-
-void ComputeMergeStats(MergeStats& r, CatalogPtr po, CatalogPtr refcat)
-{
-    Progress progress(2);
-
-    r.added.clear();
-    r.removed.clear();
-
-    // First collect all strings from both sides, then diff the sets.
-    // Run the two sides in parallel for speed up on large files.
-
-    std::set<MergeStats::Key> strsThis, strsRef;
+    if (!catalog || !ref)
+        return {};
 
-    auto collect1 = dispatch::async([&]{ build_item_set(strsThis, po); });
-    auto collect2 = dispatch::async([&]{ build_item_set(strsRef, refcat); });
+    // Merging translations computes the stats as a by-product, but POT files
+    // are simply replaced with the reference:
+    if (stats && catalog->GetFileType() != Catalog::Type::PO)
+        ComputeMergeStats(*stats, catalog, ref);
 
-    collect1.get();
-    collect2.get();
-    progress.increment();
+    if (!catalog->UpdateFromPOT(ref, /*replace_header=*/false, stats))
+        return {};
 
-    auto add1 = dispatch::async([&]
-    {
-        for (auto& i: strsThis)
-        {
-            if (strsRef.find(i) == strsRef.end())
-                r.removed.push_back(i);
-        }
-    });
-
-    auto add2 = dispatch::async([&]
-    {
-        for (auto& i: strsRef)
-        {
-            if (strsThis.find(i) == strsThis.end())
-                r.added.push_back(i);
-        }
-    });
-
-    add1.get();
-    add2.get();
-    progress.increment();
+    return {catalog};
 }
 
 
-MergeResult MergeCatalogWithReferencePO(POCatalogPtr catalog, POCatalogPtr ref)
+MergeResult MergeCatalogWithReferenceGeneric(CatalogPtr catalog, CatalogPtr ref, MergeStats *stats)
 {
-    if (!catalog || !ref)
+    if (!catalog || !ref || catalog->GetFileType() != ref->GetFileType())
         return {};
 
-    if (!catalog->UpdateFromPOT(ref))
-        return {};
+    if (stats)
+        ComputeMergeStats(*stats, catalog, ref);
 
-    return {catalog};
+    // The reference file has the new structure, so it becomes the updated catalog:
+    ref->TakeTranslationsFrom(*catalog, Config::MergeBehavior() != Merge_None);
+    ref->SetFileName(catalog->GetFileName());
+    ref->AttachCloudSync(catalog->GetCloudSync());
+
+    return {ref};
 }
 
 
-MergeResult MergeCatalogWithReferenceRaw(CatalogPtr catalog, CatalogPtr reference)
+MergeResult MergeCatalogWithReferenceRaw(CatalogPtr catalog, CatalogPtr reference, MergeStats *stats)
 {
     auto po_catalog = std::dynamic_pointer_cast<POCatalog>(catalog);
     auto po_ref = std::dynamic_pointer_cast<POCatalog>(reference);
 
-    return MergeCatalogWithReferencePO(po_catalog, po_ref);
+    if (po_catalog || po_ref)
+        return MergeCatalogWithReferencePO(po_catalog, po_ref, stats);
+    else
+        return MergeCatalogWithReferenceGeneric(catalog, reference, stats);
 }
 
 
-MergeResult MergeCatalogWithReference(CatalogPtr catalog, CatalogPtr reference)
+MergeResult MergeCatalogWithReference(CatalogPtr catalog, CatalogPtr reference, MergeStats *stats)
 {
     auto sideloaded = catalog->GetSideloadedSourceData();
 
-    auto r = MergeCatalogWithReferenceRaw(catalog, reference);
+    auto r = MergeCatalogWithReferenceRaw(catalog, reference, stats);
 
     if (sideloaded && r.updated_catalog)
     {
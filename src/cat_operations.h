@@ -88,17 +88,31 @@ struct MergeResult
  */
 extern void ComputeMergeStats(MergeStats& r, CatalogPtr catalog, CatalogPtr reference);
 
+/**
+    Same as above, but for catalogs' items. Implemented in catalog_po_merge.cpp,
+    which uses it when merging.
+ */
+extern void ComputeMergeStats(MergeStats& r, const CatalogItemArray& items, const CatalogItemArray& refItems);
+
 
 /**
     Merges catalog with a reference catalog, updating catalog with new strings
     present in @a reference and removing strings that are no longer present there.
 
+    If @a stats is provided, it is filled with the differences between the
+    catalogs, as ComputeMergeStats() would compute them, but without the cost
+    of comparing the catalogs separately.
+
+    PO files are merged the same way msgmerge does. Other formats can only be
+    merged with a reference file of the same type, whose structure the updated
+    catalog then has (see Catalog::TakeTranslationsFrom()).
+
     @note The returned updated_catalog may be the same as @a catalog, but it may also be
           a new object, possibly also @a reference. Don't make assumptions about it and
           always treat it as an entirely new object.
 
     @warning The @a reference object cannot be used after being passed to this function!
  */
-extern MergeResult MergeCatalogWithReference(CatalogPtr catalog, CatalogPtr reference);
+extern MergeResult MergeCatalogWithReference(CatalogPtr catalog, CatalogPtr reference, MergeStats *stats = nullptr);
 
 #endif // Poedit_cat_operations_h
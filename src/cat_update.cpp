@@ -30,6 +30,7 @@
 #include "custom_notebook.h"
 #include "errors.h"
 #include "extractors/extractor.h"
+#include "filemonitor.h"
 #include "hidpi.h"
 #include "progress_ui.h"
 #include "utility.h"
@@ -52,6 +53,8 @@
 #include <wx/stdpaths.h>
 #include <wx/wupdlock.h>
 
+#include <map>
+
 
 namespace
 {
@@ -221,23 +224,13 @@ struct InterimResults
 };
 
 
-InterimResults ExtractPOTFromSources(CatalogPtr catalog, dispatch::cancellation_token_ptr cancellation)
+InterimResults ExtractPOTFromSourceCode(const SourceCodeSpec& spec, dispatch::cancellation_token_ptr cancellation)
 {
-    auto po = std::dynamic_pointer_cast<POCatalog>(catalog);
-    if (!po)
-        BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
-
     Progress progress(1);
     progress.message(_(L"Collecting source files…"));
 
-    auto spec = catalog->GetSourceCodeSpec();
-    if (!spec)
-    {
-        BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::NoSourcesFound));
-    }
-
     InterimResults output;
-    auto files = Extractor::CollectAllFiles(*spec, cancellation);
+    auto files = Extractor::CollectAllFiles(spec, cancellation);
 
     progress.message
     (
@@ -254,7 +247,7 @@ InterimResults ExtractPOTFromSources(CatalogPtr catalog, dispatch::cancellation_
     if (!files.empty())
     {
         TempDirectory tmpdir;
-        auto result = Extractor::ExtractWithAll(tmpdir, *spec, files, cancellation);
+        auto result = Extractor::ExtractWithAll(tmpdir, spec, files, cancellation);
         if (!result)
             BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
 
@@ -279,6 +272,22 @@ InterimResults ExtractPOTFromSources(CatalogPtr catalog, dispatch::cancellation_
 }
 
 
+InterimResults ExtractPOTFromSources(CatalogPtr catalog, dispatch::cancellation_token_ptr cancellation)
+{
+    auto po = std::dynamic_pointer_cast<POCatalog>(catalog);
+    if (!po)
+        BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
+
+    auto spec = catalog->GetSourceCodeSpec();
+    if (!spec)
+    {
+        BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::NoSourcesFound));
+    }
+
+    return ExtractPOTFromSourceCode(*spec, cancellation);
+}
+
+
 InterimResults ExtractPOTFromSourcesWithExplanatoryErrors(CatalogPtr catalog, dispatch::cancellation_token_ptr cancellation)
 {
     try
@@ -361,6 +370,47 @@ InterimResults LoadReferenceFile(const wxString& ref_file)
 }
 
 
+// Identifies source code configuration for the purpose of extraction; catalogs
+// with the same key can be updated from the same extracted POT file
+wxString SourceCodeSpecKey(const SourceCodeSpec& spec)
+{
+    auto base = wxFileName::DirName(spec.BasePath);
+    base.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
+
+    wxString key = base.GetFullPath();
+    auto add = [&key](const wxString& s)
+    {
+        key += '\x01';
+        key += s;
+    };
+
+    for (auto& p: spec.SearchPaths)
+        add("p:" + p);
+    for (auto& p: spec.ExcludedPaths)
+        add("x:" + p);
+    for (auto& k: spec.Keywords)
+        add("k:" + k);
+    add("c:" + spec.Charset);
+    for (auto& m: spec.TypeMapping)
+        add("m:" + m.first + "=" + m.second);
+
+    // Paths-related headers were already resolved above and differ between
+    // files in different directories; other X-Poedit headers may affect
+    // extraction (e.g. X-Poedit-Flags-xgettext), except for bookmarks:
+    for (auto& h: spec.XHeaders)
+    {
+        if (!h.first.StartsWith("X-Poedit-") ||
+            h.first.StartsWith("X-Poedit-Basepath") ||
+            h.first.StartsWith("X-Poedit-SearchPath") ||
+            h.first == "X-Poedit-Bookmarks")
+            continue;
+        add("h:" + h.first + "=" + h.second);
+    }
+
+    return key;
+}
+
+
 template<typename Func>
 dispatch::future<CatalogPtr> DoPerformUpdateWithUI(wxWindow *parent,
                                                    CatalogPtr catalog,
@@ -390,17 +440,9 @@ dispatch::future<CatalogPtr> DoPerformUpdateWithUI(wxWindow *parent,
         stats.errors = data.errors;
 
         {
-            Progress subtask(1, p, (100 - timeCostObtainPOT) / 2);
-            subtask.message(_(L"Determining differences…"));
-            ComputeMergeStats(stats, catalog, data.reference);
-        }
-
-        cancellation->throw_if_cancelled();
-
-        {
-            Progress subtask(1, p, (100 - timeCostObtainPOT) / 2);
+            Progress subtask(1, p, 100 - timeCostObtainPOT);
             subtask.message(_(L"Merging differences…"));
-            *merge_result = MergeCatalogWithReference(catalog, data.reference);
+            *merge_result = MergeCatalogWithReference(catalog, data.reference, &stats);
             if (!(*merge_result))
                 BOOST_THROW_EXCEPTION( BackgroundTaskException(_("Failed to load file with extracted translations.")) );
 
@@ -461,9 +503,228 @@ MergeResult PerformUpdateFromSourcesSimple(CatalogPtr catalog)
 }
 
 
+int PerformUpdateFromSourcesBatch(const wxArrayString& files, dispatch::cancellation_token_ptr cancellation)
+{
+    Progress progress(100);
+
+    // Load all files first to find out how their sources are configured. Only
+    // the configuration is kept, files are loaded again when merging, so that
+    // all of them aren't in memory at the same time:
+    std::vector<std::shared_ptr<SourceCodeSpec>> specs(files.size());
+    {
+        Progress subtask((int)files.size(), progress, 10);
+        subtask.message(_(L"Loading translation files…"));
+        dispatch::parallel_for(files.size(), dispatch::default_parallelism(), [&](size_t i)
+        {
+            if (cancellation->is_cancelled())
+                return;
+            try
+            {
+                auto cat = POCatalog::Create(files[i]);
+                if (cat->HasSourcesConfigured())
+                    specs[i] = cat->GetSourceCodeSpec();
+            }
+            catch (...)
+            {
+                wxLogTrace("poedit", "failed to load %s for update: %s", files[i], DescribeCurrentException());
+            }
+            subtask.increment();
+        });
+    }
+    cancellation->throw_if_cancelled();
+
+    std::map<wxString, std::vector<size_t>> groups;
+    for (size_t i = 0; i < specs.size(); i++)
+    {
+        if (specs[i])
+            groups[SourceCodeSpecKey(*specs[i])].push_back(i);
+    }
+
+    if (groups.empty())
+        return 0;
+
+    // Extract strings once per group:
+    std::vector<std::pair<size_t, CatalogPtr>> jobs;
+    {
+        Progress subtask((int)groups.size(), progress, 60);
+        for (auto& g: groups)
+        {
+            Progress groupProgress(1, subtask, 1);
+            auto data = ExtractPOTFromSourceCode(*specs[g.second.front()], cancellation);
+            for (auto i: g.second)
+                jobs.emplace_back(i, data.reference);
+            groupProgress.increment();
+        }
+    }
+    cancellation->throw_if_cancelled();
+
+    // Merge and save all files in parallel. The reference is shared by all
+    // files in the group, which is safe, because merging PO files only reads
+    // from it:
+    std::atomic<int> updated(0);
+    {
+        Progress subtask((int)jobs.size(), progress, 30);
+        subtask.message(_(L"Merging differences…"));
+        dispatch::parallel_for(jobs.size(), dispatch::default_parallelism(), [&](size_t j)
+        {
+            if (cancellation->is_cancelled())
+                return;
+
+            const size_t i = jobs[j].first;
+            auto merged = MergeCatalogWithReference(POCatalog::Create(files[i]), jobs[j].second);
+            if (merged)
+            {
+                Catalog::ValidationResults validation_results;
+                Catalog::CompilationStatus mo_status;
+                if (merged.updated_catalog->Save(files[i], false, validation_results, mo_status))
+                    updated++;
+            }
+            subtask.increment();
+        });
+    }
+
+    return updated;
+}
+
+
+std::shared_ptr<BackgroundSourcesUpdater> BackgroundSourcesUpdater::Create(CatalogPtr catalog, ChangedHandler onChanged)
+{
+    std::shared_ptr<BackgroundSourcesUpdater> updater(new BackgroundSourcesUpdater(catalog, onChanged));
+    auto spec = catalog->GetSourceCodeSpec();
+    if (spec)
+        updater->m_monitor = std::make_unique<SourcesMonitor>(*spec, [self = updater.get()]{ self->OnSourcesChanged(); });
+    updater->Extract();
+    return updater;
+}
+
+
+BackgroundSourcesUpdater::BackgroundSourcesUpdater(CatalogPtr catalog, ChangedHandler onChanged)
+    : m_catalog(catalog), m_onChanged(onChanged), m_running(false), m_outdated(false)
+{
+    auto spec = catalog->GetSourceCodeSpec();
+    if (spec)
+        m_specKey = SourceCodeSpecKey(*spec);
+}
+
+
+BackgroundSourcesUpdater::~BackgroundSourcesUpdater()
+{
+    if (m_cancellation)
+        m_cancellation->cancel();
+}
+
+
+bool BackgroundSourcesUpdater::IsFor(CatalogPtr catalog) const
+{
+    if (m_catalog.lock() != catalog)
+        return false;
+    auto spec = catalog->GetSourceCodeSpec();
+    return spec && SourceCodeSpecKey(*spec) == m_specKey;
+}
+
+
+std::shared_ptr<BackgroundSourcesUpdater::Result> BackgroundSourcesUpdater::TakeResult()
+{
+    if (m_running || m_outdated || (m_monitor && m_monitor->HasPendingChanges()))
+        return nullptr;
+
+    auto result = m_result;
+    m_result.reset();
+    return result;
+}
+
+
+void BackgroundSourcesUpdater::OnSourcesChanged()
+{
+    wxLogTrace("poedit.extractor", "sources changed, extracting in the background");
+
+    m_outdated = true;
+    if (!m_running)
+        Extract();
+}
+
+
+void BackgroundSourcesUpdater::Extract()
+{
+    auto catalog = m_catalog.lock();
+    if (!catalog)
+        return;
+    auto spec = catalog->GetSourceCodeSpec();
+    if (!spec)
+        return;
+
+    m_running = true;
+    m_outdated = false;
+    m_cancellation = std::make_shared<dispatch::cancellation_token>();
+
+    // Only source strings are compared, which don't change when the catalog
+    // is edited, so it's enough to take a snapshot of the items list:
+    CatalogItemArray items = catalog->items();
+
+    auto cancellation = m_cancellation;
+    std::weak_ptr<BackgroundSourcesUpdater> weakSelf = weak_from_this();
+
+    dispatch::async([spec,items,cancellation]() -> std::shared_ptr<Result>
+    {
+        try
+        {
+            // Don't bother the user with errors in the background, the
+            // extraction will be repeated with UI if it fails:
+            wxLogNull nolog;
+
+            auto data = ExtractPOTFromSourceCode(*spec, cancellation);
+
+            auto result = std::make_shared<Result>();
+            ComputeMergeStats(result->stats, items, data.reference->items());
+            result->reference = data.reference;
+            result->errors = data.errors;
+            return result;
+        }
+        catch (...)
+        {
+            wxLogTrace("poedit.extractor", "background extraction failed: %s", DescribeCurrentException());
+            return nullptr;
+        }
+    })
+    .then_on_main([weakSelf,cancellation](std::shared_ptr<Result> result)
+    {
+        auto self = weakSelf.lock();
+        if (!self || cancellation->is_cancelled())
+            return;
+
+        self->m_running = false;
+        if (self->m_outdated)
+        {
+            // sources changed again while extracting, keep showing previous
+            // result until the current one is ready:
+            self->Extract();
+            return;
+        }
+
+        self->m_result = result;
+        if (self->m_onChanged)
+            self->m_onChanged();
+    });
+}
+
+
 dispatch::future<CatalogPtr>
-PerformUpdateFromSourcesWithUI(wxWindow *parent, CatalogPtr catalog)
+PerformUpdateFromSourcesWithUI(wxWindow *parent, CatalogPtr catalog,
+                               std::shared_ptr<BackgroundSourcesUpdater::Result> prepared)
 {
+    if (prepared)
+    {
+        return DoPerformUpdateWithUI(parent, catalog,
+                                     10,
+                                     [=](dispatch::cancellation_token_ptr /*unused*/)
+                                     {
+                                         InterimResults data;
+                                         data.reference = prepared->reference;
+                                         data.errors = prepared->errors;
+                                         return data;
+                                     });
+    }
+
     return DoPerformUpdateWithUI(parent, catalog,
                                  90,
                                  [=](dispatch::cancellation_token_ptr token){ return ExtractPOTFromSourcesWithExplanatoryErrors(catalog, token); });
@@ -31,9 +31,12 @@
 #include "concurrency.h"
 #include "progress_ui.h"
 
+#include <functional>
+#include <memory>
 #include <vector>
 
 class WXDLLIMPEXP_FWD_CORE wxWindow;
+class SourcesMonitor;
 
 
 /// Specialization of ProgressWindow that shows issues and allows viewing merge results.
@@ -59,17 +62,95 @@ protected:
  */
 MergeResult PerformUpdateFromSourcesSimple(CatalogPtr catalog);
 
+/**
+    Updates all PO @a files from source code and saves them, w/o any UI.
+
+    Source code is extracted only once for all files that share the same
+    source code configuration (typically all languages of a project); the
+    files are then merged and saved in parallel. Files that can't be loaded
+    or don't have sources configured are skipped.
+
+    Returns the number of updated files.
+ */
+int PerformUpdateFromSourcesBatch(const wxArrayString& files, dispatch::cancellation_token_ptr cancellation);
+
+/**
+    Keeps strings extracted from source code up to date in the background.
+
+    Monitors the catalog's source code tree for changes and extracts strings
+    again after each burst of changes, so that updating from sources only
+    needs to merge the already extracted strings. Thanks to per-file caching
+    of extraction results, only modified files are processed again.
+
+    Must only be used on the main thread.
+ */
+class BackgroundSourcesUpdater : public std::enable_shared_from_this<BackgroundSourcesUpdater>
+{
+public:
+    /// Strings extracted from source code, ready to be merged into the catalog.
+    struct Result
+    {
+        CatalogPtr reference;
+        ParsedGettextErrors errors;
+        /// Differences between the catalog and @a reference
+        MergeStats stats;
+    };
+
+    /// Called when GetPendingChanges() changes.
+    typedef std::function<void()> ChangedHandler;
+
+    /// Creates the updater and starts initial extraction.
+    static std::shared_ptr<BackgroundSourcesUpdater> Create(CatalogPtr catalog, ChangedHandler onChanged);
+    ~BackgroundSourcesUpdater();
+
+    /// Is this updater for @a catalog and its current sources configuration?
+    bool IsFor(CatalogPtr catalog) const;
+
+    /// Returns last known differences between the catalog and source code, if any.
+    const MergeStats *GetPendingChanges() const
+        { return m_result ? &m_result->stats : nullptr; }
+
+    /**
+        Takes extracted strings for use by PerformUpdateFromSourcesWithUI().
+
+        Returns nullptr if they aren't known to be up to date with the source
+        code. The reference catalog can only be merged once, so the updater
+        has to be recreated for the merged catalog afterwards.
+     */
+    std::shared_ptr<Result> TakeResult();
+
+private:
+    BackgroundSourcesUpdater(CatalogPtr catalog, ChangedHandler onChanged);
+
+    void OnSourcesChanged();
+    void Extract();
+
+    std::weak_ptr<Catalog> m_catalog;
+    wxString m_specKey;
+    ChangedHandler m_onChanged;
+    std::unique_ptr<SourcesMonitor> m_monitor;
+
+    dispatch::cancellation_token_ptr m_cancellation;
+    bool m_running, m_outdated;
+    std::shared_ptr<Result> m_result;
+};
+
+
 /**
     Update catalog from source code, if configured, and provide UI
     during the operation.
 
+    If @a prepared is provided, strings already extracted by
+    BackgroundSourcesUpdater are used instead of extracting them again.
+
     The returned catalog may be the same as @a catalog (which may be modified
     in place), or it may be a new instance.
 
     FIXME: Make this non-modifying in place
  */
 dispatch::future<CatalogPtr>
-PerformUpdateFromSourcesWithUI(wxWindow *parent, CatalogPtr catalog);
+PerformUpdateFromSourcesWithUI(wxWindow *parent, CatalogPtr catalog,
+                               std::shared_ptr<BackgroundSourcesUpdater::Result> prepared = nullptr);
 
 /**
     Similarly for updating from a reference file (i.e. POT).
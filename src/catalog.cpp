@@ -54,10 +54,14 @@
 #include <wx/strconv.h>
 #include <wx/memtext.h>
 #include <wx/filename.h>
+#include <wx/hashmap.h>
 
 #include <algorithm>
+#include <limits>
+#include <mutex>
 #include <set>
 #include <regex>
+#include <unordered_map>
 
 
 // ----------------------------------------------------------------------
@@ -537,6 +541,98 @@ void Catalog::CreateNewHeader(const Catalog::HeaderData& pot_header)
 }
 
 
+namespace
+{
+
+struct ItemKeyHash
+{
+    size_t operator()(const Catalog::ItemKey& key) const
+    {
+        wxStringHash h;
+        size_t value = h(key.string);
+        value = value * 31 + h(key.context);
+        value = value * 31 + h(key.plural);
+        value = value * 31 + h(key.symbolicId);
+        return value;
+    }
+};
+
+} // anonymous namespace
+
+
+/// Lookup tables for finding items, built lazily when first needed.
+struct Catalog::ItemsIndex
+{
+    // item's index by its identity, built on first use
+    std::unordered_map<ItemKey, size_t, ItemKeyHash> byKey;
+    bool hasByKey = false;
+
+    // maximum line number of items [0,i], nondecreasing even if the items
+    // aren't sorted by line numbers, so it can be binary-searched
+    std::vector<int> maxLines;
+    bool hasMaxLines = false;
+};
+
+
+Catalog::ItemKey Catalog::ItemKey::For(const CatalogItem& item)
+{
+    ItemKey key;
+    if (item.HasContext())
+        key.context = item.GetContext();
+    key.string = item.GetRawString();
+    if (item.HasPlural())
+        key.plural = item.GetRawPluralString();
+    key.symbolicId = item.GetRawSymbolicId();
+    return key;
+}
+
+
+Catalog::ItemsIndex& Catalog::GetItemsIndex() const
+{
+    if (!m_itemsIndex)
+        m_itemsIndex = std::make_shared<ItemsIndex>();
+    return *m_itemsIndex;
+}
+
+
+void Catalog::InvalidateItemsIndexes()
+{
+    m_stats.reset();
+
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    m_itemsIndex.reset();
+}
+
+
+void Catalog::InvalidateLineNumbersIndex()
+{
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+    if (m_itemsIndex)
+    {
+        m_itemsIndex->maxLines.clear();
+        m_itemsIndex->hasMaxLines = false;
+    }
+}
+
+
+CatalogItemPtr Catalog::FindItem(const ItemKey& key) const
+{
+    std::lock_guard<std::mutex> lock(m_indexMutex);
+
+    auto& index = GetItemsIndex();
+    if (!index.hasByKey)
+    {
+        index.byKey.reserve(m_items.size());
+        for (size_t i = 0; i < m_items.size(); i++)
+            index.byKey.emplace(ItemKey::For(*m_items[i]), i);  // keeps the first of duplicates
+        index.hasByKey = true;
+    }
+
+    auto found = index.byKey.find(key);
+    return found != index.byKey.end() ? m_items[found->second] : CatalogItemPtr();
+}
+
+
 CatalogItemPtr Catalog::FindItemByLine(int lineno)
 {
     int i = FindItemIndexByLine(lineno);
@@ -545,16 +641,24 @@ CatalogItemPtr Catalog::FindItemByLine(int lineno)
 
 int Catalog::FindItemIndexByLine(int lineno)
 {
-    int last = -1;
+    std::lock_guard<std::mutex> lock(m_indexMutex);
 
-    for (auto& i: m_items)
+    auto& index = GetItemsIndex();
+    if (!index.hasMaxLines)
     {
-        if (i->GetLineNumber() > lineno)
-            return last;
-        last++;
+        index.maxLines.reserve(m_items.size());
+        int maxLine = std::numeric_limits<int>::min();
+        for (auto& i: m_items)
+        {
+            maxLine = std::max(maxLine, i->GetLineNumber());
+            index.maxLines.push_back(maxLine);
+        }
+        index.hasMaxLines = true;
     }
 
-    return last;
+    // Returns the item preceding the first one with greater line number:
+    auto first = std::upper_bound(index.maxLines.begin(), index.maxLines.end(), lineno);
+    return int(first - index.maxLines.begin()) - 1;
 }
 
 
@@ -797,8 +901,14 @@ void Catalog::SetLanguage(Language lang)
     m_header.Lang = lang;
 }
 
-void Catalog::GetStatistics(int *all, int *fuzzy, int *badtokens,
-                            int *untranslated, int *unfinished)
+namespace
+{
+
+#if wxDEBUG_LEVEL >= 2
+// Straightforward computation of statistics, used to check incrementally
+// maintained counts in debug builds.
+void CountStatistics(const CatalogItemArray& items, int *all, int *fuzzy, int *badtokens,
+                     int *untranslated, int *unfinished)
 {
     if (all) *all = 0;
     if (fuzzy) *fuzzy = 0;
@@ -806,7 +916,7 @@ void Catalog::GetStatistics(int *all, int *fuzzy, int *badtokens,
     if (untranslated) *untranslated = 0;
     if (unfinished) *unfinished = 0;
 
-    for (auto& i: m_items)
+    for (auto& i: items)
     {
         bool ok = true;
 
@@ -836,23 +946,69 @@ void Catalog::GetStatistics(int *all, int *fuzzy, int *badtokens,
             (*unfinished)++;
     }
 }
+#endif // wxDEBUG_LEVEL >= 2
+
+} // anonymous namespace
+
+void Catalog::RecountStatistics()
+{
+    // Items that were removed from the catalog keep pointing to the old
+    // counters, so they can't affect the new ones:
+    m_stats = std::make_shared<CatalogStatsCounters>();
+    for (auto& i: m_items)
+    {
+        i->m_stats = m_stats;
+        m_stats->Add(i->GetStatsState(), +1);
+    }
+}
+
+void Catalog::GetStatistics(int *all, int *fuzzy, int *badtokens,
+                            int *untranslated, int *unfinished)
+{
+    // Items update the counters as they change, so they only need to be
+    // recomputed if items were added, removed or replaced, which resets them:
+    if (!m_stats)
+        RecountStatistics();
+
+    if (all) *all = m_stats->all;
+    if (fuzzy) *fuzzy = m_stats->fuzzy;
+    if (badtokens) *badtokens = m_stats->errors;
+    if (untranslated) *untranslated = m_stats->untranslated;
+    if (unfinished) *unfinished = m_stats->unfinished;
+
+#if wxDEBUG_LEVEL >= 2
+    int checkAll, checkFuzzy, checkErrors, checkUntranslated, checkUnfinished;
+    CountStatistics(m_items, &checkAll, &checkFuzzy, &checkErrors, &checkUntranslated, &checkUnfinished);
+    wxASSERT_MSG(checkAll == m_stats->all &&
+                 checkFuzzy == m_stats->fuzzy &&
+                 checkErrors == m_stats->errors &&
+                 checkUntranslated == m_stats->untranslated &&
+                 checkUnfinished == m_stats->unfinished,
+                 "incrementally maintained statistics are out of sync");
+#endif
+}
 
 
 void CatalogItem::SetFlags(const wxString& flags)
 {
     static const wxString flag_fuzzy(wxS(", fuzzy"));
 
-    m_moreFlags = flags;
+    const auto before = GetStatsState();
 
     if (flags.find(flag_fuzzy) != wxString::npos)
     {
         m_isFuzzy = true;
-        m_moreFlags.Replace(flag_fuzzy, wxString());
+        wxString moreFlags(flags);
+        moreFlags.Replace(flag_fuzzy, wxString());
+        m_moreFlags = moreFlags;
     }
     else
     {
         m_isFuzzy = false;
+        m_moreFlags = flags;
     }
+
+    UpdateStats(before);
 }
 
 
@@ -864,7 +1020,7 @@ wxString CatalogItem::GetFlags() const
         if (m_moreFlags.empty())
             return flag_fuzzy;
         else
-            return flag_fuzzy + m_moreFlags;
+            return flag_fuzzy + m_moreFlags.str();
     }
     else
     {
@@ -877,28 +1033,72 @@ std::string CatalogItem::GetFormatFlag() const
     if (m_moreFlags.empty())
         return std::string();
 
-    auto pos = m_moreFlags.find(wxS("-format"));
+    const wxString& moreFlags = m_moreFlags;
+    auto pos = moreFlags.find(wxS("-format"));
     if (pos == wxString::npos)
         return std::string();
-    auto space = m_moreFlags.find_last_of(" \t", pos);
+    auto space = moreFlags.find_last_of(" \t", pos);
     auto format = (space == wxString::npos)
-                    ? m_moreFlags.substr(0, pos)
-                    : m_moreFlags.substr(space+1, pos-space-1);
+                    ? moreFlags.substr(0, pos)
+                    : moreFlags.substr(space+1, pos-space-1);
     if (format.starts_with("no-"))
         return std::string();
     return std::string(format.begin(), format.end());
 }
 
+void CatalogItem::CopyDataFrom(const CatalogItem& other)
+{
+    m_id = other.m_id;
+    m_string = other.m_string;
+    m_plural = other.m_plural;
+    m_hasPlural = other.m_hasPlural;
+    m_hasContext = other.m_hasContext;
+    m_context = other.m_context;
+    m_translations = other.m_translations;
+    m_extractedComments = other.m_extractedComments;
+    m_oldMsgid = other.m_oldMsgid;
+    m_isFuzzy = other.m_isFuzzy;
+    m_isTranslated = other.m_isTranslated;
+    m_isModified = other.m_isModified;
+    m_isPreTranslated = other.m_isPreTranslated;
+    m_moreFlags = other.m_moreFlags;
+    m_comment = other.m_comment;
+    m_lineNum = other.m_lineNum;
+    m_issue = other.m_issue;
+    m_sideloaded = other.m_sideloaded;
+    m_hasDeferredData.store(other.m_hasDeferredData.load(std::memory_order_acquire), std::memory_order_release);
+    m_editCount = other.m_editCount;
+}
+
+void CatalogItem::DoLoadDeferredData() const
+{
+    // Deferred data are loaded only occasionally, as the user views the items,
+    // so it's sufficient to use a single lock for all of them:
+    static std::mutex s_mutex;
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    if (!m_hasDeferredData.load(std::memory_order_relaxed))
+        return;  // another thread was faster
+
+    const_cast<CatalogItem*>(this)->LoadDeferredData();
+    m_hasDeferredData.store(false, std::memory_order_release);
+}
+
 void CatalogItem::SetFuzzy(bool fuzzy)
 {
     if (fuzzy == m_isFuzzy)
         return;
 
     if (!fuzzy && m_isFuzzy)
+    {
+        LoadDeferredDataIfNeeded();
         m_oldMsgid.clear();
+    }
+    const auto before = GetStatsState();
     m_isFuzzy = fuzzy;
+    UpdateStats(before);
 
-    UpdateInternalRepresentation();
+    OnEdited();
 }
 
 void CatalogItem::SetComment(const wxString& c)
@@ -907,7 +1107,7 @@ void CatalogItem::SetComment(const wxString& c)
         return;
 
     m_comment = c;
-    UpdateInternalRepresentation();
+    OnEdited();
 }
 
 
@@ -927,6 +1127,7 @@ void CatalogItem::SetTranslation(const wxString &t, unsigned idx)
 
     ClearIssue();
 
+    const auto before = GetStatsState();
     m_isTranslated = true;
     for (size_t i = 0; i < m_translations.GetCount(); i++)
     {
@@ -936,8 +1137,9 @@ void CatalogItem::SetTranslation(const wxString &t, unsigned idx)
             break;
         }
     }
+    UpdateStats(before);
 
-    UpdateInternalRepresentation();
+    OnEdited();
 }
 
 void CatalogItem::SetTranslations(const wxArrayString &t)
@@ -946,6 +1148,7 @@ void CatalogItem::SetTranslations(const wxArrayString &t)
 
     ClearIssue();
 
+    const auto before = GetStatsState();
     m_isTranslated = true;
     for (size_t i = 0; i < m_translations.GetCount(); i++)
     {
@@ -955,16 +1158,19 @@ void CatalogItem::SetTranslations(const wxArrayString &t)
             break;
         }
     }
+    UpdateStats(before);
 
-    UpdateInternalRepresentation();
+    OnEdited();
 }
 
 void CatalogItem::SetTranslationFromSource()
 {
     ClearIssue();
+    const auto before = GetStatsState();
     m_isFuzzy = false;
     m_isPreTranslated = false;
     m_isTranslated = true;
+    UpdateStats(before);
 
     auto iter = m_translations.begin();
     if (*iter != m_string)
@@ -986,15 +1192,17 @@ void CatalogItem::SetTranslationFromSource()
         }
     }
 
-    UpdateInternalRepresentation();
+    OnEdited();
 }
 
 void CatalogItem::ClearTranslation()
 {
     bool modified = m_isFuzzy != false;
+    const auto before = GetStatsState();
     m_isFuzzy = false;
     m_isPreTranslated = false;
     m_isTranslated = false;
+    UpdateStats(before);
     for (auto& t: m_translations)
     {
         if (!t.empty())
@@ -1005,7 +1213,7 @@ void CatalogItem::ClearTranslation()
     m_isModified = modified;
 
     if (modified)
-        UpdateInternalRepresentation();
+        OnEdited();
 }
 
 unsigned CatalogItem::GetPluralFormsCount() const
@@ -1020,7 +1228,7 @@ unsigned CatalogItem::GetPluralFormsCount() const
 wxString CatalogItem::GetOldMsgid() const
 {
     wxString s;
-    for (auto line: m_oldMsgid)
+    for (auto line: GetOldMsgidRaw())
     {
         if (line.length() < 2)
             continue;
@@ -1038,7 +1246,7 @@ wxString CatalogItem::GetOldMsgid() const
 }
 
 
-Catalog::ValidationResults Catalog::Validate(const wxString& /*fileWithSameContent*/)
+Catalog::ValidationResults Catalog::Validate()
 {
     ValidationResults res;
 
@@ -1211,18 +1419,13 @@ bool Catalog::CanLoadFile(const wxString& extension_)
 
 void Catalog::SideloadSourceDataFromReferenceFile(CatalogPtr ref)
 {
-    std::map<wxString, CatalogItemPtr> refItems;
-
-    for (auto iref: ref->items())
-        refItems[iref->GetRawString()] = iref;
-
     for (auto i: this->items())
     {
-        auto ri = refItems.find(i->GetRawString());
-        if (ri == refItems.end())
+        auto ri = ref->FindItem(ItemKey::For(*i));
+        if (!ri)
             continue;
 
-        auto& rdata = *ri->second;
+        auto& rdata = *ri;
         if (rdata.GetTranslation().empty())
             continue;
 
@@ -26,16 +26,19 @@
 #ifndef Poedit_catalog_h
 #define Poedit_catalog_h
 
+#include "interned_string.h"
 #include "language.h"
 
 #include <wx/encconv.h>
 #include <wx/arrstr.h>
 #include <wx/textfile.h>
 
+#include <atomic>
 #include <initializer_list>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 class CloudSyncDestination;
@@ -75,6 +78,52 @@ struct SideloadedCatalogData
 };
 
 
+/**
+    Counts of catalog's items in different states, see Catalog::GetStatistics().
+
+    The counts are maintained incrementally: items update the counters of
+    the catalog they belong to whenever their state changes. The counters
+    are atomic, because items may be modified concurrently, e.g. when they
+    are validated in parallel.
+ */
+class CatalogStatsCounters
+{
+public:
+    /// Item's state as relevant for statistics, combination of these bits
+    enum State
+    {
+        Fuzzy        = 1,
+        Error        = 2,
+        Untranslated = 4
+    };
+
+    /// Adds (or removes, if @a delta is negative) an item in @a state.
+    void Add(unsigned state, int delta)
+    {
+        all += delta;
+        if (state & Fuzzy)
+            fuzzy += delta;
+        if (state & Error)
+            errors += delta;
+        if (state & Untranslated)
+            untranslated += delta;
+        if (state)
+            unfinished += delta;
+    }
+
+    /// Updates the counts after an item's state changed.
+    void Update(unsigned before, unsigned after)
+    {
+        if (before == after)
+            return;
+        Add(before, -1);
+        Add(after, +1);
+    }
+
+    std::atomic<int> all{0}, fuzzy{0}, errors{0}, untranslated{0}, unfinished{0};
+};
+
+
 /** This class holds information about one particular string.
     This includes source string and its occurrences in source code
     (so-called references), translation and translation's status
@@ -157,7 +206,13 @@ class CatalogItem
         const wxString& GetComment() const { return m_comment; }
 
         /// Returns array of all auto comments.
-        const wxArrayString& GetExtractedComments() const { return m_sideloaded ? m_sideloaded->extracted_comments : m_extractedComments; }
+        const wxArrayString& GetExtractedComments() const
+        {
+            if (m_sideloaded)
+                return m_sideloaded->extracted_comments;
+            LoadDeferredDataIfNeeded();
+            return m_extractedComments;
+        }
 
         /// Convenience function: does this entry has a comment?
         bool HasComment() const { return !m_comment.empty(); }
@@ -191,9 +246,13 @@ class CatalogItem
         /// Get line number of this entry.
         int GetLineNumber() const { return m_lineNum; }
 
-        const wxArrayString& GetOldMsgidRaw() const { return m_oldMsgid; }
+        /// Returns number of edits done with the setters below, which allows
+        /// detecting if the item was changed since some earlier point.
+        unsigned GetEditCount() const { return m_editCount; }
+
+        const wxArrayString& GetOldMsgidRaw() const { LoadDeferredDataIfNeeded(); return m_oldMsgid; }
         wxString GetOldMsgid() const;
-        bool HasOldMsgid() const { return !m_oldMsgid.empty(); }
+        bool HasOldMsgid() const { return !GetOldMsgidRaw().empty(); }
 
 
         // -------------------------------------------------------------------
@@ -217,7 +276,12 @@ class CatalogItem
         /// Sets fuzzy flag.
         void SetFuzzy(bool fuzzy);
         /// Sets translated flag.
-        void SetTranslated(bool t) { m_isTranslated = t; }
+        void SetTranslated(bool t)
+        {
+            const auto before = GetStatsState();
+            m_isTranslated = t;
+            UpdateStats(before);
+        }
         /// Sets modified flag.
         void SetModified(bool modified) { m_isModified = modified; }
         /// Sets pre-translated translation flag.
@@ -250,10 +314,22 @@ class CatalogItem
         bool HasError() const { return m_issue && m_issue->severity == Issue::Error; }
         const std::shared_ptr<Issue>& GetIssue() const { return m_issue; }
 
-        void ClearIssue() { m_issue.reset(); }
-        void SetIssue(std::shared_ptr<Issue> issue) { m_issue = issue; }
-        void SetIssue(const Issue& issue) { m_issue = std::make_shared<Issue>(issue); }
-        void SetIssue(Issue::Severity severity, const wxString& message) { m_issue = std::make_shared<Issue>(severity, message); }
+        void ClearIssue()
+        {
+            if (!m_issue)
+                return;
+            const auto before = GetStatsState();
+            m_issue.reset();
+            UpdateStats(before);
+        }
+        void SetIssue(std::shared_ptr<Issue> issue)
+        {
+            const auto before = GetStatsState();
+            m_issue = issue;
+            UpdateStats(before);
+        }
+        void SetIssue(const Issue& issue) { SetIssue(std::make_shared<Issue>(issue)); }
+        void SetIssue(Issue::Severity severity, const wxString& message) { SetIssue(std::make_shared<Issue>(severity, message)); }
 
         void AttachSideloadedData(const std::shared_ptr<SideloadedItemData>& d) { m_sideloaded = d; }
         void ClearSideloadedData() { m_sideloaded.reset(); }
@@ -262,6 +338,66 @@ class CatalogItem
         // API for subclasses:
         virtual void UpdateInternalRepresentation() = 0;
 
+        /**
+            Copies all data of @a other, including data not loaded yet, into
+            this newly created item. The copy isn't part of any catalog's
+            statistics.
+         */
+        void CopyDataFrom(const CatalogItem& other);
+
+        /// Called by the setters after the item was edited
+        void OnEdited()
+        {
+            m_editCount++;
+            UpdateInternalRepresentation();
+        }
+
+        /**
+            Marks the item as not having all of its data loaded yet.
+
+            Subclasses may defer loading of data that aren't needed to display
+            the list of items (extracted comments, previous msgid and similar)
+            until they are accessed for the first time. LoadDeferredData() is
+            then called to load them.
+         */
+        void SetHasDeferredData() { m_hasDeferredData = true; }
+
+        /// Returns true if some data weren't loaded yet, see SetHasDeferredData().
+        bool HasDeferredData() const { return m_hasDeferredData.load(std::memory_order_acquire); }
+
+        /**
+            Loads data deferred with SetHasDeferredData(), called at most once.
+
+            The implementation must set the member variables directly and not
+            call any of the getters.
+         */
+        virtual void LoadDeferredData() {}
+
+        /// Loads deferred data if there are any; safe to call from any thread.
+        void LoadDeferredDataIfNeeded() const
+        {
+            if (m_hasDeferredData.load(std::memory_order_acquire))
+                DoLoadDeferredData();
+        }
+
+    private:
+        void DoLoadDeferredData() const;
+
+        /// Returns item's state as CatalogStatsCounters::State combination
+        unsigned GetStatsState() const
+        {
+            return (m_isFuzzy ? CatalogStatsCounters::Fuzzy : 0) |
+                   (HasError() ? CatalogStatsCounters::Error : 0) |
+                   (!m_isTranslated ? CatalogStatsCounters::Untranslated : 0);
+        }
+
+        /// Updates catalog's statistics after a change from state @a before
+        void UpdateStats(unsigned before)
+        {
+            if (m_stats)
+                m_stats->Update(before, GetStatsState());
+        }
+
     protected:
         // -------------------------------------------------------------------
         // Private data setters only for internal use:
@@ -317,12 +453,23 @@ class CatalogItem
         wxArrayString m_extractedComments;
         wxArrayString m_oldMsgid;
         bool m_isFuzzy, m_isTranslated, m_isModified, m_isPreTranslated;
-        wxString m_moreFlags;
+        // flags other than fuzzy; the same few combinations repeat in most items
+        InternedString m_moreFlags;
         wxString m_comment;
         int m_lineNum;
 
         std::shared_ptr<Issue> m_issue;
         std::shared_ptr<SideloadedItemData> m_sideloaded;
+
+    private:
+        mutable std::atomic<bool> m_hasDeferredData{false};
+
+        unsigned m_editCount = 0;
+
+        // statistics of the catalog the item belongs to, set by Catalog::GetStatistics()
+        std::shared_ptr<CatalogStatsCounters> m_stats;
+
+        friend class Catalog;
 };
 
 
@@ -428,7 +575,10 @@ class Catalog
         enum CreationFlags
         {
             CreationFlag_IgnoreHeader       = 1,
-            CreationFlag_IgnoreTranslations = 2
+            CreationFlag_IgnoreTranslations = 2,
+            /// Use on-disk cache of parsed files if enabled (see POCatalogCache);
+            /// the file must be validated before modifying it
+            CreationFlag_UseCache           = 4
         };
 
         enum class CompilationStatus
@@ -544,6 +694,9 @@ class Catalog
             Any argument may be NULL if the caller is not interested in
             given statistic value.
 
+            The counts are maintained incrementally as items change, so this
+            is O(1) unless items were added or removed since the last call.
+
             @note "untranslated" are entries without translation; "unfinished"
                   are entries with any problems
          */
@@ -594,14 +747,58 @@ class Catalog
         /// Finds catalog index by line number
         int FindItemIndexByLine(int lineno);
 
+        /// Identity of an item within the catalog, see FindItem()
+        struct ItemKey
+        {
+            wxString context, string, plural, symbolicId;
+
+            /// Returns the key of @a item, using its raw (not sideloaded) data
+            static ItemKey For(const CatalogItem& item);
+
+            bool operator==(const ItemKey& other) const
+            {
+                return string == other.string && context == other.context &&
+                       plural == other.plural && symbolicId == other.symbolicId;
+            }
+        };
+
+        /**
+            Finds item with given identity.
+
+            If there are several such items (which can only happen in broken
+            files), the first one is returned. Returns nullptr if not found.
+
+            The lookup uses a hash index built on first use.
+         */
+        CatalogItemPtr FindItem(const ItemKey& key) const;
+
 
-        /// Validates correctness of the translation by running msgfmt
-        /// Returns number of errors (i.e. 0 if no errors).
-        virtual ValidationResults Validate(const wxString& fileWithSameContent = wxString());
+        /// Validates correctness of the translation, marking problematic items
+        /// with issues. Returns number of errors (i.e. 0 if no errors).
+        virtual ValidationResults Validate();
 
         void AttachCloudSync(std::shared_ptr<CloudSyncDestination> c) { m_cloudSync = c; }
         std::shared_ptr<CloudSyncDestination> GetCloudSync() const { return m_cloudSync; }
 
+        /**
+            Carries translations from @a catalog over to this catalog.
+
+            This catalog is expected to be a reference file (e.g. template or
+            source language file) of the same type, loaded without translations;
+            it becomes the updated version of @a catalog. This is how catalogs
+            other than PO ones are merged with a reference.
+
+            Messages are matched by their identity (see ItemKey). If the file
+            format can mark translations as needing work, messages with the
+            same symbolic ID, but modified source text, and, if @a fuzzyMatching
+            is true, messages with similar source text get the matching
+            translations too, marked as fuzzy. Translations that are no longer
+            used are passed to AddObsoleteItems().
+
+            Implemented in catalog_merge.cpp.
+         */
+        void TakeTranslationsFrom(const Catalog& catalog, bool fuzzyMatching);
+
         /**
             Attach source text data from another file to this one.
 
@@ -627,6 +824,37 @@ class Catalog
         /// Perform post-creation processing to e.g. fixup issues, detect missing language etc.
         virtual void PostCreation();
 
+        /**
+            Stores translated @a items of @a catalog as obsolete ones, if the
+            format supports it; called by TakeTranslationsFrom() with items that
+            no longer have a counterpart in this catalog. Obsolete items already
+            present in @a catalog should be preserved as well.
+
+            Does nothing by default, i.e. the translations are dropped.
+         */
+        virtual void AddObsoleteItems(const Catalog& /*catalog*/, const CatalogItemArray& /*items*/) {}
+
+        /**
+            Forces recomputing of statistics and indexes of items.
+
+            Must be called whenever items are added to, removed from or
+            replaced in m_items after loading. Items count towards the
+            statistics of only one catalog, so they must not be shared with
+            another one; copy them instead.
+         */
+        void InvalidateItemsIndexes();
+
+        /// Must be called after changing line numbers of the items, e.g. when saving
+        void InvalidateLineNumbersIndex();
+
+    private:
+        /// Counts items' states from scratch and attaches the items to new counters
+        void RecountStatistics();
+
+        struct ItemsIndex;
+        /// Returns up-to-date index of items, must be called with m_indexMutex locked
+        ItemsIndex& GetItemsIndex() const;
+
     protected:
         CatalogItemArray m_items;
 
@@ -638,6 +866,14 @@ class Catalog
 
         std::shared_ptr<CloudSyncDestination> m_cloudSync;
         std::shared_ptr<SideloadedCatalogData> m_sideloaded;
+
+    private:
+        // incrementally maintained statistics, reset by InvalidateItemsIndexes()
+        std::shared_ptr<CatalogStatsCounters> m_stats;
+
+        // lazily built lookup tables, see FindItem() and FindItemIndexByLine()
+        mutable std::shared_ptr<ItemsIndex> m_itemsIndex;
+        mutable std::mutex m_indexMutex;
 };
 
 #endif // Poedit_catalog_h
@@ -0,0 +1,300 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "catalog_merge.h"
+
+#include "concurrency.h"
+#include "str_helpers.h"
+
+#include <algorithm>
+#include <bitset>
+#include <unordered_map>
+
+
+namespace
+{
+
+// Minimal similarity of two messages to use one's translation as a fuzzy
+// translation of the other; same as msgmerge's.
+const double FUZZY_THRESHOLD = 0.6;
+
+
+/**
+    Measures similarity of strings to a fixed pattern string.
+
+    The similarity is 2*LCS/(len1+len2), where LCS is the length of the strings'
+    longest common subsequence, i.e. the same measure msgmerge's fstrcmp() uses.
+    LCS is computed using bit-parallel algorithm (H. Hyyrö, 2004) that processes
+    64 characters of the pattern at once, which makes it feasible to compare
+    every new message with all translated ones.
+ */
+class SimilarityMatcher
+{
+public:
+    explicit SimilarityMatcher(const std::string& pattern)
+        : m_length(pattern.length()),
+          m_words((pattern.length() + 63) / 64),
+          m_peq(256 * m_words, 0)
+    {
+        for (size_t i = 0; i < m_length; i++)
+            m_peq[(unsigned char)pattern[i] * m_words + i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    /// Returns similarity of @a text to the pattern, or 0 if it's known to be less than @a minimum.
+    double Similarity(const std::string& text, double minimum) const
+    {
+        const size_t total = m_length + text.length();
+        if (total == 0)
+            return 1.0;
+
+        // common subsequence can't be longer than the shorter of the strings:
+        if (2.0 * std::min(m_length, text.length()) / total < minimum)
+            return 0.0;
+
+        return 2.0 * LCS(text) / total;
+    }
+
+private:
+    size_t LCS(const std::string& text) const
+    {
+        if (m_length == 0)
+            return 0;
+
+        std::vector<uint64_t> v(m_words, ~uint64_t(0));
+        for (unsigned char c: text)
+        {
+            const uint64_t *peq = &m_peq[c * m_words];
+            uint64_t carry = 0;
+            for (size_t w = 0; w < m_words; w++)
+            {
+                // V' = (V + U) | (V - U), where U = V & Peq[c], done with carry across words:
+                const uint64_t x = v[w];
+                const uint64_t u = x & peq[w];
+                const uint64_t sum1 = x + u;
+                const uint64_t sum = sum1 + carry;
+                carry = (sum1 < x) | (sum < sum1);
+                v[w] = sum | (x & ~u);
+            }
+        }
+
+        // LCS length is the number of zero bits in V:
+        size_t lcs = 0;
+        for (size_t w = 0; w < m_words; w++)
+        {
+            uint64_t zeros = ~v[w];
+            if (w == m_words - 1 && m_length % 64)
+                zeros &= (uint64_t(1) << (m_length % 64)) - 1;
+            lcs += std::bitset<64>(zeros).count();
+        }
+        return lcs;
+    }
+
+    size_t m_length, m_words;
+    std::vector<uint64_t> m_peq;
+};
+
+
+// Key identifying context of a message; messages with different contexts never
+// match, not even fuzzily
+inline std::wstring ContextKey(const CatalogItem& item)
+{
+    return item.HasContext() ? L"\x04" + item.GetContext().ToStdWstring() : std::wstring();
+}
+
+// Key identifying a message exactly, including its symbolic ID (see Catalog::ItemKey)
+inline std::wstring IdentityKey(const CatalogItem& item)
+{
+    std::wstring key = ContextKey(item);
+    key += L'\x04';
+    key += item.GetRawString().ToStdWstring();
+    key += L'\x04';
+    key += item.GetRawPluralString().ToStdWstring();
+    key += L'\x04';
+    key += item.GetRawSymbolicId().ToStdWstring();
+    return key;
+}
+
+// Key identifying a message by its symbolic ID only; empty if it has none
+inline std::wstring SymbolicIdKey(const CatalogItem& item)
+{
+    auto id = item.GetRawSymbolicId();
+    if (id.empty())
+        return std::wstring();
+    return ContextKey(item) + L'\x04' + id.ToStdWstring();
+}
+
+} // anonymous namespace
+
+
+void FindFuzzyMatches(const CatalogItemArray& defs,
+                      const CatalogItemArray& refs,
+                      const std::vector<size_t>& unmatched,
+                      std::vector<int>& match)
+{
+    // Only translated messages are candidates and only messages with the same
+    // context can match, so group candidates by it:
+    std::vector<std::string> defStrings(defs.size());
+    std::unordered_map<std::wstring, std::vector<size_t>> candidates;
+    for (size_t i = 0; i < defs.size(); i++)
+    {
+        auto& d = defs[i];
+        if (d->GetTranslation().empty())
+            continue;
+        defStrings[i] = str::to_utf8(d->GetRawString());
+        candidates[ContextKey(*d)].push_back(i);
+    }
+
+    if (candidates.empty())
+        return;
+
+    // Every message is matched independently, so do it in parallel:
+    dispatch::parallel_for(unmatched.size(), dispatch::default_parallelism(), [&](size_t u)
+    {
+        auto& r = refs[unmatched[u]];
+        auto group = candidates.find(ContextKey(*r));
+        if (group == candidates.end())
+            return;
+
+        const SimilarityMatcher matcher(str::to_utf8(r->GetRawString()));
+        int best = -1;
+        double bestScore = FUZZY_THRESHOLD;
+        for (auto i: group->second)
+        {
+            const double score = matcher.Similarity(defStrings[i], bestScore);
+            // ties are resolved in favor of the first candidate
+            if (score > bestScore || (best == -1 && score >= bestScore))
+            {
+                best = int(i);
+                bestScore = score;
+            }
+        }
+        match[unmatched[u]] = best;
+    });
+}
+
+
+void Catalog::TakeTranslationsFrom(const Catalog& catalog, bool fuzzyMatching)
+{
+    const CatalogItemArray& defs = catalog.m_items;
+
+    if (catalog.GetLanguage().IsValid())
+        SetLanguage(catalog.GetLanguage());
+
+    const unsigned nplurals = std::max(GetPluralForms().nplurals(), 1u);
+    const bool canFuzzy = HasCapability(Cap::FuzzyTranslations);
+    const bool canComment = HasCapability(Cap::UserComments);
+
+    // Find exact matches using hash indexes; if the format can mark translations
+    // as needing work, messages with the same symbolic ID, but changed source
+    // text, match too, and then fuzzy matches are searched for the rest:
+    std::unordered_map<std::wstring, size_t> index, indexById;
+    index.reserve(defs.size());
+    for (size_t i = 0; i < defs.size(); i++)
+    {
+        index.emplace(IdentityKey(*defs[i]), i);
+        auto idKey = SymbolicIdKey(*defs[i]);
+        if (!idKey.empty())
+            indexById.emplace(std::move(idKey), i);
+    }
+
+    std::vector<int> match(m_items.size(), -1);
+    std::vector<bool> exact(m_items.size(), false);
+    std::vector<size_t> unmatched;
+    for (size_t r = 0; r < m_items.size(); r++)
+    {
+        auto& ref = *m_items[r];
+        auto found = index.find(IdentityKey(ref));
+        if (found != index.end())
+        {
+            match[r] = int(found->second);
+            exact[r] = true;
+            continue;
+        }
+
+        if (!canFuzzy)
+            continue;
+
+        auto foundById = indexById.find(SymbolicIdKey(ref));
+        if (foundById != indexById.end())
+            match[r] = int(foundById->second);
+        else if (fuzzyMatching && !m_sourceIsSymbolicID && !ref.GetRawString().empty())
+            unmatched.push_back(r);
+    }
+
+    if (!unmatched.empty())
+        FindFuzzyMatches(defs, m_items, unmatched, match);
+
+    // Carry the translations over; the items' data are set directly, so that
+    // the underlying document is only updated once per item:
+    std::vector<bool> used(defs.size(), false);
+    for (size_t r = 0; r < m_items.size(); r++)
+    {
+        if (match[r] == -1)
+            continue;
+
+        auto& item = m_items[r];
+        auto& def = defs[match[r]];
+        used[match[r]] = true;
+
+        wxArrayString translations = def->GetTranslations();
+        if (item->HasPlural() != def->HasPlural())
+        {
+            const wxString t = def->GetTranslation();
+            translations.clear();
+            translations.Add(t, item->HasPlural() ? nplurals : 1);
+        }
+
+        bool translated = !translations.empty();
+        for (auto& t: translations)
+        {
+            if (t.empty())
+                translated = false;
+        }
+
+        const bool sameSource = exact[r] && item->GetRawPluralString() == def->GetRawPluralString();
+        item->m_translations = translations;
+        item->m_isTranslated = translated;
+        item->m_isFuzzy = canFuzzy && !def->GetTranslation().empty() && (!sameSource || def->IsFuzzy());
+        item->m_isPreTranslated = sameSource && def->IsPreTranslated();
+        if (canComment)
+            item->m_comment = def->GetComment();
+
+        item->UpdateInternalRepresentation();
+    }
+
+    // Translated messages that are no longer used become obsolete, if the format
+    // can store them:
+    CatalogItemArray obsolete;
+    for (size_t i = 0; i < defs.size(); i++)
+    {
+        if (!used[i] && !defs[i]->GetTranslation().empty())
+            obsolete.push_back(defs[i]);
+    }
+    if (!obsolete.empty() || catalog.HasDeletedItems())
+        AddObsoleteItems(catalog, obsolete);
+
+    InvalidateItemsIndexes();
+}
@@ -0,0 +1,52 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef Poedit_catalog_merge_h
+#define Poedit_catalog_merge_h
+
+#include "catalog.h"
+
+#include <vector>
+
+
+/**
+    Finds fuzzy matches for messages without an exact match.
+
+    Messages match if they have the same context and their source texts are
+    similar enough, as determined by the same measure msgmerge uses. Only
+    translated messages from @a defs are considered.
+
+    @param defs      Messages with existing translations.
+    @param refs      Reference messages.
+    @param unmatched Indexes into @a refs of messages to find matches for.
+    @param match     Found matches are stored here, as indexes into @a defs.
+ */
+extern void FindFuzzyMatches(const CatalogItemArray& defs,
+                             const CatalogItemArray& refs,
+                             const std::vector<size_t>& unmatched,
+                             std::vector<int>& match);
+
+#endif // Poedit_catalog_merge_h
@@ -0,0 +1,232 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "catalog_mo_writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+
+namespace
+{
+
+const uint32_t MO_MAGIC = 0x950412de;
+const size_t MO_HEADER_SIZE = 7 * sizeof(uint32_t);
+
+// Separator of msgctxt and msgid in MO files' keys
+const char MSGCTXT_SEPARATOR = '\x04';
+
+
+// Hash function used by gettext runtime for lookups (hashpjw), see hash-string.c
+inline uint32_t HashString(const char *str, size_t len)
+{
+    uint32_t hval = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        hval <<= 4;
+        hval += (unsigned char)str[i];
+        const uint32_t g = hval & ((uint32_t)0xf << 28);
+        if (g != 0)
+        {
+            hval ^= g >> 24;
+            hval ^= g;
+        }
+    }
+    return hval;
+}
+
+
+// Same primality test as msgfmt uses for choosing hash table size
+inline bool IsPrime(uint32_t candidate)
+{
+    uint32_t divn = 3;
+    uint32_t sq = divn * divn;
+
+    while (sq < candidate && candidate % divn != 0)
+    {
+        ++divn;
+        sq += 4 * divn;
+        ++divn;
+    }
+
+    return candidate % divn != 0;
+}
+
+inline uint32_t NextPrime(uint32_t seed)
+{
+    seed |= 1;
+    while (!IsPrime(seed))
+        seed += 2;
+    return seed;
+}
+
+
+inline void AppendUInt32(std::string& out, uint32_t value)
+{
+    // MO files are written in native byte order, same as msgfmt does by default
+    char buf[sizeof(uint32_t)];
+    memcpy(buf, &value, sizeof(buf));
+    out.append(buf, sizeof(buf));
+}
+
+} // anonymous namespace
+
+
+void MOWriter::AppendKey(std::string& out, const std::string *context, const std::string& msgid)
+{
+    if (context)
+    {
+        out += *context;
+        out += MSGCTXT_SEPARATOR;
+    }
+    out += msgid;
+}
+
+
+void MOWriter::Add(const std::string *context, const std::string& msgid, const std::string& msgstr)
+{
+    Message m;
+    AppendKey(m.msgid, context, msgid);
+    m.keyLength = m.msgid.length();
+    m.msgstr = msgstr;
+    m_messages.push_back(std::move(m));
+}
+
+
+void MOWriter::Add(const std::string *context, const std::string& msgid, const std::string& msgidPlural,
+                   const std::vector<std::string>& msgstr)
+{
+    Message m;
+    AppendKey(m.msgid, context, msgid);
+    m.keyLength = m.msgid.length();
+    m.msgid += '\0';
+    m.msgid += msgidPlural;
+
+    for (auto& s: msgstr)
+    {
+        if (&s != &msgstr.front())
+            m.msgstr += '\0';
+        m.msgstr += s;
+    }
+
+    m_messages.push_back(std::move(m));
+}
+
+
+std::string MOWriter::Write()
+{
+    // Messages must be sorted by their keys (i.e. up to the first NUL, which
+    // is how msgfmt compares them using strcmp()), because gettext runtime
+    // uses binary search if the hash table lookup isn't possible:
+    std::stable_sort(m_messages.begin(), m_messages.end(), [](const Message& a, const Message& b)
+    {
+        return std::string_view(a.msgid.data(), a.keyLength) < std::string_view(b.msgid.data(), b.keyLength);
+    });
+
+    const uint32_t count = (uint32_t)m_messages.size();
+
+    // Hash table size is the smallest prime not smaller than 4/3 of the
+    // number of messages, but at least 3, exactly as in msgfmt:
+    uint32_t hashSize = NextPrime((count * 4) / 3);
+    if (hashSize <= 2)
+        hashSize = 3;
+
+    const uint32_t origTabOffset = (uint32_t)MO_HEADER_SIZE;
+    const uint32_t transTabOffset = origTabOffset + count * 2 * sizeof(uint32_t);
+    const uint32_t hashTabOffset = transTabOffset + count * 2 * sizeof(uint32_t);
+    const uint32_t stringsOffset = hashTabOffset + hashSize * sizeof(uint32_t);
+
+    std::vector<uint32_t> hashTable(hashSize, 0);
+    for (uint32_t j = 0; j < count; j++)
+    {
+        auto& m = m_messages[j];
+        const uint32_t hash = HashString(m.msgid.data(), m.keyLength);
+        uint32_t idx = hash % hashSize;
+        if (hashTable[idx] != 0)
+        {
+            // collision, use double hashing:
+            const uint32_t incr = 1 + (hash % (hashSize - 2));
+            do
+            {
+                if (idx >= hashSize - incr)
+                    idx -= hashSize - incr;
+                else
+                    idx += incr;
+            }
+            while (hashTable[idx] != 0);
+        }
+        hashTable[idx] = j + 1;
+    }
+
+    size_t stringsSize = 0;
+    for (auto& m: m_messages)
+        stringsSize += m.msgid.length() + 1 + m.msgstr.length() + 1;
+
+    std::string out;
+    out.reserve(stringsOffset + stringsSize);
+
+    AppendUInt32(out, MO_MAGIC);
+    AppendUInt32(out, 0); // revision
+    AppendUInt32(out, count);
+    AppendUInt32(out, origTabOffset);
+    AppendUInt32(out, transTabOffset);
+    AppendUInt32(out, hashSize);
+    AppendUInt32(out, hashTabOffset);
+
+    // Strings are NUL-terminated, but the stored lengths don't include the
+    // terminating NUL; original strings come first, then translations:
+    uint32_t offset = stringsOffset;
+    for (auto& m: m_messages)
+    {
+        AppendUInt32(out, (uint32_t)m.msgid.length());
+        AppendUInt32(out, offset);
+        offset += (uint32_t)m.msgid.length() + 1;
+    }
+    for (auto& m: m_messages)
+    {
+        AppendUInt32(out, (uint32_t)m.msgstr.length());
+        AppendUInt32(out, offset);
+        offset += (uint32_t)m.msgstr.length() + 1;
+    }
+
+    for (auto h: hashTable)
+        AppendUInt32(out, h);
+
+    for (auto& m: m_messages)
+    {
+        out += m.msgid;
+        out += '\0';
+    }
+    for (auto& m: m_messages)
+    {
+        out += m.msgstr;
+        out += '\0';
+    }
+
+    return out;
+}
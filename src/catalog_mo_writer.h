@@ -0,0 +1,92 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef Poedit_catalog_mo_writer_h
+#define Poedit_catalog_mo_writer_h
+
+#include <string>
+#include <vector>
+
+
+/**
+    Compiler of binary MO files.
+
+    Produces the same output as GNU gettext's msgfmt does: messages sorted
+    by msgid, followed by the hash table used by gettext runtime for
+    lookups, and the strings themselves.
+
+    Strings are stored as-is, i.e. they must already be encoded in the
+    catalog's charset. The writer is self-contained and doesn't access any
+    shared state, so it can be used from background threads.
+ */
+class MOWriter
+{
+public:
+    MOWriter() {}
+
+    /// Preallocates space for @a count messages.
+    void Reserve(size_t count) { m_messages.reserve(count); }
+
+    /**
+        Adds a singular message to the output.
+
+        @param context  msgctxt or nullptr if the message doesn't have one.
+        @param msgid    Source string; empty string is used for the header.
+        @param msgstr   Translation.
+     */
+    void Add(const std::string *context, const std::string& msgid, const std::string& msgstr);
+
+    /**
+        Adds a message with plural forms to the output.
+
+        @param context      msgctxt or nullptr if the message doesn't have one.
+        @param msgid        Singular source string.
+        @param msgidPlural  Plural source string.
+        @param msgstr       Translations, in the order of plural forms.
+     */
+    void Add(const std::string *context, const std::string& msgid, const std::string& msgidPlural,
+             const std::vector<std::string>& msgstr);
+
+    /// Number of messages added so far.
+    size_t GetCount() const { return m_messages.size(); }
+
+    /// Returns content of the compiled MO file.
+    std::string Write();
+
+private:
+    struct Message
+    {
+        std::string msgid;   // including context and plural
+        size_t keyLength;    // length of context+msgid, i.e. without plural
+        std::string msgstr;
+    };
+
+    static void AppendKey(std::string& out, const std::string *context, const std::string& msgid);
+
+    std::vector<Message> m_messages;
+};
+
+#endif // Poedit_catalog_mo_writer_h
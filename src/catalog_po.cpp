@@ -24,6 +24,10 @@
  */
 
 #include "catalog_po.h"
+#include "catalog_po_writer.h"
+#include "catalog_mo_writer.h"
+#include "catalog_po_validator.h"
+#include "concurrency.h"
 
 #include "configuration.h"
 #include "errors.h"
@@ -35,6 +39,7 @@
 #include "language.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <wx/utils.h>
 #include <wx/tokenzr.h>
 #include <wx/log.h>
@@ -45,11 +50,12 @@
 #include <wx/scopeguard.h>
 #include <wx/stdpaths.h>
 #include <wx/strconv.h>
-#include <wx/memtext.h>
+#include <wx/file.h>
 #include <wx/filename.h>
 
 #include <set>
 #include <algorithm>
+#include <string_view>
 
 #ifdef __WXOSX__
 #import <Foundation/Foundation.h>
@@ -173,6 +179,12 @@ wxTextFileType GetFileCRLFFormat(wxTextFile& po_file)
     return crlf;
 }
 
+inline bool IsUTF8Charset(const wxString& charset)
+{
+    const auto lower = charset.Lower();
+    return lower == "utf-8" || lower == "utf8";
+}
+
 wxTextFileType GetDesiredCRLFFormat(wxTextFileType existingCRLF)
 {
     if (existingCRLF != wxTextFileType_None && wxConfigBase::Get()->ReadBool("keep_crlf", true))
@@ -189,14 +201,214 @@ wxTextFileType GetDesiredCRLFFormat(wxTextFileType existingCRLF)
     }
 }
 
-} // anonymous namespace
+int GetDesiredWrappingWidth(int existingWrapping)
+{
+    int wrapping = POCatalog::DEFAULT_WRAPPING;
+    if (wxConfigBase::Get()->ReadBool("keep_crlf", true))
+        wrapping = existingWrapping;
+
+    if (wrapping == POCatalog::DEFAULT_WRAPPING)
+    {
+        if (wxConfigBase::Get()->ReadBool("wrap_po_files", true))
+            wrapping = (int)wxConfigBase::Get()->ReadLong("wrap_po_files_width", 79);
+        else
+            wrapping = POCatalog::NO_WRAPPING;
+    }
 
+    return wrapping;
+}
 
-// ----------------------------------------------------------------------
-// Parsers
-// ----------------------------------------------------------------------
+bool WriteFileData(const wxString& filename, const std::string& data)
+{
+    wxFile f;
+    if (!f.Create(filename, /*overwrite=*/true))
+        return false;
 
-bool POCatalogParser::Parse()
+    return f.Write(data.data(), data.size()) == data.size() && f.Close();
+}
+
+// Whether Catalog::Validate() does QA checks, which affects validation results
+inline bool AreQAChecksEnabled()
+{
+#if wxUSE_GUI
+    return Config::ShowWarnings();
+#else
+    return false;
+#endif
+}
+
+// Files larger than this have entries' details parsed only when needed, see
+// POCatalogParser::DeferEntryDetails():
+const size_t DEFER_ENTRY_DETAILS_MIN_SIZE = 1024 * 1024;
+
+// Files larger than this are split into chunks parsed in parallel, each of
+// them at least PARALLEL_PARSING_CHUNK_SIZE large:
+const size_t PARALLEL_PARSING_MIN_SIZE = 4 * 1024 * 1024;
+const size_t PARALLEL_PARSING_CHUNK_SIZE = 1024 * 1024;
+
+inline bool LineStartsWith(const char *line, const char *end, const char *prefix)
+{
+    const size_t len = strlen(prefix);
+    return size_t(end - line) >= len && memcmp(line, prefix, len) == 0;
+}
+
+inline const char *SkipIndentation(const char *line, const char *end)
+{
+    while (line < end && (*line == ' ' || *line == '\t'))
+        line++;
+    return line;
+}
+
+// Checks if the line ending at lineEnd (excluding EOL) consists of whitespace only
+inline bool IsBlankLine(const char *line, const char *lineEnd)
+{
+    for (; line < lineEnd; ++line)
+    {
+        if (*line != ' ' && *line != '\t' && *line != '\r')
+            return false;
+    }
+    return true;
+}
+
+// Checks if the last non-blank line before lineStart is (part of) msgstr,
+// i.e. the entry preceding it is complete
+bool FollowsCompleteEntry(const char *data, const char *lineStart)
+{
+    while (lineStart > data)
+    {
+        const char *lineEnd = lineStart - 1;  // points to '\n'
+        lineStart = lineEnd;
+        while (lineStart > data && lineStart[-1] != '\n')
+            lineStart--;
+
+        // the parser skips blank lines, even between string's lines:
+        if (IsBlankLine(lineStart, lineEnd))
+            continue;
+
+        const char *text = SkipIndentation(lineStart, lineEnd);
+        if (*text == '"')
+            continue;
+        return LineStartsWith(text, lineEnd, "msgstr");
+    }
+    return false;
+}
+
+/**
+    Finds the first place at or after @a from where the data can be split
+    so that both parts can be parsed independently, with the same result as
+    when parsing them together, or returns @a size if there's none.
+
+    That is the case at an empty line that follows a complete entry (i.e.
+    its last msgstr) and precedes the beginning of a new entry, because
+    POCatalogParser starts with a clean state there. Splitting at the empty
+    line rather than the entry keeps wrapping detection identical too.
+ */
+size_t FindEntryBoundary(const char *data, size_t size, size_t from)
+{
+    const char *end = data + size;
+    const char *line = data + from;
+    if (from > 0 && line[-1] != '\n')
+    {
+        line = (const char*)memchr(line, '\n', end - line);
+        if (!line)
+            return size;
+        line++;
+    }
+
+    while (line < end)
+    {
+        const char *eol = (const char*)memchr(line, '\n', end - line);
+        if (!eol)
+            break;
+
+        if (line > data && (eol == line || (eol == line + 1 && *line == '\r')))
+        {
+            const char *next = eol + 1;
+            const char *nextEnd = (const char*)memchr(next, '\n', end - next);
+            if (!nextEnd)
+                nextEnd = end;
+
+            const bool entryStarts = (LineStartsWith(next, nextEnd, "#") && !LineStartsWith(next, nextEnd, "#~")) ||
+                                     LineStartsWith(next, nextEnd, "msgctxt ") ||
+                                     LineStartsWith(next, nextEnd, "msgid ");
+            if (entryStarts && FollowsCompleteEntry(data, line))
+                return line - data;
+        }
+
+        line = eol + 1;
+    }
+
+    return size;
+}
+
+/// Splits the data into chunks for parallel parsing, returns their start offsets.
+std::vector<size_t> FindChunkBoundaries(const char *data, size_t size)
+{
+    std::vector<size_t> chunks { 0 };
+    if (size < PARALLEL_PARSING_MIN_SIZE)
+        return chunks;
+
+    const size_t count = std::min((size_t)dispatch::default_parallelism(), size / PARALLEL_PARSING_CHUNK_SIZE);
+    for (size_t i = 1; i < count; i++)
+    {
+        const size_t from = std::max(size * i / count, chunks.back() + 1);
+        const size_t boundary = FindEntryBoundary(data, size, from);
+        if (boundary >= size)
+            break;
+        chunks.push_back(boundary);
+    }
+
+    return chunks;
+}
+
+// Sometimes, msgcat produces conflicts in extracted comments; see the gory details:
+// https://groups.google.com/d/topic/poedit/j41KuvXtVUU/discussion
+// As a workaround, just filter them out.
+// FIXME: Fix this properly... but not using msgcat in the first place
+const char MSGCAT_CONFLICT_MARKER[] = "#-#-#-#-#";
+
+inline bool IsMsgcatConflictMarker(const wxString& comment)
+{
+    static const wxString MSGCAT_CONFLICT_MARKER_STR(MSGCAT_CONFLICT_MARKER);
+    return comment.starts_with(MSGCAT_CONFLICT_MARKER_STR) && comment.ends_with(MSGCAT_CONFLICT_MARKER_STR);
+}
+
+// Checks whether entry's original text, whose details weren't parsed yet,
+// may contain conflict markers that would be filtered out when parsing it
+inline bool MayContainMsgcatConflictMarker(const POOriginalText& text)
+{
+    return std::string_view(text.Data(), text.Length()).find(MSGCAT_CONFLICT_MARKER) != std::string_view::npos;
+}
+
+// Removes msgcat conflict markers from entry's extracted comments, returns
+// true if there were any
+bool RemoveMsgcatConflictMarkers(wxArrayString& extractedComments)
+{
+    const size_t count = extractedComments.size();
+    extractedComments.erase(std::remove_if(extractedComments.begin(), extractedComments.end(), IsMsgcatConflictMarker),
+                            extractedComments.end());
+    return extractedComments.size() != count;
+}
+
+/// Kinds of comment lines preceding an entry, see ParseCommentLine().
+enum class POCommentLine
+{
+    Ignored,            ///< empty special comment, e.g. "#,"
+    Flags,
+    ExtractedComment,
+    Reference,
+    PreviousMsgid,
+    Other               ///< translator comment, obsolete entry or not a comment at all
+};
+
+/**
+    Recognizes special comment lines of PO entries and reads their content
+    into @a param.
+
+    This is the grammar of comment lines shared by POCatalogParser::Parse()
+    and ParseEntryDetails().
+ */
+POCommentLine ParseCommentLine(const wxString& line, wxString& param)
 {
     static const wxString prefix_flags(wxS("#, "));
     static const wxString prefix_flags_alt(wxS("#= "));
@@ -204,6 +416,106 @@ bool POCatalogParser::Parse()
     static const wxString prefix_autocomments2(wxS("#.")); // account for empty auto comments
     static const wxString prefix_references(wxS("#: "));
     static const wxString prefix_prev_msgid(wxS("#| "));
+
+    if (line.empty() || line[0u] != wxS('#'))
+        return POCommentLine::Other;
+
+    // ignore empty special tags (except for extracted comments which we
+    // DO want to preserve):
+    if (line.length() == 2 && (line[1u] == wxS(',') || line[1u] == wxS('=') || line[1u] == wxS(':') || line[1u] == wxS('|')))
+        return POCommentLine::Ignored;
+
+    if (ReadParam(line, prefix_flags, param) || ReadParam(line, prefix_flags_alt, param))
+        return POCommentLine::Flags;
+    if (ReadParam(line, prefix_autocomments, param, /*preserveWhitespace=*/true) || ReadParam(line, prefix_autocomments2, param, /*preserveWhitespace=*/true))
+        return POCommentLine::ExtractedComment;
+    if (ReadParam(line, prefix_references, param, /*preserveWhitespace=*/true))
+        return POCommentLine::Reference;
+    if (ReadParam(line, prefix_prev_msgid, param))
+        return POCommentLine::PreviousMsgid;
+
+    return POCommentLine::Other;
+}
+
+// Translator comments span all following lines that don't start with
+// a special comment tag, including e.g. "#|" lines
+inline bool IsTranslatorCommentLine(const wxString& line)
+{
+    return !line.empty() &&
+           line[0u] == wxS('#') &&
+           (line.length() < 2 || (line[1u] != wxS(',') && line[1u] != wxS(':') && line[1u] != wxS('.') && line[1u] != wxS('~')));
+}
+
+/**
+    Parses extracted comments, references and previous msgid lines from
+    the original UTF-8 text of a single entry, the same way
+    POCatalogParser::Parse() does.
+
+    Used to load entries' details deferred with DeferEntryDetails().
+ */
+void ParseEntryDetails(const POOriginalText& text,
+                       wxArrayString& extractedComments,
+                       wxArrayString& references,
+                       wxArrayString& oldMsgid)
+{
+    const char *pos = text.Data();
+    const char *end = pos + text.Length();
+    bool inComment = false;
+    wxString param;
+
+    while (pos < end)
+    {
+        const char *eol = (const char*)memchr(pos, '\n', end - pos);
+        const char *lineEnd = eol ? eol : end;
+        const char *lineStart = pos;
+        pos = eol ? eol + 1 : end;
+        if (lineEnd > lineStart && lineEnd[-1] == '\r')
+            lineEnd--;
+
+        wxString line = wxString::FromUTF8(lineStart, lineEnd - lineStart);
+        if (!line.empty() && (wxIsspace(line[0]) || wxIsspace(line.Last())))
+            line = line.Strip(wxString::both);
+        if (line.empty())
+            continue;
+
+        // the comments precede the message itself:
+        if (line[0u] != wxS('#'))
+            break;
+
+        if (inComment && IsTranslatorCommentLine(line))
+            continue;
+        inComment = false;
+
+        switch (ParseCommentLine(line, param))
+        {
+            case POCommentLine::ExtractedComment:
+                extractedComments.Add(param);
+                break;
+            case POCommentLine::Reference:
+                references.push_back(param);
+                break;
+            case POCommentLine::PreviousMsgid:
+                oldMsgid.Add(param);
+                break;
+            case POCommentLine::Other:
+                inComment = IsTranslatorCommentLine(line);
+                break;
+            case POCommentLine::Ignored:
+            case POCommentLine::Flags:
+                break;
+        }
+    }
+}
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------
+// Parsers
+// ----------------------------------------------------------------------
+
+bool POCatalogParser::Parse()
+{
     static const wxString prefix_msgctxt(wxS("msgctxt \""));
     static const wxString prefix_msgid(wxS("msgid \""));
     static const wxString prefix_msgid_plural(wxS("msgid_plural \""));
@@ -212,7 +524,7 @@ bool POCatalogParser::Parse()
     static const wxString prefix_deleted(wxS("#~"));
     static const wxString prefix_deleted_msgid(wxS("#~ msgid"));
 
-    if (m_textFile->GetLineCount() == 0)
+    if (m_source->IsEmpty())
         return false;
 
     wxString line, dummy;
@@ -223,20 +535,36 @@ bool POCatalogParser::Parse()
     bool has_context = false;
     wxString msgctxt;
     unsigned mlinenum = 0;
+    size_t entryOffset = POLineSource::npos;
 
-    line = m_textFile->GetFirstLine();
+    line = m_source->GetFirstLine();
+    UpdateLineOffsets();
     if (line.empty())
         line = ReadTextLine();
 
+    // Byte range of the entry being parsed; it ends with the last line before
+    // the one currently read ahead:
+    auto setEntryOffsets = [&]
+    {
+        m_entryOffset = entryOffset;
+        m_entryEndOffset = m_previousLineEndOffset;
+        entryOffset = POLineSource::npos;
+    };
+
     while (!line.empty())
     {
-        // ignore empty special tags (except for extracted comments which we
-        // DO want to preserve):
-        while (line.length() == 2 && *line.begin() == '#' && (line[1] == ',' || line[1] == '=' || line[1] == ':' || line[1] == '|'))
+        if (entryOffset == POLineSource::npos)
+            entryOffset = m_lineOffset;
+
+        POCommentLine comment = ParseCommentLine(line, dummy);
+        while (comment == POCommentLine::Ignored)
+        {
             line = ReadTextLine();
+            comment = ParseCommentLine(line, dummy);
+        }
 
         // flags:
-        if (ReadParam(line, prefix_flags, dummy) || ReadParam(line, prefix_flags_alt, dummy))
+        if (comment == POCommentLine::Flags)
         {
             // see https://lists.gnu.org/archive/html/bug-gettext/2025-06/msg00018.html for introduction of
             // the #= alt form. We currently take the approach of converting #= to #, on write, as msgcat
@@ -248,25 +576,28 @@ bool POCatalogParser::Parse()
         }
 
         // auto comments:
-        else if (ReadParam(line, prefix_autocomments, dummy, /*preserveWhitespace=*/true) || ReadParam(line, prefix_autocomments2, dummy, /*preserveWhitespace=*/true))
+        else if (comment == POCommentLine::ExtractedComment)
         {
-            mextractedcomments.Add(dummy);
+            if (!m_deferEntryDetails)
+                mextractedcomments.Add(dummy);
             line = ReadTextLine();
         }
 
         // references:
-        else if (ReadParam(line, prefix_references, dummy, /*preserveWhitespace=*/true))
+        else if (comment == POCommentLine::Reference)
         {
             // Just store the references unmodified, we don't modify this
             // data anywhere.
-            mrefs.push_back(dummy);
+            if (!m_deferEntryDetails)
+                mrefs.push_back(dummy);
             line = ReadTextLine();
         }
 
         // previous msgid value:
-        else if (ReadParam(line, prefix_prev_msgid, dummy))
+        else if (comment == POCommentLine::PreviousMsgid)
         {
-            msgid_old.Add(dummy);
+            if (!m_deferEntryDetails)
+                msgid_old.Add(dummy);
             line = ReadTextLine();
         }
 
@@ -293,7 +624,7 @@ bool POCatalogParser::Parse()
         else if (ReadParam(line, prefix_msgid, dummy))
         {
             mstr = UnescapeCString(dummy.RemoveLast());
-            mlinenum = unsigned(m_textFile->GetCurrentLine() + 1);
+            mlinenum = unsigned(m_source->GetCurrentLine() + 1);
             while (!(line = ReadTextLine()).empty())
             {
                 if (line[0u] == wxS('\t'))
@@ -313,7 +644,7 @@ bool POCatalogParser::Parse()
         {
             msgid_plural = UnescapeCString(dummy.RemoveLast());
             has_plural = true;
-            mlinenum = unsigned(m_textFile->GetCurrentLine() + 1);
+            mlinenum = unsigned(m_source->GetCurrentLine() + 1);
             while (!(line = ReadTextLine()).empty())
             {
                 if (line[0u] == _T('\t'))
@@ -351,6 +682,7 @@ bool POCatalogParser::Parse()
                     break;
             }
             mtranslations.Add(str);
+            setEntryOffsets();
 
             bool shouldIgnore = m_ignoreHeader && (mstr.empty() && !has_context);
             if ( shouldIgnore )
@@ -420,6 +752,7 @@ bool POCatalogParser::Parse()
             if (m_ignoreTranslations)
                 mtranslations.clear();
 
+            setEntryOffsets();
             if (!OnEntry(mstr, msgid_plural, true,
                          has_context, msgctxt,
                          mtranslations,
@@ -442,7 +775,7 @@ bool POCatalogParser::Parse()
         {
             wxArrayString deletedLines;
             deletedLines.Add(line);
-            mlinenum = unsigned(m_textFile->GetCurrentLine() + 1);
+            mlinenum = unsigned(m_source->GetCurrentLine() + 1);
             while (!(line = ReadTextLine()).empty())
             {
                 // if line does not start with "#~" anymore, stop reading
@@ -456,6 +789,7 @@ bool POCatalogParser::Parse()
                 deletedLines.Add(line);
             }
 
+            setEntryOffsets();
             if (!m_ignoreTranslations)
             {
                 if (!OnDeletedEntry(deletedLines,
@@ -478,9 +812,7 @@ bool POCatalogParser::Parse()
         {
             bool readNewLine = false;
 
-            while (!line.empty() &&
-                    line[0u] == wxS('#') &&
-                   (line.Length() < 2 || (line[1u] != wxS(',') && line[1u] != wxS(':') && line[1u] != wxS('.') && line[1u] != wxS('~') )))
+            while (IsTranslatorCommentLine(line))
             {
                 mcomment << line << wxS('\n');
                 readNewLine = true;
@@ -501,23 +833,31 @@ bool POCatalogParser::Parse()
 }
 
 
+void POCatalogParser::UpdateLineOffsets()
+{
+    m_lineOffset = m_source->GetCurrentLineOffset();
+    m_lineEndOffset = m_source->GetCurrentLineEndOffset();
+}
+
 wxString POCatalogParser::ReadTextLine()
 {
     m_previousLineHardWrapped = m_lastLineHardWrapped;
     m_lastLineHardWrapped = false;
+    m_previousLineEndOffset = m_lineEndOffset;
 
     static const wxString msgid_alone(wxS("msgid \"\""));
     static const wxString msgstr_alone(wxS("msgstr \"\""));
 
     for (;;)
     {
-        if (m_textFile->Eof())
+        if (m_source->Eof())
             return wxString();
 
         // read next line and strip insignificant whitespace from it:
-        const auto& ln = m_textFile->GetNextLine();
+        const wxString ln = m_source->GetNextLine();
         if (ln.empty())
             continue;
+        UpdateLineOffsets();
 
         // gettext tools don't include (extracted) comments in wrapping, so they can't
         // be reliably used to detect file's wrapping either; just skip them.
@@ -571,11 +911,92 @@ int POCatalogParser::GetWrappingWidth() const
 
 
 
+POUtf8LineSource::POUtf8LineSource(const char *begin, const char *end, const wxString& filename,
+                                   size_t firstLine, size_t baseOffset)
+    : m_begin(begin), m_end(end), m_pos(begin), m_lineStart(begin),
+      m_firstLine(firstLine), m_baseOffset(baseOffset),
+      m_line(0),
+      m_countLF(0), m_countCRLF(0),
+      m_hasErrors(false),
+      m_filename(filename)
+{
+}
+
+wxString POUtf8LineSource::GetFirstLine()
+{
+    m_pos = m_begin;
+    m_line = 0;
+    m_countLF = m_countCRLF = 0;
+    m_hasErrors = false;
+    return ReadLine();
+}
+
+wxString POUtf8LineSource::GetNextLine()
+{
+    m_line++;
+    return ReadLine();
+}
+
+wxString POUtf8LineSource::ReadLine()
+{
+    const char *start = m_pos;
+    m_lineStart = start;
+    const char *eol = (const char*)memchr(start, '\n', m_end - start);
+    const char *lineEnd = eol ? eol : m_end;
+    m_pos = eol ? eol + 1 : m_end;
+
+    if (lineEnd > start && lineEnd[-1] == '\r')
+    {
+        lineEnd--;
+        if (eol)
+            m_countCRLF++;
+    }
+    else if (eol)
+    {
+        m_countLF++;
+    }
+
+    if (lineEnd == start)
+        return wxString();
+
+    // FromUTF8() validates the input and returns empty string if it's not valid UTF-8:
+    wxString line = wxString::FromUTF8(start, lineEnd - start);
+    if (line.empty())
+    {
+        wxLogError(
+            _(L"Line %d of file “%s” is corrupted (not valid %s data)."),
+            int(GetCurrentLine()), m_filename.c_str(), "UTF-8");
+        m_hasErrors = true;
+    }
+    return line;
+}
+
+wxTextFileType POUtf8LineSource::GetCRLFFormat() const
+{
+    if (m_countLF == 0 && m_countCRLF == 0)
+        return wxTextFileType_None;
+    return m_countCRLF > m_countLF ? wxTextFileType_Dos : wxTextFileType_Unix;
+}
+
+bool POUtf8LineSource::UsesMacLineEndings() const
+{
+    const size_t len = m_end - m_begin;
+    return len && !memchr(m_begin, '\n', len) && memchr(m_begin, '\r', len);
+}
+
+void POUtf8LineSource::AddStatsFrom(const POUtf8LineSource& other)
+{
+    m_countLF += other.m_countLF;
+    m_countCRLF += other.m_countCRLF;
+    m_hasErrors = m_hasErrors || other.m_hasErrors;
+}
+
+
 class POCharsetInfoFinder : public POCatalogParser
 {
     public:
-        POCharsetInfoFinder(wxTextFile *f)
-                : POCatalogParser(f), m_charset("UTF-8") {}
+        POCharsetInfoFinder(POLineSource *source)
+                : POCatalogParser(source), m_charset("UTF-8") {}
         wxString GetCharset() const { return m_charset; }
 
     protected:
@@ -613,14 +1034,32 @@ class POCharsetInfoFinder : public POCatalogParser
 class POLoadParser : public POCatalogParser
 {
     public:
-        POLoadParser(POCatalog& c, wxTextFile *f)
-              : POCatalogParser(f),
-                FileIsValid(false),
-                m_catalog(c), m_nextId(1), m_seenHeaderAlready(false) {}
+        POLoadParser(POCatalog& c, POLineSource *source)
+              : POCatalogParser(source),
+                FileIsValid(false), HasPluralItems(false),
+                m_catalog(c),
+                m_items(c.m_items), m_deletedItems(c.m_deletedItems),
+                m_nextId(1), m_seenHeaderAlready(false), m_isChunk(false) {}
 
         // true if the file is valid, i.e. has at least some data
         bool FileIsValid;
 
+        // true if any of the entries has plural forms
+        bool HasPluralItems;
+
+        /**
+            Parses UTF-8 data split with FindChunkBoundaries() in parallel.
+
+            This parser must use a source with the first chunk, it parses it
+            directly into the catalog. The remaining chunks are parsed by
+            separate parsers and their results appended afterwards, with
+            line numbers and IDs as if the whole file was parsed at once.
+         */
+        bool ParseChunks(POUtf8LineSource& firstSource,
+                         const char *data, size_t size,
+                         const std::vector<size_t>& chunks,
+                         const wxString& filename);
+
         Language GetSpecifiedMsgidLanguage()
         {
             auto x_srclang = m_catalog.Header().GetHeader("X-Source-Language");
@@ -636,6 +1075,25 @@ class POLoadParser : public POCatalogParser
         }
 
     protected:
+        // Creates parser for one of the chunks parsed by ParseChunks()
+        POLoadParser(const POLoadParser& parent, POLineSource *source)
+              : POCatalogParser(source),
+                FileIsValid(false), HasPluralItems(false),
+                m_catalog(parent.m_catalog),
+                m_items(m_chunkItems), m_deletedItems(m_chunkDeletedItems),
+                m_nextId(1), m_seenHeaderAlready(false), m_isChunk(true)
+        {
+            IgnoreHeader(parent.m_ignoreHeader);
+            IgnoreTranslations(parent.m_ignoreTranslations);
+            DeferEntryDetails(parent.m_deferEntryDetails);
+        }
+
+        void SetHeader(const wxString& text, const wxString& comment)
+        {
+            m_catalog.m_header.FromString(text);
+            m_catalog.m_header.Comment = comment;
+        }
+
         POCatalog& m_catalog;
 
         virtual bool OnEntry(const wxString& msgid,
@@ -660,9 +1118,38 @@ class POLoadParser : public POCatalogParser
 
         virtual void OnIgnoredEntry() { FileIsValid = true; }
 
+        // Returns original text of the entry being processed, if available
+        POOriginalText GetEntryOriginalText() const
+        {
+            size_t begin, end;
+            if (m_catalog.m_originalData && GetEntryOffsets(begin, end))
+                return POOriginalText(m_catalog.m_originalData, begin, end);
+            return POOriginalText();
+        }
+
     private:
+        // where to put parsed entries: the catalog or chunk's arrays
+        CatalogItemArray& m_items;
+        POCatalogDeletedDataArray& m_deletedItems;
+
         int m_nextId;
         bool m_seenHeaderAlready;
+
+        // Chunks other than the first one don't modify the catalog, they
+        // keep the results (including the header, which is normally found
+        // in the first chunk) for ParseChunks() to merge:
+        bool m_isChunk;
+        CatalogItemArray m_chunkItems;
+        POCatalogDeletedDataArray m_chunkDeletedItems;
+        wxString m_chunkHeaderText, m_chunkHeaderComment;
+
+        // flags of the last entry with any, see OnEntry()
+        wxString m_lastFlags;
+        bool m_lastFlagsFuzzy = false;
+        InternedString m_lastMoreFlags;
+
+        // references of the last entry, see OnEntry()
+        const POReferences *m_lastReferences = nullptr;
 };
 
 
@@ -681,21 +1168,32 @@ bool POLoadParser::OnEntry(const wxString& msgid,
 {
     FileIsValid = true;
 
-    static const wxString MSGCAT_CONFLICT_MARKER("#-#-#-#-#");
-
     if (msgid.empty() && !has_context)
     {
         if (!m_seenHeaderAlready)
         {
+            wxArrayString headerExtractedComments(extractedComments), headerReferences(references), unused;
+            if (m_deferEntryDetails)
+                ParseEntryDetails(GetEntryOriginalText(), headerExtractedComments, headerReferences, unused);
+
             // gettext header:
-            m_catalog.m_header.FromString(mtranslations[0]);
-            m_catalog.m_header.Comment = comment;
-            for (const auto& s : extractedComments)
-                m_catalog.m_header.Comment += "\n#. " + s;
-            for (const auto& s : references)
-                m_catalog.m_header.Comment += "\n#: " + s;
+            wxString headerComment(comment);
+            for (const auto& s : headerExtractedComments)
+                headerComment += "\n#. " + s;
+            for (const auto& s : headerReferences)
+                headerComment += "\n#: " + s;
             if (!flags.empty())
-                m_catalog.m_header.Comment += "\n#" + flags;
+                headerComment += "\n#" + flags;
+
+            if (m_isChunk)
+            {
+                m_chunkHeaderText = mtranslations[0];
+                m_chunkHeaderComment = headerComment;
+            }
+            else
+            {
+                SetHeader(mtranslations[0], headerComment);
+            }
             m_seenHeaderAlready = true;
         }
         // else: ignore duplicate header in malformed files
@@ -705,11 +1203,26 @@ bool POLoadParser::OnEntry(const wxString& msgid,
         auto d = std::make_shared<POCatalogItem>();
         d->SetId(m_nextId++);
         if (!flags.empty())
-            d->SetFlags(flags);
+        {
+            // Consecutive entries typically have the same flags, which can be
+            // reused without interning them again:
+            if (flags != m_lastFlags)
+            {
+                d->SetFlags(flags);
+                m_lastFlags = flags;
+                m_lastFlagsFuzzy = d->m_isFuzzy;
+                m_lastMoreFlags = d->m_moreFlags;
+            }
+            else
+            {
+                d->m_isFuzzy = m_lastFlagsFuzzy;
+                d->m_moreFlags = m_lastMoreFlags;
+            }
+        }
         d->SetString(msgid);
         if (has_plural)
         {
-            m_catalog.m_hasPluralItems = true;
+            HasPluralItems = true;
             d->SetPluralString(msgid_plural);
         }
         if (has_context)
@@ -717,20 +1230,31 @@ bool POLoadParser::OnEntry(const wxString& msgid,
         d->SetTranslations(mtranslations);
         d->SetComment(comment);
         d->SetLineNumber(lineNumber);
-        d->SetRawReferences(references);
 
-        for (auto i: extractedComments)
+        if (m_deferEntryDetails)
+        {
+            // references, extracted comments and previous msgid will be parsed
+            // from the original text when first accessed:
+            d->m_originalText = GetEntryOriginalText();
+            d->SetHasDeferredData();
+        }
+        else
         {
-            // Sometimes, msgcat produces conflicts in extracted comments; see the gory details:
-            // https://groups.google.com/d/topic/poedit/j41KuvXtVUU/discussion
-            // As a workaround, just filter them out.
-            // FIXME: Fix this properly... but not using msgcat in the first place
-            if (i.starts_with(MSGCAT_CONFLICT_MARKER) && i.ends_with(MSGCAT_CONFLICT_MARKER))
-                continue;
-            d->AddExtractedComments(i);
+            // nearby entries usually reference the same files:
+            d->m_references.Assign(references, m_lastReferences);
+            m_lastReferences = &d->m_references;
+
+            wxArrayString comments(extractedComments);
+            const bool filtered = RemoveMsgcatConflictMarkers(comments);
+            for (auto& c: comments)
+                d->AddExtractedComments(c);
+            d->SetOldMsgid(msgid_old);
+
+            if (!filtered)
+                d->m_originalText = GetEntryOriginalText();
         }
-        d->SetOldMsgid(msgid_old);
-        m_catalog.AddItem(d);
+
+        m_items.push_back(d);
     }
     return true;
 }
@@ -749,69 +1273,292 @@ bool POLoadParser::OnDeletedEntry(const wxArrayString& deletedLines,
     d.SetDeletedLines(deletedLines);
     d.SetComment(comment);
     d.SetLineNumber(lineNumber);
-    for (size_t i = 0; i < extractedComments.GetCount(); i++)
-      d.AddExtractedComments(extractedComments[i]);
-    m_catalog.AddDeletedItem(d);
+
+    // obsolete entries aren't displayed, but they are few, so just parse
+    // the deferred details right away:
+    wxArrayString deferredExtractedComments, unused1, unused2;
+    if (m_deferEntryDetails)
+        ParseEntryDetails(GetEntryOriginalText(), deferredExtractedComments, unused1, unused2);
+
+    for (auto& c: m_deferEntryDetails ? deferredExtractedComments : extractedComments)
+      d.AddExtractedComments(c);
+
+    d.SetOriginalText(GetEntryOriginalText());
+
+    m_deletedItems.push_back(d);
 
     return true;
 }
 
 
-// ----------------------------------------------------------------------
-// POCatalogItem class
-// ----------------------------------------------------------------------
-
-wxArrayString POCatalogItem::GetReferences() const
+bool POLoadParser::ParseChunks(POUtf8LineSource& firstSource,
+                               const char *data, size_t size,
+                               const std::vector<size_t>& chunks,
+                               const wxString& filename)
 {
-    // A line may contain several references, separated by white-space.
-    // Traditionally, each reference was in the form "path_name:line_number", but non
-    // standard references are sometime used too, including hyperlinks.
-    // Filenames that contain spaces are supported - they must be enclosed by Unicode
-    // characters U+2068 and U+2069.
-    wxArrayString refs;
+    std::vector<std::unique_ptr<POUtf8LineSource>> sources;
+    std::vector<std::unique_ptr<POLoadParser>> parsers;
+    size_t firstLine = 0;
+    for (size_t i = 1; i < chunks.size(); i++)
+    {
+        const size_t begin = chunks[i];
+        const size_t end = (i + 1 < chunks.size()) ? chunks[i + 1] : size;
+        firstLine += std::count(data + chunks[i - 1], data + begin, '\n');
+
+        sources.emplace_back(new POUtf8LineSource(data + begin, data + end, filename, firstLine, begin));
+        parsers.emplace_back(new POLoadParser(*this, sources.back().get()));
+    }
 
-    for (auto ref = m_references.begin(); ref != m_references.end(); ++ref)
+    // this parser handles the first chunk:
+    std::vector<char> parsed(parsers.size() + 1);
+    dispatch::parallel_for(parsed.size(), dispatch::default_parallelism(), [&](size_t i)
     {
-        auto line = ref->Strip(wxString::both);
-        wxString buf;
+        parsed[i] = (i == 0) ? Parse() : parsers[i - 1]->Parse();
+    });
+    if (!std::all_of(parsed.begin(), parsed.end(), [](char ok){ return ok; }))
+        return false;
 
-        auto i = line.begin();
-        while (i != line.end())
+    for (size_t i = 0; i < parsers.size(); i++)
+    {
+        auto& p = *parsers[i];
+
+        for (auto& item: p.m_chunkItems)
         {
-            const wchar_t c = *i;
-            if (wxIsspace(c))
-            {
-                // store reference text encountered so far:
-                if (!buf.empty())
-                {
-                    refs.push_back(buf);
-                    buf.clear();
-                }
-                ++i;
-            }
-            else if (c == L'\u2068')
-            {
-                // quoted filename between U+2068 and U+2069:
-                ++i;
-                while (i != line.end() && *i != L'\u2069')
-                {
-                    buf += *i;
-                    ++i;
-                }
-                if (i != line.end())
-                    ++i; // skip trailing U+2069
-            }
-            else
-            {
-                buf += c;
-                ++i;
-            }
+            std::static_pointer_cast<POCatalogItem>(item)->SetId(m_nextId++);
+            m_items.push_back(item);
         }
+        m_deletedItems.insert(m_deletedItems.end(), p.m_chunkDeletedItems.begin(), p.m_chunkDeletedItems.end());
+
+        if (p.m_seenHeaderAlready && !m_seenHeaderAlready)
+        {
+            SetHeader(p.m_chunkHeaderText, p.m_chunkHeaderComment);
+            m_seenHeaderAlready = true;
+        }
+
+        FileIsValid = FileIsValid || p.FileIsValid;
+        HasPluralItems = HasPluralItems || p.HasPluralItems;
+        AddWrappingInfo(p);
+        firstSource.AddStatsFrom(*sources[i]);
+    }
+
+    return true;
+}
+
+
+// ----------------------------------------------------------------------
+// POFileData class
+// ----------------------------------------------------------------------
+
+POFileData::POFileData(std::unique_ptr<MappedFile>&& file, size_t offset)
+    : m_file(std::move(file))
+{
+    m_data = m_file->Data() + offset;
+    m_size = m_file->Size() - offset;
+}
+
+
+POFileData::POFileData(const char *begin, const char *end)
+    : m_copy(begin, end)
+{
+    m_data = m_copy.data();
+    m_size = m_copy.size();
+}
+
+
+POFileData::~POFileData()
+{
+}
+
+
+// ----------------------------------------------------------------------
+// POReferences class
+// ----------------------------------------------------------------------
+
+namespace
+{
+
+// Parses canonical line number, i.e. one that is written back the same way:
+bool ParseReferenceLine(const wxString& s, size_t begin, size_t end, int32_t& line)
+{
+    const size_t len = end - begin;
+    if (len == 0 || len > 9 || (len > 1 && s[begin] == '0'))
+        return false;
+
+    int32_t value = 0;
+    for (size_t i = begin; i < end; i++)
+    {
+        const wxUniChar c = s[i];
+        if (c < '0' || c > '9')
+            return false;
+        value = value * 10 + (c.GetValue() - '0');
+    }
+    line = value;
+    return true;
+}
+
+} // anonymous namespace
+
+
+InternedString POReferences::InternPath(const wxString& path, const POReferences *nearby) const
+{
+    // References to the same file are usually next to each other, in the
+    // same entry or in neighbouring ones:
+    if (!m_refs.empty() && m_refs.back().path.str() == path)
+        return m_refs.back().path;
+
+    if (nearby)
+    {
+        const size_t count = std::min(nearby->m_refs.size(), size_t(16));
+        for (size_t i = 0; i < count; i++)
+        {
+            if (nearby->m_refs[i].path.str() == path)
+                return nearby->m_refs[i].path;
+        }
+    }
+
+    return InternedString(path);
+}
+
+
+void POReferences::Assign(const wxArrayString& lines, const POReferences *nearby)
+{
+    m_refs.clear();
+    m_refs.reserve(lines.size());
+
+    for (auto& s: lines)
+    {
+        bool startsLine = true;
+        size_t begin = 0;
+        for (;;)
+        {
+            size_t end = s.find(' ', begin);
+            if (end == wxString::npos)
+                end = s.length();
+
+            Ref r;
+            r.line = NO_LINE;
+            r.startsLine = startsLine;
+
+            size_t pathEnd = end;
+            if (end > begin)
+            {
+                const size_t colon = s.rfind(':', end - 1);
+                if (colon != wxString::npos && colon >= begin && ParseReferenceLine(s, colon + 1, end, r.line))
+                    pathEnd = colon;
+            }
+
+            r.path = InternPath(s.substr(begin, pathEnd - begin), nearby);
+            m_refs.push_back(std::move(r));
+
+            if (end == s.length())
+                break;
+            begin = end + 1;
+            startsLine = false;
+        }
+    }
+}
+
+
+wxArrayString POReferences::ToArray() const
+{
+    wxArrayString lines;
+    for (auto& r: m_refs)
+    {
+        if (r.startsLine)
+            lines.push_back(wxString());
+        else
+            lines.back() += ' ';
+
+        auto& s = lines.back();
+        s += r.path.str();
+        if (r.line != NO_LINE)
+            s << ':' << r.line;
+    }
+    return lines;
+}
+
+
+// ----------------------------------------------------------------------
+// POCatalogItem class
+// ----------------------------------------------------------------------
+
+void POCatalogItem::LoadDeferredData()
+{
+    if (!m_originalText.IsOk())
+        return;
+
+    wxArrayString references;
+    ParseEntryDetails(m_originalText, m_extractedComments, references, m_oldMsgid);
+    m_references.Assign(references);
+
+    // same as when loading the entry: don't write conflicts back
+    if (RemoveMsgcatConflictMarkers(m_extractedComments))
+        m_originalText.Reset();
+}
+
+
+POCatalogItemPtr POCatalogItem::Clone() const
+{
+    auto copy = std::make_shared<POCatalogItem>();
+    copy->CopyDataFrom(*this);
+    copy->m_references = m_references;
+    copy->m_originalText = m_originalText;
+    return copy;
+}
+
+
+wxArrayString POCatalogItem::GetReferences() const
+{
+    // A line may contain several references, separated by white-space.
+    // Traditionally, each reference was in the form "path_name:line_number", but non
+    // standard references are sometime used too, including hyperlinks.
+    // Filenames that contain spaces are supported - they must be enclosed by Unicode
+    // characters U+2068 and U+2069.
+    wxArrayString refs;
+
+    auto references = GetRawReferences();
+    for (auto ref = references.begin(); ref != references.end(); ++ref)
+    {
+        auto line = ref->Strip(wxString::both);
+        wxString buf;
+
+        auto i = line.begin();
+        while (i != line.end())
+        {
+            const wchar_t c = *i;
+            if (wxIsspace(c))
+            {
+                // store reference text encountered so far:
+                if (!buf.empty())
+                {
+                    refs.push_back(buf);
+                    buf.clear();
+                }
+                ++i;
+            }
+            else if (c == L'\u2068')
+            {
+                // quoted filename between U+2068 and U+2069:
+                ++i;
+                while (i != line.end() && *i != L'\u2069')
+                {
+                    buf += *i;
+                    ++i;
+                }
+                if (i != line.end())
+                    ++i; // skip trailing U+2069
+            }
+            else
+            {
+                buf += c;
+                ++i;
+            }
+        }
+
+        if (!buf.empty())
+            refs.push_back(buf);
+    }
 
-        if (!buf.empty())
-            refs.push_back(buf);
-    }
-
     return refs;
 }
 
@@ -890,8 +1637,6 @@ static inline wxString GetCurrentTimeString()
 
 void POCatalog::Load(const wxString& po_file, int flags)
 {
-    wxTextFile f;
-
     Clear();
     m_fileName = po_file;
     m_header.BasePath = wxEmptyString;
@@ -905,41 +1650,114 @@ void POCatalog::Load(const wxString& po_file, int flags)
 
     /* Load the .po file: */
 
-    if (!f.Open(po_file, wxConvISO8859_1))
+    std::unique_ptr<MappedFile> mapped(new MappedFile);
+    MappedFile& data = *mapped;
+    if (!data.Open(po_file))
     {
         BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
     }
 
+    const char *dataBegin = data.begin();
+    if (data.Size() >= 3 && memcmp(dataBegin, "\xEF\xBB\xBF", 3) == 0)
+        dataBegin += 3; // skip UTF-8 BOM
+
+    POUtf8LineSource utf8(dataBegin, data.end(), po_file);
+
     {
         wxLogNull null; // don't report parsing errors from here, report them later
-        POCharsetInfoFinder charsetFinder(&f);
+        POCharsetInfoFinder charsetFinder(&utf8);
         charsetFinder.Parse();
         m_header.Charset = charsetFinder.GetCharset();
     }
 
-    f.Close();
-    wxCSConv encConv(m_header.Charset);
-    if (!f.Open(po_file, encConv))
+    // Virtually all PO files are in UTF-8 these days and they can be parsed directly from
+    // the mapped data, in a single pass. Legacy charsets go through wxTextFile's conversion.
+    wxTextFile f;
+    std::unique_ptr<POLineSource> legacySource;
+    POLineSource *source = &utf8;
+    const bool useUTF8 = IsUTF8Charset(m_header.Charset) && !utf8.UsesMacLineEndings();
+
+    if (!useUTF8)
     {
-        BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
+        data.Close();
+
+        wxCSConv encConv(m_header.Charset);
+        if (!f.Open(po_file, encConv))
+        {
+            BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
+        }
+
+        if (!VerifyFileCharset(f, po_file, m_header.Charset))
+        {
+            wxLogError(_("There were errors when loading the file. Some data may be missing or corrupted as the result."));
+        }
+
+        legacySource.reset(new POTextBufferLineSource(&f));
+        source = legacySource.get();
+    }
+    else if (!(flags & CreationFlag_IgnoreTranslations))
+    {
+        // Keep the original text around, so that unmodified entries can be
+        // written back verbatim when saving. Saving replaces the file with
+        // a new one, so the mapped data remain valid. On Windows, mapped files
+        // can't be replaced, though, so a copy must be used there:
+#ifdef __WXMSW__
+        m_originalData = std::make_shared<const POFileData>(dataBegin, data.end());
+#else
+        m_originalData = std::make_shared<const POFileData>(std::move(mapped), dataBegin - data.begin());
+#endif
     }
 
-    if (!VerifyFileCharset(f, po_file, m_header.Charset))
+    // Unchanged files can be restored from the cache, without parsing them
+    // and (see Validate()) without validating them again:
+    if (useUTF8 && flags == CreationFlag_UseCache && POCatalogCache::IsEnabled())
     {
-        wxLogError(_("There were errors when loading the file. Some data may be missing or corrupted as the result."));
+        auto key = POCatalogCache::Key::Compute(po_file, data.begin(), data.Size());
+        if (POCatalogCache::Load(*this, key, m_originalData))
+            return;
+        m_cacheKey.reset(new POCatalogCache::Key(key));
     }
 
-    POLoadParser parser(*this, &f);
+    wxLogTrace("poedit", "loading %s using %s", po_file.c_str(), useUTF8 ? "UTF-8 fast path" : "charset conversion");
+
+    // Large UTF-8 files are split into chunks at entries' boundaries and parsed in parallel:
+    std::vector<size_t> chunks { 0 };
+    if (useUTF8)
+        chunks = FindChunkBoundaries(dataBegin, data.end() - dataBegin);
+
+    std::unique_ptr<POUtf8LineSource> firstChunk;
+    if (chunks.size() > 1)
+    {
+        wxLogTrace("poedit", "parsing %s in %d chunks", po_file.c_str(), (int)chunks.size());
+        firstChunk.reset(new POUtf8LineSource(dataBegin, dataBegin + chunks[1], po_file));
+        source = firstChunk.get();
+    }
+    POUtf8LineSource& utf8Used = firstChunk ? *firstChunk : utf8;
+
+    POLoadParser parser(*this, source);
     parser.IgnoreHeader(flags & CreationFlag_IgnoreHeader);
     parser.IgnoreTranslations(flags & CreationFlag_IgnoreTranslations);
-    if (!parser.Parse())
+    // Large files are loaded faster and use less memory if only data needed
+    // for displaying the list of entries are parsed upfront:
+    parser.DeferEntryDetails(m_originalData && data.Size() >= DEFER_ENTRY_DETAILS_MIN_SIZE);
+
+    const bool parsed = firstChunk
+                        ? parser.ParseChunks(*firstChunk, dataBegin, data.end() - dataBegin, chunks, po_file)
+                        : parser.Parse();
+    if (!parsed)
     {
         BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
     }
 
+    if (useUTF8 && utf8Used.HasErrors())
+    {
+        wxLogError(_("There were errors when loading the file. Some data may be missing or corrupted as the result."));
+    }
+
+    m_hasPluralItems = parser.HasPluralItems;
     m_sourceLanguage = parser.GetSpecifiedMsgidLanguage();  // may be, and likely will, invalid
 
-    m_fileCRLF = GetFileCRLFFormat(f);
+    m_fileCRLF = useUTF8 ? utf8Used.GetCRLFFormat() : GetFileCRLFFormat(f);
     m_fileWrappingWidth = parser.GetWrappingWidth();
     wxLogTrace("poedit", "detect line wrapping: %d", m_fileWrappingWidth);
 
@@ -949,8 +1767,6 @@ void POCatalog::Load(const wxString& po_file, int flags)
         BOOST_THROW_EXCEPTION(Exception(_(L"Couldn’t load the file, it is probably damaged.")));
     }
 
-    f.Close();
-
     FixupCommonIssues();
 
     if ( flags & CreationFlag_IgnoreHeader )
@@ -975,7 +1791,10 @@ void POCatalog::FixupCommonIssues()
             if (s.Contains(wxS("% ")) && !s.Contains(wxS("%% ")))
             {
                 auto poi = std::dynamic_pointer_cast<POCatalogItem>(i);
-                poi->m_moreFlags.Replace("php-format", "no-php-format");
+                wxString flags(poi->m_moreFlags);
+                flags.Replace("php-format", "no-php-format");
+                poi->m_moreFlags = flags;
+                poi->UpdateInternalRepresentation();
             }
         }
     }
@@ -1027,117 +1846,90 @@ void POCatalog::Clear()
 {
     // Catalog base class fields:
     m_items.clear();
+    InvalidateItemsIndexes();
 
     // PO-specific fields:
     m_deletedItems.clear();
+    m_originalData.reset();
 }
 
 
-// misc file-saving helpers
-namespace
-{
-
-inline bool CanEncodeStringToCharset(const wxString& s, wxMBConv& conv)
-{
-    if (s.empty())
-        return true;
-    const wxCharBuffer converted(s.mb_str(conv));
-    if ( converted.length() == 0 )
-        return false;
-    return true;
-}
-
-bool CanEncodeToCharset(const wxTextBuffer& f, const wxString& charset)
-{
-    if (charset.Lower() == "utf-8" || charset.Lower() == "utf8")
-        return true;
-
-    wxCSConv conv(charset);
+#ifdef __WXOSX__
 
-    const size_t lines = f.GetLineCount();
-    for ( size_t i = 0; i < lines; i++ )
-    {
-        if ( !CanEncodeStringToCharset(f.GetLine(i), conv) )
-            return false;
-    }
+@interface CompiledMOFilePresenter : NSObject<NSFilePresenter>
+@property (atomic, copy) NSURL *presentedItemURL;
+@property (atomic, copy) NSURL *primaryPresentedItemURL;
+@end
 
-    return true;
+@implementation CompiledMOFilePresenter
+- (NSOperationQueue *)presentedItemOperationQueue {
+     return [NSOperationQueue mainQueue];
 }
+@end
 
-template<typename Func>
-inline void SplitIntoLines(const wxString& text, Func&& f)
-{
-    if (text.empty())
-        return;
+#endif // __WXOSX__
 
-    wxString::const_iterator last = text.begin();
-    for (wxString::const_iterator i = text.begin(); i != text.end(); ++i)
-    {
-        if (*i == '\n')
-        {
-            f(wxString(last, i), false);
-            last = i + 1;
-        }
-    }
 
-    if (last != text.end())
-        f(wxString(last, text.end()), true);
-}
-
-void SaveMultiLines(wxTextBuffer &f, const wxString& text)
+namespace
 {
-    SplitIntoLines(text, [&f](wxString&& s, bool)
-    {
-        f.AddLine(s);
-    });
-}
 
-/** Adds \n characters as necessary for good-looking output
- */
-wxString FormatStringForFile(const wxString& text)
+/// Writes compiled MO file for @a po_file, replacing the existing one.
+Catalog::CompilationStatus WriteMOFile(const wxString& po_file, const std::string& mo_data)
 {
-    wxString s;
-    s.reserve(text.length() + 16);
-
-    static wxString quoted_newline(wxS("\"\n\""));
-
-    SplitIntoLines(text, [&s](wxString&& piece, bool last)
-    {
-        if (!s.empty())
-            s += quoted_newline;
-        if (!last)
-            piece += '\n';
-        EscapeCStringInplace(piece);
-        s += piece;
-    });
-
-    return s;
-}
-
-} // anonymous namespace
+    const wxString mo_file = wxFileName::StripExtension(po_file) + ".mo";
+    TempOutputFileFor mo_file_temp_obj(mo_file);
+    const wxString mo_file_temp = mo_file_temp_obj.FileName();
 
+    // Notice that, like msgfmt without the -c flag, the MO file is created
+    // even if the catalog has some errors; they were reported as part of
+    // validation step above.
+    if (mo_data.empty() || !WriteFileData(mo_file_temp, mo_data))
+        return Catalog::CompilationStatus::Error;
 
+    // Move the MO from temporary location to the final one:
+    auto mo_compilation_status = Catalog::CompilationStatus::Success;
 #ifdef __WXOSX__
+    NSURL *mofileUrl = [NSURL fileURLWithPath:str::to_NS(mo_file)];
+    NSURL *mofiletempUrl = [NSURL fileURLWithPath:str::to_NS(mo_file_temp)];
+
+    CompiledMOFilePresenter *presenter = [CompiledMOFilePresenter new];
+    presenter.presentedItemURL = mofileUrl;
+    presenter.primaryPresentedItemURL = [NSURL fileURLWithPath:str::to_NS(po_file)];
+    [NSFileCoordinator addFilePresenter:presenter];
+
+    NSFileCoordinator *coo = [[NSFileCoordinator alloc] initWithFilePresenter:presenter];
+    [coo coordinateWritingItemAtURL:mofileUrl options:NSFileCoordinatorWritingForReplacing error:nil byAccessor:^(NSURL *newURL) {
+        NSURL *resultingUrl;
+        BOOL ok = [[NSFileManager defaultManager] replaceItemAtURL:newURL
+                                                     withItemAtURL:mofiletempUrl
+                                                    backupItemName:nil
+                                                           options:0
+                                                  resultingItemURL:&resultingUrl
+                                                             error:nil];
+        if (!ok)
+        {
+            wxLogError(_(L"Couldn’t save file %s."), mo_file.c_str());
+            mo_compilation_status = Catalog::CompilationStatus::Error;
+        }
+    }];
 
-@interface CompiledMOFilePresenter : NSObject<NSFilePresenter>
-@property (atomic, copy) NSURL *presentedItemURL;
-@property (atomic, copy) NSURL *primaryPresentedItemURL;
-@end
+    [NSFileCoordinator removeFilePresenter:presenter];
+#else // !__WXOSX__
+    if ( !mo_file_temp_obj.Commit() )
+    {
+        wxLogError(_(L"Couldn’t save file %s."), mo_file.c_str());
+        mo_compilation_status = Catalog::CompilationStatus::Error;
+    }
+#endif // __WXOSX__/!__WXOSX__
 
-@implementation CompiledMOFilePresenter
-- (NSOperationQueue *)presentedItemOperationQueue {
-     return [NSOperationQueue mainQueue];
+    return mo_compilation_status;
 }
-@end
 
-#endif // __WXOSX__
+} // anonymous namespace
 
 
-bool POCatalog::Save(const wxString& po_file, bool save_mo,
-                     ValidationResults& validation_results, CompilationStatus& mo_compilation_status)
+bool POCatalog::PrepareHeaderForSave(const wxString& po_file)
 {
-    mo_compilation_status = CompilationStatus::NotDone;
-
     if ( wxFileExists(po_file) && !wxFile::Access(po_file, wxFile::write) )
     {
         wxLogError(_(L"File “%s” is read-only and cannot be saved.\nPlease save it under different name."),
@@ -1166,220 +1958,275 @@ bool POCatalog::Save(const wxString& po_file, bool save_mo,
             break;
     }
 
-    TempOutputFileFor po_file_temp_obj(po_file);
-    const wxString po_file_temp = po_file_temp_obj.FileName();
-
-    wxTextFileType outputCrlf = GetDesiredCRLFFormat(m_fileCRLF);
-    // Save into Unix line endings first and only if Windows is required,
-    // reformat the file later. This is because msgcat cannot handle DOS
-    // input particularly well.
-
-    if ( !DoSaveOnly(po_file_temp, wxTextFileType_Unix) )
+    return true;
+}
+
+
+bool POCatalog::ShouldCompileMO(bool save_mo) const
+{
+    if (!save_mo || m_fileType != Type::PO)
+        return false;
+    return wxConfig::Get()->Read("compile_mo", (long)true) != 0;
+}
+
+
+bool POCatalog::Save(const wxString& po_file, bool save_mo,
+                     ValidationResults& validation_results, CompilationStatus& mo_compilation_status)
+{
+    mo_compilation_status = CompilationStatus::NotDone;
+
+    if (!PrepareHeaderForSave(po_file))
+        return false;
+
+    TempOutputFileFor po_file_temp_obj(po_file);
+    const wxString po_file_temp = po_file_temp_obj.FileName();
+
+    // The file is written in its final form right away, formatted the same
+    // way msgcat would do it, so no reformatting pass is needed afterwards.
+    const wxTextFileType outputCrlf = GetDesiredCRLFFormat(m_fileCRLF);
+
+    const bool compileMO = ShouldCompileMO(save_mo);
+
+    // If the user wants it, compile .mo file in the background while the PO
+    // file is being written:
+    std::future<std::string> mo_data_future;
+    if (compileMO)
+        mo_data_future = CreateMODataAsync();
+    const wxString mo_charset = m_header.Charset;
+
+    const bool po_saved = DoSaveOnly(po_file_temp, outputCrlf);
+
+    std::string mo_data;
+    if (compileMO)
+    {
+        mo_data = mo_data_future.get();
+        // DoSaveOnly() falls back to UTF-8 if the catalog can't be encoded in
+        // its charset, the MO file must be compiled again in that case:
+        if (po_saved && m_header.Charset != mo_charset)
+            mo_data = CreateMODataAsync().get();
+    }
+
+    if ( !po_saved )
+    {
+        wxLogError(_(L"Couldn’t save file %s."), po_file.c_str());
+        return false;
+    }
+
+    try
+    {
+        validation_results = Validate();
+    }
+    catch (...)
+    {
+        // Validation failures shouldn't prevent Poedit from trying to save
+        // user's file.
+        wxLogError("%s", DescribeCurrentException());
+    }
+
+    if ( !po_file_temp_obj.Commit() )
     {
         wxLogError(_(L"Couldn’t save file %s."), po_file.c_str());
         return false;
     }
 
+    /* Write the compiled .mo file: */
+    if (compileMO)
+        mo_compilation_status = WriteMOFile(po_file, mo_data);
+
+    SetFileName(po_file);
+
+    return true;
+}
+
+
+std::shared_ptr<POCatalog::SaveJob> POCatalog::PrepareSave(const wxString& po_file, bool save_mo)
+{
+    if (!PrepareHeaderForSave(po_file))
+        return nullptr;
+
+    std::shared_ptr<SaveJob> job(new SaveJob);
+    job->m_filename = po_file;
+    job->m_crlf = GetDesiredCRLFFormat(m_fileCRLF);
+    job->m_validate = HasCapability(Cap::Translations);
+    job->m_compileMO = ShouldCompileMO(save_mo);
+
+    // The snapshot only copies items, their texts are shared with this catalog
+    // and details not loaded yet are loaded by the job as needed:
+    POCatalogPtr snapshot(new POCatalog(m_fileType));
+    snapshot->m_fileName = po_file;
+    snapshot->m_header = m_header;
+    snapshot->m_sourceLanguage = m_sourceLanguage;
+    snapshot->m_sourceIsSymbolicID = m_sourceIsSymbolicID;
+    snapshot->m_fileCRLF = m_fileCRLF;
+    snapshot->m_fileWrappingWidth = m_fileWrappingWidth;
+    snapshot->m_hasPluralItems = m_hasPluralItems;
+    snapshot->m_originalData = m_originalData;
+    snapshot->m_deletedItems = m_deletedItems;
+    snapshot->m_cacheKey = std::move(m_cacheKey);
+    snapshot->m_cachedValidation = std::move(m_cachedValidation);
+
+    snapshot->m_items.reserve(m_items.size());
+    job->m_items.reserve(m_items.size());
+    for (auto& i: m_items)
+    {
+        snapshot->m_items.push_back(std::static_pointer_cast<POCatalogItem>(i)->Clone());
+        job->m_items.push_back({i, i->GetEditCount()});
+    }
+
+    job->m_snapshot = snapshot;
+    return job;
+}
+
+
+POCatalog::SaveJob::Results POCatalog::SaveJob::Run()
+{
+    Results results;
     try
     {
-        validation_results = Validate(/*fileWithSameContent=*/po_file_temp);
+        results = DoRun();
     }
     catch (...)
     {
-        // DoValidate may fail catastrophically if app bundle is damaged, but
-        // that shouldn't prevent Poedit from trying to save user's file.
+        wxLogError(_(L"The file “%s” couldn’t be saved."), wxFileName(m_filename).GetFullName());
         wxLogError("%s", DescribeCurrentException());
     }
 
-    // Now that the file was written, run msgcat to re-format it according
-    // to the usual format. This is a (barely) passable fix for #25 until
-    // proper preservation of formatting is implemented.
+    // the copies aren't needed anymore, don't keep the original data alive:
+    m_snapshot.reset();
 
-    bool msgcat_ok = false;
     {
-        wxArrayString args { "msgcat", "--force-po" };
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_results = results;
+        m_running = false;
+    }
+    m_finished.notify_all();
 
-        int wrapping = DEFAULT_WRAPPING;
-        if (wxConfig::Get()->ReadBool("keep_crlf", true))
-            wrapping = m_fileWrappingWidth;
+    return results;
+}
 
-        if (wrapping == DEFAULT_WRAPPING)
-        {
-            if (wxConfig::Get()->ReadBool("wrap_po_files", true))
-            {
-                wrapping = (int)wxConfig::Get()->ReadLong("wrap_po_files_width", 79);
-            }
-            else
-            {
-                wrapping = NO_WRAPPING;
-            }
-        }
 
-        if (wrapping == NO_WRAPPING)
-            args.push_back("--no-wrap");
-        else if (wrapping != DEFAULT_WRAPPING)
-            args.push_back(wxString::Format("--width=%d", wrapping));
+void POCatalog::SaveJob::Wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this]{ return !m_running; });
+}
 
-        TempOutputFileFor po_file_temp2_obj(po_file_temp);
-        const wxString po_file_temp2 = po_file_temp2_obj.FileName();
 
-        args.push_back("-o");
-        args.push_back(po_file_temp2);
-        args.push_back(po_file_temp);
+POCatalog::SaveJob::Results POCatalog::SaveJob::DoRun()
+{
+    Results results;
+    auto& snapshot = *m_snapshot;
 
-        wxLogTrace("poedit", "formatting file with %s", wxJoin(args, ' '));
+    TempOutputFileFor po_file_temp_obj(m_filename);
+    const wxString po_file_temp = po_file_temp_obj.FileName();
 
-        // Ignore msgcat errors output (but not exit code), because it
-        //   a) complains about things DoValidate() already complained above
-        //   b) issues warnings about source-extraction things (e.g. using non-ASCII
-        //      msgids) that, while correct, are not something a *translator* can
-        //      do anything about.
-        GettextRunner runner;
-        msgcat_ok = runner.run_sync(args) && wxFileExists(po_file_temp2);
+    // This falls back to UTF-8 if the snapshot can't be encoded in its
+    // charset, so the MO file must be compiled only after it:
+    if (!snapshot.DoSaveOnly(po_file_temp, m_crlf))
+    {
+        wxLogError(_(L"Couldn’t save file %s."), m_filename.c_str());
+        return results;
+    }
 
-        // msgcat always outputs Unix line endings, so we need to reformat the file
-        if (msgcat_ok && outputCrlf == wxTextFileType_Dos)
-        {
-            wxCSConv conv(m_header.Charset);
-            wxTextFile finalFile(po_file_temp2);
-            if (finalFile.Open(conv))
-                finalFile.Write(outputCrlf, conv);
-        }
+    results.charset = snapshot.m_header.Charset;
+    results.lineNumbers.reserve(snapshot.m_items.size());
+    for (auto& i: snapshot.m_items)
+        results.lineNumbers.push_back(i->GetLineNumber());
+    results.deletedLineNumbers.reserve(snapshot.m_deletedItems.size());
+    for (auto& d: snapshot.m_deletedItems)
+        results.deletedLineNumbers.push_back(d.GetLineNumber());
 
-        if (msgcat_ok && !TempOutputFileFor::ReplaceFile(po_file_temp2, po_file))
-            msgcat_ok = false;
-    }
+    std::future<std::string> mo_data_future;
+    if (m_compileMO)
+        mo_data_future = snapshot.CreateMODataAsync();
 
-    if ( msgcat_ok )
+    if (m_validate)
     {
-        wxRemoveFile(po_file_temp);
-    }
-    else
-    {
-        if ( !po_file_temp_obj.Commit() )
+        try
         {
-            wxLogError(_(L"Couldn’t save file %s."), po_file.c_str());
+            results.validation = snapshot.Validate();
+            results.issues.reserve(snapshot.m_items.size());
+            for (auto& i: snapshot.m_items)
+                results.issues.push_back(i->GetIssue());
         }
-        else
+        catch (...)
         {
-            // Only shows msgcat's failure warning if we don't also get
-            // validation errors, because if we do, the cause is likely the
-            // same.
-            if ( !validation_results.errors )
-            {
-                wxLogWarning(_("There was a problem formatting the file nicely (but it was saved all right)."));
-            }
+            // Validation failures shouldn't prevent Poedit from trying to save
+            // user's file.
+            wxLogError("%s", DescribeCurrentException());
         }
     }
 
-    
-    /* If the user wants it, compile .mo file right now: */
-
-    bool compileMO = save_mo;
-    if (!wxConfig::Get()->Read("compile_mo", (long)true))
-        compileMO = false;
+    std::string mo_data;
+    if (m_compileMO)
+        mo_data = mo_data_future.get();
 
-    if (m_fileType == Type::PO && compileMO)
+    if ( !po_file_temp_obj.Commit() )
     {
-        const wxString mo_file = wxFileName::StripExtension(po_file) + ".mo";
-        TempOutputFileFor mo_file_temp_obj(mo_file);
-        const wxString mo_file_temp = mo_file_temp_obj.FileName();
-
-        {
-            // Ignore msgfmt errors output (but not exit code), because it
-            // complains about things DoValidate() already complained above.
-            if (GettextRunner().run_sync("msgfmt", "-o", mo_file_temp, CliSafeFileName(po_file)))
-            {
-                mo_compilation_status = CompilationStatus::Success;
-            }
-            else
-            {
-                // Don't report errors, they were reported as part of validation
-                // step above.  Notice that we run msgfmt *without* the -c flag
-                // here to create the MO file in as many cases as possible, even if
-                // it has some errors.
-                //
-                // Still, msgfmt has the ugly habit of sometimes returning non-zero
-                // exit code, reporting "fatal errors" and *still* producing a usable
-                // .mo file. If this happens, don't pretend the file wasn't created.
-                if (wxFileName::FileExists(mo_file_temp))
-                    mo_compilation_status = CompilationStatus::Success;
-                else
-                    mo_compilation_status = CompilationStatus::Error;
-            }
-        }
-
-        // Move the MO from temporary location to the final one, if it was created
-        if (mo_compilation_status == CompilationStatus::Success)
-        {
-#ifdef __WXOSX__
-            NSURL *mofileUrl = [NSURL fileURLWithPath:str::to_NS(mo_file)];
-            NSURL *mofiletempUrl = [NSURL fileURLWithPath:str::to_NS(mo_file_temp)];
-
-            CompiledMOFilePresenter *presenter = [CompiledMOFilePresenter new];
-            presenter.presentedItemURL = mofileUrl;
-            presenter.primaryPresentedItemURL = [NSURL fileURLWithPath:str::to_NS(po_file)];
-            [NSFileCoordinator addFilePresenter:presenter];
-
-            NSFileCoordinator *coo = [[NSFileCoordinator alloc] initWithFilePresenter:presenter];
-            [coo coordinateWritingItemAtURL:mofileUrl options:NSFileCoordinatorWritingForReplacing error:nil byAccessor:^(NSURL *newURL) {
-                NSURL *resultingUrl;
-                BOOL ok = [[NSFileManager defaultManager] replaceItemAtURL:newURL
-                                                             withItemAtURL:mofiletempUrl
-                                                            backupItemName:nil
-                                                                   options:0
-                                                          resultingItemURL:&resultingUrl
-                                                                     error:nil];
-                if (!ok)
-                {
-                    wxLogError(_(L"Couldn’t save file %s."), mo_file.c_str());
-                    mo_compilation_status = CompilationStatus::Error;
-                }
-            }];
-
-            [NSFileCoordinator removeFilePresenter:presenter];
-#else // !__WXOSX__
-            if ( !mo_file_temp_obj.Commit() )
-            {
-                wxLogError(_(L"Couldn’t save file %s."), mo_file.c_str());
-                mo_compilation_status = CompilationStatus::Error;
-            }
-#endif // __WXOSX__/!__WXOSX__
-        }
+        wxLogError(_(L"Couldn’t save file %s."), m_filename.c_str());
+        return results;
     }
+    results.saved = true;
 
-    SetFileName(po_file);
+    if (m_compileMO)
+        results.moCompilationStatus = WriteMOFile(m_filename, mo_data);
 
-    return true;
+    return results;
 }
 
 
-std::string POCatalog::SaveToBuffer()
+void POCatalog::SaveJob::ApplyResults(POCatalog& catalog, const Results& results) const
 {
-    class StringSerializer : public wxMemoryText
+    if (!results.saved)
+        return;
+
+    if (results.charset != catalog.m_header.Charset)
+        catalog.m_header.Charset = results.charset;
+
+    // Line numbers refer to the saved file, so they apply even to items edited
+    // since, as long as they are still there:
+    auto& items = catalog.m_items;
+    const size_t count = std::min(items.size(), m_items.size());
+    for (size_t i = 0; i < count; i++)
     {
-    public:
-        bool OnWrite(wxTextFileType typeNew, const wxMBConv& conv) override
-        {
-            size_t cnt = GetLineCount();
-            for (size_t n = 0; n < cnt; n++)
-            {
-                auto ln = GetLine(n) +
-                          GetEOL(typeNew == wxTextFileType_None ? GetLineType(n) : typeNew);
-                auto buf = ln.mb_str(conv);
-                buffer.append(buf.data(), buf.length());
-            }
-            return true;
-        }
+        if (items[i] == m_items[i].item)
+            std::static_pointer_cast<POCatalogItem>(items[i])->SetLineNumber(results.lineNumbers[i]);
+    }
+    if (catalog.m_deletedItems.size() == results.deletedLineNumbers.size())
+    {
+        for (size_t i = 0; i < results.deletedLineNumbers.size(); i++)
+            catalog.m_deletedItems[i].SetLineNumber(results.deletedLineNumbers[i]);
+    }
+    catalog.InvalidateLineNumbersIndex();
 
-        std::string buffer;
-    };
+    // Same as in DoSaveOnly(), the snapshot doesn't hold it anymore:
+    if (catalog.m_originalData && catalog.m_originalData.use_count() == 1)
+        catalog.m_originalData.reset();
+
+    if (results.issues.size() != m_items.size())
+        return;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        // the item's current state may differ from the validated one:
+        auto& snapshot = m_items[i];
+        if (items[i] != snapshot.item || items[i]->GetEditCount() != snapshot.editCount)
+            continue;
+
+        if (results.issues[i])
+            items[i]->SetIssue(results.issues[i]);
+        else
+            items[i]->ClearIssue();
+    }
+}
 
-    StringSerializer f;
 
-    if (!DoSaveOnly(f, wxTextFileType_Unix))
+std::string POCatalog::SaveToBuffer()
+{
+    std::string buffer;
+    if (!DoSaveOnly(buffer, wxTextFileType_Unix))
         return std::string();
-    return f.buffer;
+    return buffer;
 }
 
 
@@ -1389,35 +2236,18 @@ bool POCatalog::CompileToMO(const wxString& mo_file,
 {
     mo_compilation_status = CompilationStatus::NotDone;
 
-    TempDirectory tmpdir;
-    if ( !tmpdir.IsOk() )
-        return false;
-
-    wxFileName mofn(mo_file);
-    wxString po_file_temp = tmpdir.CreateFileName(mofn.GetName() + ".po");
-
-    if ( !DoSaveOnly(po_file_temp, wxTextFileType_Unix) )
-    {
-        wxLogError(_(L"Couldn’t save file %s."), po_file_temp.c_str());
-        return false;
-    }
-
-    validation_results = Validate(/*fileWithSameContent=*/po_file_temp);
+    // The compilation works with its own copy of the messages, so validation
+    // can run concurrently with it:
+    auto mo_data_future = CreateMODataAsync();
+    validation_results = Validate();
+    const std::string mo_data = mo_data_future.get();
 
     TempOutputFileFor mo_file_temp_obj(mo_file);
     const wxString mo_file_temp = mo_file_temp_obj.FileName();
 
-    GettextRunner runner;
-    runner.run_sync("msgfmt", "-o", mo_file_temp, po_file_temp);
-
-    // Ignore msgfmt errors output (but not exit code), because it
-    // complains about things DoValidate() already complained above.
-    //
-    // Don't check return code either:
-    // msgfmt has the ugly habit of sometimes returning non-zero
-    // exit code, reporting "fatal errors" and *still* producing a usable
-    // .mo file. If this happens, don't pretend the file wasn't created.
-    if (!wxFileName::FileExists(mo_file_temp))
+    // Like msgfmt without the -c flag, the MO file is created even if the
+    // catalog has some errors; they were reported by Validate() above.
+    if (mo_data.empty() || !WriteFileData(mo_file_temp, mo_data))
     {
         mo_compilation_status = CompilationStatus::Error;
         return false;
@@ -1441,14 +2271,14 @@ bool POCatalog::CompileToMO(const wxString& mo_file,
 
 bool POCatalog::DoSaveOnly(const wxString& po_file, wxTextFileType crlf)
 {
-    wxTextFile f;
-    if (!f.Create(po_file))
+    std::string output;
+    if (!DoSaveOnly(output, crlf))
         return false;
 
-    return DoSaveOnly(f, crlf);
+    return WriteFileData(po_file, output);
 }
 
-bool POCatalog::DoSaveOnly(wxTextBuffer& f, wxTextFileType crlf)
+bool POCatalog::DoSaveOnly(std::string& output, wxTextFileType crlf)
 {
     const bool isPOT = m_fileType == Type::POT;
 
@@ -1456,110 +2286,267 @@ bool POCatalog::DoSaveOnly(wxTextBuffer& f, wxTextFileType crlf)
     if (!m_header.Charset || m_header.Charset == "CHARSET")
         m_header.Charset = "UTF-8";
 
-    SaveMultiLines(f, m_header.Comment);
+    // The writer always produces UTF-8, other charsets are converted to at the end:
+    const bool isUTF8 = IsUTF8Charset(m_header.Charset);
+    std::string utf8;
+    std::string& buffer = isUTF8 ? output : utf8;
+    output.clear();
+
+    // Messages are written directly into the buffer, so reserve enough space
+    // for the whole file upfront to avoid reallocations:
+    if (m_originalData)
+        buffer.reserve(m_originalData->size() + m_originalData->size() / 8);
+    else
+        buffer.reserve((m_items.size() + m_deletedItems.size() + 1) * 256);
+
+    const int wrapping = GetDesiredWrappingWidth(m_fileWrappingWidth);
+    POWriter writer(buffer, wrapping,
+                    str::to_utf8(m_header.Charset), crlf == wxTextFileType_Dos);
+
+    // Entries that weren't modified since loading can be copied from the
+    // original file verbatim, as long as it is written with the same formatting:
+    const bool canCopyOriginal = m_originalData &&
+                                 wrapping == m_fileWrappingWidth &&
+                                 (crlf == wxTextFileType_Dos) == (m_fileCRLF == wxTextFileType_Dos);
+    auto isOriginal = [this](const POOriginalText& text)
+    {
+        return text.IsOk() && text.data == m_originalData;
+    };
+
+    POWriter::Entry header;
+    header.AddRawComments(str::to_utf8(m_header.Comment));
     if (isPOT)
-        f.AddLine(wxS("#, fuzzy"));
-    f.AddLine(wxS("msgid \"\""));
-    f.AddLine(wxS("msgstr \"\""));
-    wxString pohdr = wxString(wxS("\"")) + m_header.ToString(wxS("\"\n\""));
-    pohdr.RemoveLast();
-    SaveMultiLines(f, pohdr);
-    f.AddLine(wxEmptyString);
+        header.flags += ", fuzzy";
+    header.translations.push_back(str::to_utf8(UnescapeCString(m_header.ToString())));
+    writer.Write(header);
 
     auto pluralsCount = std::max(GetPluralFormsCountPresentInItems(), GetPluralForms().nplurals());
 
+    // reused for all entries to save memory allocations:
+    POWriter::Entry e;
+
     for (auto& data_: m_items)
     {
         auto data = std::static_pointer_cast<POCatalogItem>(data_);
 
-        data->SetLineNumber(int(f.GetLineCount()+1));
-        SaveMultiLines(f, data->GetComment());
-        for (unsigned i = 0; i < data->GetExtractedComments().GetCount(); i++)
+        // Entries with deferred details still contain conflict markers that
+        // the parser would filter out; writing them normally loads the
+        // details, which drops the markers:
+        if (canCopyOriginal && isOriginal(data->m_originalText) &&
+            !data->IsModified() && !data->m_sideloaded &&
+            !(data->HasDeferredData() && MayContainMsgcatConflictMarker(data->m_originalText)) &&
+            (data->HasPlural() ? data->GetNumberOfTranslations() == pluralsCount : !isPOT || data->GetTranslation().empty()))
         {
-            if (data->GetExtractedComments()[i].empty())
-              f.AddLine(wxS("#."));
-            else
-              f.AddLine(wxS("#. ") + data->GetExtractedComments()[i]);
+            auto& text = data->m_originalText;
+            data->SetLineNumber(writer.WriteVerbatim(text.Data(), text.Length()));
+            continue;
         }
-        for (unsigned i = 0; i < data->GetRawReferences().GetCount(); i++)
-            f.AddLine(wxS("#: ") + data->GetRawReferences()[i]);
-        wxString dummy = data->GetFlags();
-        if (!dummy.empty())
-            f.AddLine(wxS("#") + dummy);
-        for (unsigned i = 0; i < data->GetOldMsgidRaw().GetCount(); i++)
-            f.AddLine(wxS("#| ") + data->GetOldMsgidRaw()[i]);
-        if ( data->HasContext() )
+
+        e.Clear();
+        e.AddRawComments(str::to_utf8(data->GetComment()));
+        for (auto& c: data->GetExtractedComments())
+            e.extractedComments.push_back(str::to_utf8(c));
+        for (auto& r: data->GetRawReferences())
+            e.references.push_back(str::to_utf8(r));
+        e.flags += str::to_utf8(data->GetFlags());
+        for (auto& old: data->GetOldMsgidRaw())
+            e.previous.push_back(str::to_utf8(old));
+
+        if (data->HasContext())
         {
-            SaveMultiLines(f, wxS("msgctxt \"") + FormatStringForFile(data->GetContext()) + wxS("\""));
+            e.hasContext = true;
+            e.context = str::to_utf8(data->GetContext());
         }
-        dummy = FormatStringForFile(data->GetRawString());
-        SaveMultiLines(f, wxS("msgid \"") + dummy + wxS("\""));
+        e.msgid = str::to_utf8(data->GetRawString());
         if (data->HasPlural())
         {
-            dummy = FormatStringForFile(data->GetRawPluralString());
-            SaveMultiLines(f, wxS("msgid_plural \"") + dummy + wxS("\""));
-
+            e.hasPlural = true;
+            e.msgidPlural = str::to_utf8(data->GetRawPluralString());
             for (unsigned i = 0; i < pluralsCount; i++)
-            {
-                dummy = FormatStringForFile(data->GetTranslation(i));
-                wxString hdr = wxString::Format(wxS("msgstr[%u] \""), i);
-                SaveMultiLines(f, hdr + dummy + wxS("\""));
-            }
+                e.translations.push_back(str::to_utf8(data->GetTranslation(i)));
         }
         else
         {
-            if (isPOT)
-            {
-                f.AddLine(wxS("msgstr \"\""));
-            }
-            else
-            {
-                dummy = FormatStringForFile(data->GetTranslation());
-                SaveMultiLines(f, wxS("msgstr \"") + dummy + wxS("\""));
-            }
+            e.translations.push_back(isPOT ? std::string() : str::to_utf8(data->GetTranslation()));
         }
-        f.AddLine(wxEmptyString);
+
+        data->SetLineNumber(writer.Write(e));
     }
 
     // Write back deleted items in the file so that they're not lost
-    for (unsigned itemIdx = 0; itemIdx < m_deletedItems.size(); itemIdx++)
+    const POOriginalText *previousOriginal = nullptr;
+    for (auto& deletedItem: m_deletedItems)
     {
-        if ( itemIdx != 0 )
-            f.AddLine(wxEmptyString);
+        auto& text = deletedItem.GetOriginalText();
+        if (canCopyOriginal && isOriginal(text))
+        {
+            // obsolete messages split by the parser are adjacent in the file:
+            const bool continuation = previousOriginal && previousOriginal->end == text.begin;
+            deletedItem.SetLineNumber(writer.WriteVerbatim(text.Data(), text.Length(), continuation));
+            previousOriginal = &text;
+            continue;
+        }
+        previousOriginal = nullptr;
+
+        e.Clear();
+        e.AddRawComments(str::to_utf8(deletedItem.GetComment()));
+        for (auto& c: deletedItem.GetExtractedComments())
+            e.extractedComments.push_back(str::to_utf8(c));
+        for (auto& r: deletedItem.GetRawReferences())
+            e.references.push_back(str::to_utf8(r));
+        e.flags += str::to_utf8(deletedItem.GetFlags());
 
-        POCatalogDeletedData& deletedItem = m_deletedItems[itemIdx];
-        deletedItem.SetLineNumber(int(f.GetLineCount()+1));
-        SaveMultiLines(f, deletedItem.GetComment());
-        for (unsigned i = 0; i < deletedItem.GetExtractedComments().GetCount(); i++)
-            f.AddLine(wxS("#. ") + deletedItem.GetExtractedComments()[i]);
-        for (unsigned i = 0; i < deletedItem.GetRawReferences().GetCount(); i++)
-            f.AddLine(wxS("#: ") + deletedItem.GetRawReferences()[i]);
-        wxString dummy = deletedItem.GetFlags();
-        if (!dummy.empty())
-            f.AddLine(wxS("#") + dummy);
+        std::vector<std::string> lines;
+        for (auto& ln: deletedItem.GetDeletedLines())
+            lines.push_back(str::to_utf8(ln));
 
-        for (size_t j = 0; j < deletedItem.GetDeletedLines().GetCount(); j++)
-            f.AddLine(deletedItem.GetDeletedLines()[j]);
+        deletedItem.SetLineNumber(writer.WriteObsolete(e, lines));
     }
 
-    if (!CanEncodeToCharset(f, m_header.Charset))
+    writer.Finish();
+
+    // Items were renumbered to match the written file:
+    InvalidateLineNumbersIndex();
+
+    // Once no entry refers to the original text anymore (because all were
+    // modified), there's no point in keeping it in memory:
+    if (m_originalData && m_originalData.use_count() == 1)
+        m_originalData.reset();
+
+    if (isUTF8)
+        return true;
+
+    const wxCharBuffer converted(wxString::FromUTF8(utf8.data(), utf8.size()).mb_str(wxCSConv(m_header.Charset)));
+    if (!utf8.empty() && converted.length() == 0)
     {
 #if wxUSE_GUI
         wxString msg;
         msg.Printf(_(L"The file couldn’t be saved in “%s” charset as specified in translation settings.\n\nIt was saved in UTF-8 instead and the setting was modified accordingly."),
                    m_header.Charset.c_str());
-        wxMessageBox(msg, _("Error saving file"),
-                     wxOK | wxICON_EXCLAMATION);
+        // may be saving in the background, see POCatalog::SaveJob:
+        dispatch::on_main([msg]{
+            wxMessageBox(msg, _("Error saving file"),
+                         wxOK | wxICON_EXCLAMATION);
+        });
 #endif
         m_header.Charset = "UTF-8";
 
         // Re-do the save again because we modified a header:
-        f.Clear();
-        return DoSaveOnly(f, crlf);
+        return DoSaveOnly(output, crlf);
     }
 
     // Otherwise everything can be safely saved:
-    return f.Write(crlf, wxCSConv(m_header.Charset));
+    output.assign(converted.data(), converted.length());
+    return true;
+}
+
+std::future<std::string> POCatalog::CreateMODataAsync()
+{
+    // Everything the compilation needs is copied into plain UTF-8 strings
+    // here, so that the background thread doesn't touch the items, which may
+    // be modified (e.g. by DoSaveOnly() or Validate()) in the meantime:
+    if (!m_header.Charset || m_header.Charset == "CHARSET")
+        m_header.Charset = "UTF-8";
+    const wxString charset = m_header.Charset;
+    const std::string header = str::to_utf8(UnescapeCString(m_header.ToString()));
+    const unsigned pluralsCount = std::max(GetPluralFormsCountPresentInItems(), GetPluralForms().nplurals());
+
+    struct Message
+    {
+        bool hasContext = false;
+        bool hasPlural = false;
+        std::string context, msgid, msgidPlural;
+        std::vector<std::string> msgstr;
+    };
+
+    std::vector<Message> messages;
+    messages.reserve(m_items.size());
+    for (auto& item: m_items)
+    {
+        // Skip entries that msgfmt wouldn't include either: it ignores fuzzy
+        // entries and those whose msgstr starts with NUL, i.e. whose first
+        // (or only) form is empty, even if other plural forms are translated
+        if (item->IsFuzzy() || item->GetTranslation().empty())
+            continue;
+
+        Message m;
+        if (item->HasContext())
+        {
+            m.hasContext = true;
+            m.context = str::to_utf8(item->GetContext());
+        }
+        m.msgid = str::to_utf8(item->GetRawString());
+        if (item->HasPlural())
+        {
+            m.hasPlural = true;
+            m.msgidPlural = str::to_utf8(item->GetRawPluralString());
+            m.msgstr.reserve(pluralsCount);
+            for (unsigned i = 0; i < pluralsCount; i++)
+                m.msgstr.push_back(str::to_utf8(item->GetTranslation(i)));
+        }
+        else
+        {
+            m.msgstr.push_back(str::to_utf8(item->GetTranslation()));
+        }
+        messages.push_back(std::move(m));
+    }
+
+    return std::async(std::launch::async, [charset, header, messages = std::move(messages)]() mutable -> std::string
+    {
+        const bool isUTF8 = IsUTF8Charset(charset);
+        std::unique_ptr<wxCSConv> conv;
+        if (!isUTF8)
+            conv.reset(new wxCSConv(charset));
+
+        bool encodingOk = true;
+        auto encode = [&](std::string& s)
+        {
+            if (isUTF8 || s.empty())
+                return;
+            const wxCharBuffer buf(wxString::FromUTF8(s.data(), s.size()).mb_str(*conv));
+            if (buf.length() == 0)
+                encodingOk = false;
+            s.assign(buf.data(), buf.length());
+        };
+
+        MOWriter writer;
+        writer.Reserve(messages.size() + 1);
+
+        // Fuzzy header is included, just like msgfmt does:
+        if (!header.empty())
+        {
+            std::string headerData(header);
+            encode(headerData);
+            writer.Add(nullptr, std::string(), headerData);
+        }
+
+        for (auto& m: messages)
+        {
+            if (m.hasContext)
+                encode(m.context);
+            encode(m.msgid);
+            for (auto& s: m.msgstr)
+                encode(s);
+
+            if (m.hasPlural)
+            {
+                encode(m.msgidPlural);
+                writer.Add(m.hasContext ? &m.context : nullptr, m.msgid, m.msgidPlural, m.msgstr);
+            }
+            else
+            {
+                writer.Add(m.hasContext ? &m.context : nullptr, m.msgid, m.msgstr.front());
+            }
+
+            if (!encodingOk)
+                return std::string();
+        }
+
+        if (!encodingOk)
+            return std::string();
+
+        return writer.Write();
+    });
 }
 
 void POCatalog::SetLanguage(Language lang)
@@ -1644,62 +2631,180 @@ bool POCatalog::FixDuplicateItems()
 }
 
 
-Catalog::ValidationResults POCatalog::Validate(const wxString& fileWithSameContent)
+Catalog::ValidationResults POCatalog::Validate()
+{
+    const bool qaChecks = AreQAChecksEnabled();
+
+    // Items' issues were restored from the cache when loading, so the results
+    // are still valid, unless QA checks were enabled or disabled since:
+    if (m_cachedValidation)
+    {
+        auto cached = std::move(m_cachedValidation);
+        if (cached->warningsChecked == qaChecks)
+            return cached->results;
+    }
+
+    ValidationResults res = DoValidate();
+
+    if (m_cacheKey)
+    {
+        auto key = std::move(m_cacheKey);
+        POCatalogCache::Store(*this, *key, POCatalogCache::Validation{res, qaChecks});
+    }
+
+    return res;
+}
+
+
+Catalog::ValidationResults POCatalog::DoValidate()
 {
-    ValidationResults res = Catalog::Validate(fileWithSameContent);
+    ValidationResults res = Catalog::Validate();
 
     if (!HasCapability(Catalog::Cap::Translations))
         return res;  // no errors in POT files
 
-    if (!fileWithSameContent.empty())
+    const wxString pluralFormsHeader = m_header.GetHeader("Plural-Forms");
+    const auto pluralForms = GetPluralForms();
+    const POValidator validator(pluralForms,
+                                !pluralFormsHeader.empty() && !pluralFormsHeader.Contains("INTEGER"),
+                                std::max(GetPluralFormsCountPresentInItems(), pluralForms.nplurals()));
+
+    // Items are checked independently of each other, so do it in parallel
+    // on large files:
+    struct RangeResult
     {
-        ValidateWithMsgfmt(res, fileWithSameContent);
-    }
-    else
+        int errors = 0;
+        std::vector<size_t> unsupported;
+    };
+
+    auto checkRange = [this, &validator](size_t begin, size_t end)
     {
-        TempDirectory tmpdir;
-        if ( !tmpdir.IsOk() )
-            return res;
+        RangeResult r;
+        for (size_t i = begin; i < end; i++)
+        {
+            auto& item = m_items[i];
+            auto err = validator.CheckItem(*item);
+            if (!err.empty())
+            {
+                r.errors++;
+                item->SetIssue(CatalogItem::Issue::Error, err);
+            }
+            if (validator.HasUnsupportedFormat(*item))
+                r.unsupported.push_back(i);
+        }
+        return r;
+    };
 
-        wxString tmp_po = tmpdir.CreateFileName("validated.po");
-        if ( !DoSaveOnly(tmp_po, wxTextFileType_Unix) )
-            return res;
+    const size_t count = m_items.size();
+    const unsigned workers = dispatch::default_parallelism();
+    const size_t chunk = std::max(count / workers + 1, (size_t)1000);
 
-        ValidateWithMsgfmt(res, tmp_po);
+    std::vector<RangeResult> ranges((count + chunk - 1) / chunk);
+    dispatch::parallel_for(ranges.size(), workers, [&](size_t c)
+    {
+        ranges[c] = checkRange(c * chunk, std::min((c + 1) * chunk, count));
+    });
+
+    std::vector<size_t> unsupported;
+    for (auto& r: ranges)
+    {
+        res.errors += r.errors;
+        unsupported.insert(unsupported.end(), r.unsupported.begin(), r.unsupported.end());
     }
 
+    // Format strings of languages POValidator doesn't implement must still
+    // be checked, so let msgfmt do it for (only) the affected entries:
+    if (!unsupported.empty())
+        ValidateWithMsgfmt(res, unsupported);
+
     return res;
 }
 
-void POCatalog::ValidateWithMsgfmt(Catalog::ValidationResults& res, const wxString& po_file)
+
+void POCatalog::ValidateWithMsgfmt(ValidationResults& res, const std::vector<size_t>& indices)
 {
+    TempDirectory tmpdir;
+    if ( !tmpdir.IsOk() )
+        return;
+
+    // Write a minimal PO file with just the header and entries to check,
+    // remembering where each of them starts to map errors back to items:
+    std::string data;
+    POWriter writer(data, /*wrapping=*/0, "UTF-8", /*crlf=*/false);
+
+    HeaderData header(m_header);
+    header.Charset = "UTF-8";
+    POWriter::Entry e;
+    e.translations.push_back(str::to_utf8(UnescapeCString(header.ToString())));
+    writer.Write(e);
+
+    const unsigned pluralsCount = std::max(GetPluralFormsCountPresentInItems(), GetPluralForms().nplurals());
+
+    std::vector<int> lines;
+    lines.reserve(indices.size());
+    for (auto idx: indices)
+    {
+        auto& item = m_items[idx];
+        e.Clear();
+        e.flags = str::to_utf8(item->GetFlags());
+        if (item->HasContext())
+        {
+            e.hasContext = true;
+            e.context = str::to_utf8(item->GetContext());
+        }
+        e.msgid = str::to_utf8(item->GetRawString());
+        if (item->HasPlural())
+        {
+            e.hasPlural = true;
+            e.msgidPlural = str::to_utf8(item->GetRawPluralString());
+            for (unsigned i = 0; i < pluralsCount; i++)
+                e.translations.push_back(str::to_utf8(item->GetTranslation(i)));
+        }
+        else
+        {
+            e.translations.push_back(str::to_utf8(item->GetTranslation()));
+        }
+        lines.push_back(writer.Write(e));
+    }
+    writer.Finish();
+
+    const wxString po_file = tmpdir.CreateFileName("validated.po");
+    if (!WriteFileData(po_file, data))
+        return;
+
     GettextRunner gtr;
     auto output = gtr.run_sync("msgfmt", "-o", "/dev/null", "-c", CliSafeFileName(po_file));
     auto errors = gtr.parse_stderr(output);
 
     for (auto& i: errors.items)
     {
-        if (i.has_location())
-        {
-            auto item = FindItemByLine(i.line);
-            if (item)
-            {
-                res.errors++;
-                item->SetIssue(CatalogItem::Issue::Error, i.text);
-            }
-        }
-        // else: ignore msgfmt output w/o a location because msgfmt outputs status information
-        //       (e.g. "N errors found") to stderr too
+        // ignore msgfmt output w/o a location because msgfmt outputs status
+        // information (e.g. "N errors found") to stderr too
+        if (!i.has_location())
+            continue;
+
+        // errors may be reported on any line of the entry, not just the first:
+        auto pos = std::upper_bound(lines.begin(), lines.end(), i.line);
+        if (pos == lines.begin())
+            continue;
+        auto& item = m_items[indices[pos - lines.begin() - 1]];
+
+        // the item's native checks take precedence, they are more specific:
+        if (item->HasError())
+            continue;
+
+        res.errors++;
+        item->SetIssue(CatalogItem::Issue::Error, i.text);
     }
 }
 
 
-bool POCatalog::UpdateFromPOT(const wxString& pot_file, bool replace_header)
+bool POCatalog::UpdateFromPOT(const wxString& pot_file, bool replace_header, MergeStats *stats)
 {
     try
     {
         POCatalogPtr pot = std::dynamic_pointer_cast<POCatalog>(Catalog::Create(pot_file, CreationFlag_IgnoreTranslations));
-        return UpdateFromPOT(pot, replace_header);
+        return UpdateFromPOT(pot, replace_header, stats);
     }
     catch (...) // FIXME
     {
@@ -1708,19 +2813,25 @@ bool POCatalog::UpdateFromPOT(const wxString& pot_file, bool replace_header)
     }
 }
 
-bool POCatalog::UpdateFromPOT(POCatalogPtr pot, bool replace_header)
+bool POCatalog::UpdateFromPOT(POCatalogPtr pot, bool replace_header, MergeStats *stats)
 {
     switch (m_fileType)
     {
         case Type::PO:
         {
-            if (!Merge(pot))
+            if (!Merge(pot, stats))
                 return false;
             break;
         }
         case Type::POT:
         {
-            m_items = pot->m_items;
+            // the items can't be shared, they would only update statistics
+            // of one of the catalogs:
+            m_items.clear();
+            m_items.reserve(pot->m_items.size());
+            for (auto& i: pot->m_items)
+                m_items.push_back(std::static_pointer_cast<POCatalogItem>(i)->Clone());
+            InvalidateItemsIndexes();
             m_sourceLanguage = pot->m_sourceLanguage;
             m_sourceIsSymbolicID = pot->m_sourceIsSymbolicID;
             m_hasPluralItems = pot->m_hasPluralItems;
@@ -1746,52 +2857,3 @@ POCatalogPtr POCatalog::CreateFromPOT(POCatalogPtr pot)
     else
         return nullptr;
 }
-
-bool POCatalog::Merge(const POCatalogPtr& refcat)
-{
-    wxString oldname = m_fileName;
-    wxON_BLOCK_EXIT_SET(m_fileName, oldname);
-
-    TempDirectory tmpdir;
-    if ( !tmpdir.IsOk() )
-        return false;
-
-    wxString tmp1 = tmpdir.CreateFileName("ref.pot");
-    wxString tmp2 = tmpdir.CreateFileName("input.po");
-    wxString tmp3 = tmpdir.CreateFileName("output.po");
-
-    refcat->DoSaveOnly(tmp1, wxTextFileType_Unix);
-    DoSaveOnly(tmp2, wxTextFileType_Unix);
-
-    std::vector<wxString> args { "msgmerge", "-q", "--force-po", "--previous" };
-    if (Config::MergeBehavior() == Merge_None)
-    {
-        args.push_back("--no-fuzzy-matching");
-    }
-
-    args.push_back("-o");
-    args.push_back(tmp3);
-    args.push_back(tmp2);
-    args.push_back(tmp1);
-
-    GettextRunner runner;
-    auto output = runner.run_sync(args);
-    // FIXME: Don't do that here, report as part of return value instead
-    runner.parse_stderr(output).log_errors();
-
-    if (output)
-    {
-        const wxString charset = m_header.Charset;
-
-        Load(tmp3);
-        m_fileName = oldname;
-        PostCreation();
-
-        // msgmerge doesn't always preserve the charset, it tends to pick
-        // the most generic one of the charsets used, so if we are merging with
-        // UTF-8 catalog, it will become UTF-8. Some people hate this.
-        m_header.Charset = charset;
-    }
-
-    return (bool)output;
-}
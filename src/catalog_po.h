@@ -27,13 +27,118 @@
 #define Poedit_catalog_po_h
 
 #include "catalog.h"
+#include "catalog_po_cache.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 class POCatalogItem;
 class POCatalog;
+class MappedFile;
+struct MergeStats;
 typedef std::shared_ptr<POCatalogItem> POCatalogItemPtr;
 typedef std::shared_ptr<POCatalog> POCatalogPtr;
 
 
+/** Content of the file a catalog was loaded from.
+
+    The file is kept memory-mapped where possible instead of being copied,
+    so that only the parts of it that are actually accessed (e.g. to show
+    entries' details) take up memory.
+ */
+class POFileData
+{
+public:
+    /// Uses mapped @a file's content, starting at @a offset (e.g. after BOM)
+    POFileData(std::unique_ptr<MappedFile>&& file, size_t offset);
+    /// Uses a copy of the data
+    POFileData(const char *begin, const char *end);
+    ~POFileData();
+
+    POFileData(const POFileData&) = delete;
+    POFileData& operator=(const POFileData&) = delete;
+
+    const char *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    std::unique_ptr<MappedFile> m_file;
+    std::string m_copy;
+    const char *m_data;
+    size_t m_size;
+};
+
+
+/** Original text of an entry in the file it was loaded from.
+
+    Entries that weren't modified since loading are written back verbatim,
+    which preserves their formatting exactly and makes saving large files
+    with few changes cheap. The text is shared by all entries of the file.
+ */
+struct POOriginalText
+{
+    std::shared_ptr<const POFileData> data;
+    size_t begin = 0, end = 0;
+
+    POOriginalText() {}
+    POOriginalText(const std::shared_ptr<const POFileData>& data_, size_t begin_, size_t end_)
+        : data(data_), begin(begin_), end(end_) {}
+
+    bool IsOk() const { return data != nullptr; }
+    void Reset() { data.reset(); }
+
+    const char *Data() const { return data->data() + begin; }
+    size_t Length() const { return end - begin; }
+};
+
+
+/**
+    References ("#: " lines) of a PO entry in compact form.
+
+    Most references are "path:line" and the same few paths repeat across
+    many entries, so each reference is stored as an interned path and an
+    integer line number. Raw lines are split on spaces only and restored
+    exactly as they were, including non-standard references.
+ */
+class POReferences
+{
+public:
+    POReferences() {}
+
+    /**
+        Sets references from raw "#: " lines (without the prefix).
+
+        Paths already interned by @a nearby, typically the previous entry,
+        are reused without locking the strings pool.
+     */
+    void Assign(const wxArrayString& lines, const POReferences *nearby = nullptr);
+
+    /// Returns the raw lines, as passed to Assign()
+    wxArrayString ToArray() const;
+
+    bool empty() const { return m_refs.empty(); }
+
+private:
+    InternedString InternPath(const wxString& path, const POReferences *nearby) const;
+
+    static const int32_t NO_LINE = -1;
+
+    struct Ref
+    {
+        InternedString path;
+        int32_t line;
+        bool startsLine; // first reference on its "#: " line
+    };
+
+    std::vector<Ref> m_refs;
+};
+
+
 class POCatalogItem : public CatalogItem
 {
 public:
@@ -42,17 +147,32 @@ public:
 
     wxArrayString GetReferences() const override;
 
+    /// Returns a copy of the item, e.g. for saving it in the background
+    POCatalogItemPtr Clone() const;
+
 protected:
-    const wxArrayString& GetRawReferences() const { return m_references; }
-    void SetRawReferences(const wxArrayString& ref) { m_references = ref; }
+    wxArrayString GetRawReferences() const { LoadDeferredDataIfNeeded(); return m_references.ToArray(); }
+    void SetRawReferences(const wxArrayString& ref) { m_references.Assign(ref); }
+
+    // Any modification of the item invalidates its original text, so
+    // anything still to be parsed from it must be loaded first:
+    void UpdateInternalRepresentation() override
+    {
+        LoadDeferredDataIfNeeded();
+        m_originalText.Reset();
+    }
 
-    void UpdateInternalRepresentation() override {}
+    // Parses references, extracted comments and previous msgid from the
+    // original text (see POCatalogParser::DeferEntryDetails()):
+    void LoadDeferredData() override;
 
     friend class POLoadParser;
     friend class POCatalog;
+    friend class POCatalogCache;
 
 protected:
-    wxArrayString m_references;
+    POReferences m_references;
+    POOriginalText m_originalText;
 };
 
 
@@ -78,7 +198,8 @@ public:
               m_extractedComments(dt.m_extractedComments),
               m_flags(dt.m_flags),
               m_comment(dt.m_comment),
-              m_lineNum(dt.m_lineNum) {}
+              m_lineNum(dt.m_lineNum),
+              m_originalText(dt.m_originalText) {}
 
     /// Returns the deleted lines.
     const wxArrayString& GetDeletedLines() const { return m_deletedLines; }
@@ -99,26 +220,31 @@ public:
     void AddReference(const wxString& ref)
     {
         if (m_references.Index(ref) == wxNOT_FOUND)
+        {
             m_references.Add(ref);
+            m_originalText.Reset();
+        }
     }
 
     /// Sets the string.
     void SetDeletedLines(const wxArrayString& a)
     {
         m_deletedLines = a;
+        m_originalText.Reset();
     }
 
     /// Sets the comment.
     void SetComment(const wxString& c)
     {
         m_comment = c;
+        m_originalText.Reset();
     }
 
     /** Sets gettext flags directly in string format. It may be
         either empty string or "#, fuzzy", "#, c-format",
         "#, fuzzy, c-format" or others (not understood by Poedit).
      */
-    void SetFlags(const wxString& flags) {m_flags = flags;};
+    void SetFlags(const wxString& flags) { m_flags = flags; m_originalText.Reset(); }
 
     /// Gets gettext flags. \see SetFlags
     wxString GetFlags() const {return m_flags;};
@@ -132,8 +258,17 @@ public:
     void AddExtractedComments(const wxString& com)
     {
         m_extractedComments.Add(com);
+        m_originalText.Reset();
     }
 
+    /// Sets the entry's text in the file it was loaded from; must be done
+    /// after setting all other data, as their setters reset it.
+    void SetOriginalText(const POOriginalText& text) { m_originalText = text; }
+    /// Returns the entry's original text, if it wasn't modified since loading.
+    const POOriginalText& GetOriginalText() const { return m_originalText; }
+
+    friend class POCatalogCache;
+
 private:
     wxArrayString m_deletedLines;
 
@@ -141,6 +276,7 @@ private:
     wxString m_flags;
     wxString m_comment;
     int m_lineNum;
+    POOriginalText m_originalText;
 };
 
 typedef std::vector<POCatalogDeletedData> POCatalogDeletedDataArray;
@@ -190,7 +326,21 @@ public:
 
     std::string SaveToBuffer() override;
 
-    ValidationResults Validate(const wxString& fileWithSameContent) override;
+    class SaveJob;
+
+    /**
+        Prepares saving the catalog in the background.
+
+        Does the part of Save() that needs the catalog on the main thread:
+        updates the header and takes a snapshot of the items. The returned
+        job doesn't access the catalog anymore, so it can be run on a
+        background thread while the catalog is being edited.
+
+        Returns nullptr if the catalog can't be saved to @a po_file.
+     */
+    std::shared_ptr<SaveJob> PrepareSave(const wxString& po_file, bool save_mo);
+
+    ValidationResults Validate() override;
 
     /// Compiles the catalog into binary MO file.
     bool CompileToMO(const wxString& mo_file,
@@ -217,8 +367,10 @@ public:
         { m_deletedItems.clear(); }
 
     /// Updates the catalog from POT file.
-    bool UpdateFromPOT(const wxString& pot_file, bool replace_header = false);
-    bool UpdateFromPOT(POCatalogPtr pot, bool replace_header = false);
+    /// If @a stats is provided, it is filled with strings added and removed
+    /// by the update (only when merging translations, i.e. not for POT files).
+    bool UpdateFromPOT(const wxString& pot_file, bool replace_header = false, MergeStats *stats = nullptr);
+    bool UpdateFromPOT(POCatalogPtr pot, bool replace_header = false, MergeStats *stats = nullptr);
     static POCatalogPtr CreateFromPOT(POCatalogPtr pot);
 
 protected:
@@ -238,7 +390,7 @@ protected:
     /// Adds entry to the catalog (the catalog will take ownership of
     /// the object).
     void AddItem(const POCatalogItemPtr& data)
-        { m_items.push_back(data); }
+        { m_items.push_back(data); InvalidateItemsIndexes(); }
 
     /// Adds entry to the catalog (the catalog will take ownership of
     /// the object).
@@ -249,19 +401,49 @@ protected:
     /// Fix commonly encountered fixable problems with loaded files
     void FixupCommonIssues();
 
-    void ValidateWithMsgfmt(ValidationResults& res, const wxString& po_file);
+    /// Performs the validation, see Validate()
+    ValidationResults DoValidate();
+
+    /// Checks items at @a indices with msgfmt -c and sets their issues
+    void ValidateWithMsgfmt(ValidationResults& res, const std::vector<size_t>& indices);
+
     bool DoSaveOnly(const wxString& po_file, wxTextFileType crlf);
-    bool DoSaveOnly(wxTextBuffer& f, wxTextFileType crlf);
+    bool DoSaveOnly(std::string& output, wxTextFileType crlf);
+
+    /// Checks that @a po_file can be written and updates header's timestamps
+    bool PrepareHeaderForSave(const wxString& po_file);
+
+    /// Whether MO file should be compiled when saving
+    bool ShouldCompileMO(bool save_mo) const;
+
+    /**
+        Starts compiling the catalog into MO file's data on a background thread.
+
+        Messages are copied on the calling thread, so the catalog can be
+        modified, saved or validated while the compilation runs. The resulting
+        data are empty if the catalog couldn't be encoded in its charset.
+     */
+    std::future<std::string> CreateMODataAsync();
 
     /** Merges the catalog with reference catalog
         (in the sense of msgmerge -- this catalog is old one with
         translations, \a refcat is reference catalog created by Update().)
 
+        The merge is done in memory: messages are matched exactly using
+        a hash index first and the remaining ones are fuzzy-matched (unless
+        disabled in preferences) against translated messages in parallel,
+        using the same similarity measure as msgmerge. Previous msgids of
+        fuzzy matches are recorded as msgmerge --previous does. See
+        catalog_po_merge.cpp.
+
+        \param stats If not null, filled with strings added and removed
+                     by the merge.
+
         \return true if the merge was successful, false otherwise.
                 Note that if it returns false, the catalog was
                 \em not modified!
      */
-    bool Merge(const POCatalogPtr& refcat);
+    bool Merge(const POCatalogPtr& refcat, MergeStats *stats = nullptr);
 
 protected:
     POCatalogDeletedDataArray m_deletedItems;
@@ -270,22 +452,233 @@ protected:
     int m_fileWrappingWidth;
     bool m_hasPluralItems = false;
 
+    /// Content of the file the catalog was loaded from (if it was loaded
+    /// from UTF-8 data), used by entries' POOriginalText.
+    ///
+    /// This is a single copy of the file kept for the catalog's lifetime, so
+    /// that unmodified entries can be written back verbatim and entries'
+    /// deferred details can be parsed from it. This costs the file's size in
+    /// memory, which is much less than fully parsed items would take. It is
+    /// released once no entry uses it anymore.
+    std::shared_ptr<const POFileData> m_originalData;
+
+    /// Key of the file in POCatalogCache if it should be stored there when
+    /// it's validated (see CreationFlag_UseCache)
+    std::unique_ptr<POCatalogCache::Key> m_cacheKey;
+    /// Validation results restored from POCatalogCache together with items'
+    /// issues, returned by the next Validate() instead of validating again
+    std::unique_ptr<POCatalogCache::Validation> m_cachedValidation;
+
     friend class POLoadParser;
+    friend class POCatalogCache;
     friend class Catalog;
 };
 
 
+/**
+    Saving of POCatalog in the background, see POCatalog::PrepareSave().
+
+    Run() writes the snapshot of catalog's items to disk, validates them and
+    compiles the MO file. Validation issues and line numbers in the saved file
+    are returned in the results, to be applied to the catalog on the main
+    thread with ApplyResults().
+ */
+class POCatalog::SaveJob
+{
+public:
+    struct Results
+    {
+        bool saved = false;
+        ValidationResults validation;
+        CompilationStatus moCompilationStatus = CompilationStatus::NotDone;
+
+        /// Validation issues of catalog's items, in the same order as items()
+        std::vector<std::shared_ptr<CatalogItem::Issue>> issues;
+
+        /// Line numbers of items and deleted items in the saved file
+        std::vector<int> lineNumbers, deletedLineNumbers;
+
+        /// Charset the file was saved in; differs from the catalog's if it
+        /// couldn't be encoded in it
+        wxString charset;
+    };
+
+    /**
+        Does the saving; can be called on any thread.
+
+        Must be called exactly once for every job returned by PrepareSave(),
+        the job is considered running from its creation until Run() returns.
+        Errors are logged and reported as unsaved file in the results.
+     */
+    Results Run();
+
+    /// Waits until Run(), executing on another thread, finishes.
+    /// Returns immediately if it already did.
+    void Wait();
+
+    /// Returns results of Run(); can only be called after Wait() returned.
+    const Results& GetResults() const { return m_results; }
+
+    /// Updates @a catalog to match the saved file and sets validation issues
+    /// from @a results on its items. Items that were edited, added or removed
+    /// since the snapshot was taken keep their issues, because the results
+    /// don't apply to them anymore.
+    void ApplyResults(POCatalog& catalog, const Results& results) const;
+
+private:
+    SaveJob() {}
+    Results DoRun();
+
+    wxString m_filename;
+    wxTextFileType m_crlf = wxTextFileType_Unix;
+    bool m_validate = false;
+    bool m_compileMO = false;
+
+    // copy of the catalog, with copies of its items, that is saved
+    POCatalogPtr m_snapshot;
+
+    // the catalog's items with their edit counts, to detect later changes
+    struct ItemState
+    {
+        CatalogItemPtr item;
+        unsigned editCount;
+    };
+    std::vector<ItemState> m_items;
+
+    std::mutex m_mutex;
+    std::condition_variable m_finished;
+    bool m_running = true;
+    Results m_results;
+
+    friend class POCatalog;
+};
+
+
+/// Internal class - source of lines for POCatalogParser.
+/// Mirrors the subset of wxTextBuffer's line iteration API the parser uses.
+class POLineSource
+{
+public:
+    virtual ~POLineSource() {}
+
+    /// Returns true if there are no lines at all.
+    virtual bool IsEmpty() const = 0;
+
+    /// Rewinds to the beginning and returns the first line.
+    virtual wxString GetFirstLine() = 0;
+
+    /// Returns the next line, must not be called if Eof() is true.
+    virtual wxString GetNextLine() = 0;
+
+    /// Returns true if the current line is the last one.
+    virtual bool Eof() const = 0;
+
+    /// Returns 0-based index of the most recently returned line.
+    virtual size_t GetCurrentLine() const = 0;
+
+    static const size_t npos = size_t(-1);
+
+    /// Returns byte offset of the most recently returned line in source data,
+    /// or npos if the source doesn't correspond to raw data.
+    virtual size_t GetCurrentLineOffset() const { return npos; }
+
+    /// Returns byte offset right after the most recently returned line,
+    /// including its line ending, or npos if not available.
+    virtual size_t GetCurrentLineEndOffset() const { return npos; }
+};
+
+
+/// Internal class - lines source backed by already loaded wxTextBuffer.
+class POTextBufferLineSource : public POLineSource
+{
+public:
+    explicit POTextBufferLineSource(wxTextBuffer *buf) : m_buffer(buf) {}
+
+    bool IsEmpty() const override { return m_buffer->GetLineCount() == 0; }
+    wxString GetFirstLine() override { return m_buffer->GetFirstLine(); }
+    wxString GetNextLine() override { return m_buffer->GetNextLine(); }
+    bool Eof() const override { return m_buffer->Eof(); }
+    size_t GetCurrentLine() const override { return m_buffer->GetCurrentLine(); }
+
+private:
+    wxTextBuffer *m_buffer;
+};
+
+
+/**
+    Internal class - lines source reading directly from UTF-8 encoded bytes,
+    typically a memory-mapped file.
+
+    Lines are decoded and validated lazily, as the parser asks for them,
+    so the data is only traversed once. Lines that aren't valid UTF-8 are
+    reported as errors and returned as empty, the same way wxTextFile
+    does when charset conversion fails.
+
+    The data must outlive the source object.
+ */
+class POUtf8LineSource : public POLineSource
+{
+public:
+    /**
+        Creates the source.
+
+        @param firstLine  Index of the first line in the file, if the data
+                          are only a part of it.
+        @param baseOffset Byte offset of @a begin in the file's data.
+     */
+    POUtf8LineSource(const char *begin, const char *end, const wxString& filename,
+                     size_t firstLine = 0, size_t baseOffset = 0);
+
+    bool IsEmpty() const override { return m_begin == m_end; }
+    wxString GetFirstLine() override;
+    wxString GetNextLine() override;
+    bool Eof() const override { return m_pos == m_end; }
+    size_t GetCurrentLine() const override { return m_firstLine + m_line; }
+    size_t GetCurrentLineOffset() const override { return m_baseOffset + (m_lineStart - m_begin); }
+    size_t GetCurrentLineEndOffset() const override { return m_baseOffset + (m_pos - m_begin); }
+
+    /// Returns true if any of the lines read so far were invalid.
+    bool HasErrors() const { return m_hasErrors; }
+
+    /// Returns line endings style of the lines read so far.
+    wxTextFileType GetCRLFFormat() const;
+
+    /// Returns true if the data use old Mac line endings (CR only), which
+    /// this class doesn't handle.
+    bool UsesMacLineEndings() const;
+
+    /// Adds line endings and errors statistics of another source, used
+    /// when the data were read in several parts.
+    void AddStatsFrom(const POUtf8LineSource& other);
+
+private:
+    wxString ReadLine();
+
+    const char *m_begin, *m_end;
+    const char *m_pos, *m_lineStart;
+    size_t m_firstLine, m_baseOffset;
+    size_t m_line;
+    size_t m_countLF, m_countCRLF;
+    bool m_hasErrors;
+    wxString m_filename;
+};
+
+
 /// Internal class - used for parsing of po files.
 class POCatalogParser
 {
 public:
-    POCatalogParser(wxTextFile *f)
-        : m_textFile(f),
+    POCatalogParser(POLineSource *source)
+        : m_source(source),
           m_detectedLineWidth(0),
           m_detectedWrappedLines(false),
           m_lastLineHardWrapped(true), m_previousLineHardWrapped(true),
           m_ignoreHeader(false),
-          m_ignoreTranslations(false)
+          m_ignoreTranslations(false),
+          m_deferEntryDetails(false),
+          m_lineOffset(POLineSource::npos), m_lineEndOffset(POLineSource::npos),
+          m_previousLineEndOffset(POLineSource::npos),
+          m_entryOffset(POLineSource::npos), m_entryEndOffset(POLineSource::npos)
     {}
 
     virtual ~POCatalogParser() {}
@@ -296,6 +689,16 @@ public:
     /// Tell the parser to treat input as POT and ignore translations
     void IgnoreTranslations(bool ignore) { m_ignoreTranslations = ignore; }
 
+    /**
+        Tell the parser to skip extracted comments, references and previous
+        msgid lines of entries, so that they can be parsed later from the
+        entry's text (see GetEntryOffsets()) when they are needed.
+
+        This makes loading of large files faster and reduces their memory
+        footprint. It must only be used with sources that provide offsets.
+     */
+    void DeferEntryDetails(bool defer) { m_deferEntryDetails = defer; }
+
     /** Parses the entire file, calls OnEntry each time
         new msgid/msgstr pair is found.
 
@@ -305,6 +708,14 @@ public:
 
     int GetWrappingWidth() const;
 
+    /// Merges line wrapping detected by another parser that parsed
+    /// a different part of the same file.
+    void AddWrappingInfo(const POCatalogParser& other)
+    {
+        m_detectedLineWidth = std::max(m_detectedLineWidth, other.m_detectedLineWidth);
+        m_detectedWrappedLines = m_detectedWrappedLines || other.m_detectedWrappedLines;
+    }
+
 protected:
     // Read one line from file, remove all \r and \n characters, ignore empty lines:
     wxString ReadTextLine();
@@ -348,8 +759,21 @@ protected:
 
     virtual void OnIgnoredEntry() {}
 
-    /// Textfile being parsed.
-    wxTextFile *m_textFile;
+    /** Returns byte range of the entry passed to OnEntry() or OnDeletedEntry()
+        in the source data, from the start of its first line to the end of
+        its last line. Returns false if the source can't provide it.
+     */
+    bool GetEntryOffsets(size_t& begin, size_t& end) const
+    {
+        if (m_entryOffset == POLineSource::npos || m_entryEndOffset == POLineSource::npos)
+            return false;
+        begin = m_entryOffset;
+        end = m_entryEndOffset;
+        return true;
+    }
+
+    /// Lines of the file being parsed.
+    POLineSource *m_source;
     int m_detectedLineWidth;
     bool m_detectedWrappedLines;
     bool m_lastLineHardWrapped, m_previousLineHardWrapped;
@@ -359,6 +783,15 @@ protected:
 
     /// Whether the translations should be ignored (as if it was a POT)
     bool m_ignoreTranslations;
+
+    /// Whether entries' details are parsed later, on demand
+    bool m_deferEntryDetails;
+
+private:
+    void UpdateLineOffsets();
+
+    size_t m_lineOffset, m_lineEndOffset, m_previousLineEndOffset;
+    size_t m_entryOffset, m_entryEndOffset;
 };
 
 #endif // Poedit_catalog_po_h
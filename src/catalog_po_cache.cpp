@@ -0,0 +1,533 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "catalog_po_cache.h"
+
+#include "catalog_po.h"
+#include "str_helpers.h"
+#include "utility.h"
+#include "version.h"
+
+#include <wx/dir.h>
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+
+namespace
+{
+
+// Identifies cache files; also catches files written on a machine with
+// different endianness, as all numbers are stored in native byte order.
+const uint32_t CACHE_MAGIC = 0x504F4331; // "POC1"
+
+// Increase whenever the format or content of cache files changes:
+const uint32_t CACHE_FORMAT_VERSION = 1;
+
+// Number of cache files kept around; the least recently written are removed.
+const size_t MAX_CACHED_FILES = 20;
+
+// Files smaller than this are parsed fast enough not to be worth caching:
+const size_t MIN_CACHED_FILE_SIZE = 256 * 1024;
+
+std::mutex gs_cacheMutex;
+wxString gs_cacheDir;
+
+
+// Bits of item's flags stored in the cache:
+enum ItemFlags
+{
+    Item_HasPlural          = 0x0001,
+    Item_HasContext         = 0x0002,
+    Item_Fuzzy              = 0x0004,
+    Item_Translated         = 0x0008,
+    Item_Modified           = 0x0010,
+    Item_PreTranslated      = 0x0020,
+    Item_HasDeferredData    = 0x0040,
+    Item_HasOriginalText    = 0x0080,
+    Item_HasIssue           = 0x0100,
+    Item_IssueIsError       = 0x0200
+};
+
+
+wxString GetCacheFileName(const wxString& dir, const wxString& path)
+{
+    const std::string utf8 = str::to_utf8(path);
+    return dir + wxFILE_SEP_PATH
+               + wxString::Format("%016llx.pocache", (unsigned long long)HashBytes(utf8.data(), utf8.size()));
+}
+
+
+/// Serialization of cache files' content.
+class CacheWriter
+{
+public:
+    explicit CacheWriter(std::string& output) : m_out(output) {}
+
+    template<typename T>
+    void Write(T value)
+    {
+        m_out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void Write(const wxString& s)
+    {
+        const wxScopedCharBuffer utf8 = s.utf8_str();
+        Write((uint32_t)utf8.length());
+        m_out.append(utf8.data(), utf8.length());
+    }
+
+    void Write(const wxArrayString& a)
+    {
+        Write((uint32_t)a.size());
+        for (auto& s: a)
+            Write(s);
+    }
+
+private:
+    std::string& m_out;
+};
+
+
+/// Deserialization of cache files' content, with bounds checking.
+class CacheReader
+{
+public:
+    CacheReader(const char *begin, const char *end) : m_pos(begin), m_end(end), m_ok(true) {}
+
+    bool IsOk() const { return m_ok; }
+
+    template<typename T>
+    T Read()
+    {
+        T value = T();
+        if (!Check(sizeof(T)))
+            return value;
+        memcpy(&value, m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    wxString ReadString()
+    {
+        const uint32_t len = Read<uint32_t>();
+        if (!Check(len))
+            return wxString();
+        wxString s = wxString::FromUTF8(m_pos, len);
+        m_pos += len;
+        return s;
+    }
+
+    void ReadArray(wxArrayString& a)
+    {
+        const uint32_t count = Read<uint32_t>();
+        // every string takes at least 4 bytes, don't allocate nonsense:
+        if (!Check((size_t)count * 4))
+            return;
+        a.reserve(count);
+        for (uint32_t i = 0; i < count && m_ok; i++)
+            a.push_back(ReadString());
+    }
+
+    bool AtEnd() const { return m_pos == m_end; }
+
+private:
+    bool Check(size_t len)
+    {
+        if (!m_ok || size_t(m_end - m_pos) < len)
+            m_ok = false;
+        return m_ok;
+    }
+
+    const char *m_pos, *m_end;
+    bool m_ok;
+};
+
+
+void WriteKey(CacheWriter& w, const POCatalogCache::Key& key)
+{
+    w.Write(CACHE_MAGIC);
+    w.Write(CACHE_FORMAT_VERSION);
+    // QA checks may differ between versions:
+    w.Write(wxString(POEDIT_VERSION));
+    w.Write(key.path);
+    w.Write(key.size);
+    w.Write(key.mtime);
+    w.Write(key.hash);
+}
+
+bool ReadAndCheckKey(CacheReader& r, const POCatalogCache::Key& key)
+{
+    if (r.Read<uint32_t>() != CACHE_MAGIC || r.Read<uint32_t>() != CACHE_FORMAT_VERSION)
+        return false;
+    if (r.ReadString() != POEDIT_VERSION)
+        return false;
+    if (r.ReadString() != key.path)
+        return false;
+    return r.Read<uint64_t>() == key.size &&
+           r.Read<int64_t>() == key.mtime &&
+           r.Read<uint64_t>() == key.hash &&
+           r.IsOk();
+}
+
+
+void RemoveOldCacheFiles(const wxString& dir)
+{
+    wxArrayString files;
+    wxDir::GetAllFiles(dir, &files, "*.pocache", wxDIR_FILES);
+    if (files.size() <= MAX_CACHED_FILES)
+        return;
+
+    std::vector<std::pair<time_t, wxString>> byAge;
+    for (auto& f: files)
+        byAge.emplace_back(wxFileModificationTime(f), f);
+    std::sort(byAge.begin(), byAge.end());
+
+    for (size_t i = 0; i < byAge.size() - MAX_CACHED_FILES; i++)
+        wxRemoveFile(byAge[i].second);
+}
+
+} // anonymous namespace
+
+
+POCatalogCache::Key POCatalogCache::Key::Compute(const wxString& path, const char *data, size_t size)
+{
+    Key key;
+    key.path = wxFileName(path).GetAbsolutePath();
+    key.size = size;
+    key.mtime = wxFileModificationTime(path);
+    key.hash = HashBytes(data, size);
+    return key;
+}
+
+
+void POCatalogCache::Enable(const wxString& dir)
+{
+    std::lock_guard<std::mutex> lock(gs_cacheMutex);
+    gs_cacheDir = dir;
+}
+
+
+bool POCatalogCache::IsEnabled()
+{
+    std::lock_guard<std::mutex> lock(gs_cacheMutex);
+    return !gs_cacheDir.empty();
+}
+
+
+bool POCatalogCache::Load(POCatalog& catalog, const Key& key,
+                          const std::shared_ptr<const POFileData>& originalData)
+{
+    wxString dir;
+    {
+        std::lock_guard<std::mutex> lock(gs_cacheMutex);
+        dir = gs_cacheDir;
+    }
+    if (dir.empty() || key.size < MIN_CACHED_FILE_SIZE)
+        return false;
+
+    const wxString filename = GetCacheFileName(dir, key.path);
+    if (!wxFileExists(filename))
+        return false;
+
+    MappedFile data;
+    {
+        wxLogNull nolog;
+        if (!data.Open(filename))
+            return false;
+    }
+
+    CacheReader r(data.begin(), data.end());
+    if (!ReadAndCheckKey(r, key))
+    {
+        wxLogTrace("poedit", "cached data for %s are stale", key.path);
+        return false;
+    }
+
+    // Everything is read into temporary variables first and only put into
+    // the catalog if all of the data are valid:
+    Validation validation;
+    validation.warningsChecked = r.Read<uint8_t>() != 0;
+    validation.results.errors = r.Read<int32_t>();
+    validation.results.warnings = r.Read<int32_t>();
+
+    const auto fileType = (Catalog::Type)r.Read<int32_t>();
+    const auto fileCRLF = (wxTextFileType)r.Read<int32_t>();
+    const int fileWrappingWidth = r.Read<int32_t>();
+    const bool hasPluralItems = r.Read<uint8_t>() != 0;
+    const Language sourceLanguage = Language::TryParse(str::to_utf8(r.ReadString()));
+    const bool sourceIsSymbolicID = r.Read<uint8_t>() != 0;
+    const wxString headerText = r.ReadString();
+    const wxString headerComment = r.ReadString();
+
+    auto originalText = [&](POOriginalText& text, uint64_t begin, uint64_t end)
+    {
+        if (!originalData || begin > end || end > originalData->size())
+            return false;
+        text = POOriginalText(originalData, (size_t)begin, (size_t)end);
+        return true;
+    };
+
+    const uint32_t itemsCount = r.Read<uint32_t>();
+    CatalogItemArray items;
+    items.reserve(std::min(itemsCount, (uint32_t)(data.Size() / 16)));
+    const POReferences *lastReferences = nullptr;
+    for (uint32_t i = 0; i < itemsCount && r.IsOk(); i++)
+    {
+        auto item = std::make_shared<POCatalogItem>();
+        const uint32_t flags = r.Read<uint32_t>();
+        item->m_id = r.Read<int32_t>();
+        item->m_lineNum = r.Read<int32_t>();
+        item->m_string = r.ReadString();
+        if (flags & Item_HasPlural)
+            item->m_plural = r.ReadString();
+        if (flags & Item_HasContext)
+            item->m_context = r.ReadString();
+        item->m_hasPlural = (flags & Item_HasPlural) != 0;
+        item->m_hasContext = (flags & Item_HasContext) != 0;
+        item->m_isFuzzy = (flags & Item_Fuzzy) != 0;
+        item->m_isTranslated = (flags & Item_Translated) != 0;
+        item->m_isModified = (flags & Item_Modified) != 0;
+        item->m_isPreTranslated = (flags & Item_PreTranslated) != 0;
+        r.ReadArray(item->m_translations);
+        item->m_moreFlags = r.ReadString();
+        item->m_comment = r.ReadString();
+        wxArrayString references;
+        r.ReadArray(references);
+        item->m_references.Assign(references, lastReferences);
+        lastReferences = &item->m_references;
+        r.ReadArray(item->m_extractedComments);
+        r.ReadArray(item->m_oldMsgid);
+
+        if (flags & Item_HasOriginalText)
+        {
+            const uint64_t begin = r.Read<uint64_t>();
+            const uint64_t end = r.Read<uint64_t>();
+            if (!originalText(item->m_originalText, begin, end))
+                return false;
+        }
+        else if (flags & Item_HasDeferredData)
+        {
+            return false; // deferred data can't be loaded without original text
+        }
+
+        if (flags & Item_HasDeferredData)
+            item->SetHasDeferredData();
+
+        if (flags & Item_HasIssue)
+        {
+            const wxString message = r.ReadString();
+            item->SetIssue((flags & Item_IssueIsError) ? CatalogItem::Issue::Error : CatalogItem::Issue::Warning, message);
+        }
+
+        items.push_back(item);
+    }
+
+    const uint32_t deletedCount = r.Read<uint32_t>();
+    POCatalogDeletedDataArray deletedItems;
+    for (uint32_t i = 0; i < deletedCount && r.IsOk(); i++)
+    {
+        POCatalogDeletedData d;
+        d.m_lineNum = r.Read<int32_t>();
+        r.ReadArray(d.m_deletedLines);
+        r.ReadArray(d.m_references);
+        r.ReadArray(d.m_extractedComments);
+        d.m_flags = r.ReadString();
+        d.m_comment = r.ReadString();
+        if (r.Read<uint8_t>())
+        {
+            const uint64_t begin = r.Read<uint64_t>();
+            const uint64_t end = r.Read<uint64_t>();
+            if (!originalText(d.m_originalText, begin, end))
+                return false;
+        }
+        deletedItems.push_back(d);
+    }
+
+    if (!r.IsOk() || !r.AtEnd())
+    {
+        wxLogTrace("poedit", "cached data for %s are corrupted", key.path);
+        return false;
+    }
+
+    catalog.m_fileType = fileType;
+    catalog.m_fileCRLF = fileCRLF;
+    catalog.m_fileWrappingWidth = fileWrappingWidth;
+    catalog.m_hasPluralItems = hasPluralItems;
+    catalog.m_sourceLanguage = sourceLanguage;
+    catalog.m_sourceIsSymbolicID = sourceIsSymbolicID;
+    catalog.m_header.FromString(headerText);
+    catalog.m_header.Comment = headerComment;
+    catalog.m_items.swap(items);
+    catalog.InvalidateItemsIndexes();
+    catalog.m_deletedItems.swap(deletedItems);
+    catalog.m_originalData = originalData;
+    catalog.m_cachedValidation.reset(new Validation(validation));
+
+    wxLogTrace("poedit", "loaded %s from cache", key.path);
+    return true;
+}
+
+
+void POCatalogCache::Store(const POCatalog& catalog, const Key& key, const Validation& validation)
+{
+    wxString dir;
+    {
+        std::lock_guard<std::mutex> lock(gs_cacheMutex);
+        dir = gs_cacheDir;
+    }
+    if (dir.empty() || key.size < MIN_CACHED_FILE_SIZE)
+        return;
+
+    std::string data;
+    data.reserve((size_t)key.size * 2);
+    CacheWriter w(data);
+
+    WriteKey(w, key);
+
+    w.Write((uint8_t)validation.warningsChecked);
+    w.Write((int32_t)validation.results.errors);
+    w.Write((int32_t)validation.results.warnings);
+
+    // Header is serialized from a copy, because ToString() updates it:
+    Catalog::HeaderData header(catalog.m_header);
+
+    w.Write((int32_t)catalog.m_fileType);
+    w.Write((int32_t)catalog.m_fileCRLF);
+    w.Write((int32_t)catalog.m_fileWrappingWidth);
+    w.Write((uint8_t)catalog.m_hasPluralItems);
+    w.Write(wxString(catalog.m_sourceLanguage.Code()));
+    w.Write((uint8_t)catalog.m_sourceIsSymbolicID);
+    w.Write(UnescapeCString(header.ToString()));
+    w.Write(header.Comment);
+
+    // Only original text referring to the file's data can be stored:
+    auto isOriginal = [&catalog](const POOriginalText& text)
+    {
+        return text.IsOk() && text.data == catalog.m_originalData;
+    };
+
+    w.Write((uint32_t)catalog.m_items.size());
+    for (auto& i: catalog.m_items)
+    {
+        auto item = std::static_pointer_cast<POCatalogItem>(i);
+        const bool deferred = item->HasDeferredData();
+        const bool hasOriginal = isOriginal(item->m_originalText);
+        if (deferred && !hasOriginal)
+            return; // can't happen, deferred data are loaded when the item is modified
+
+        auto& issue = item->GetIssue();
+
+        uint32_t flags = 0;
+        if (item->m_hasPlural)       flags |= Item_HasPlural;
+        if (item->m_hasContext)      flags |= Item_HasContext;
+        if (item->m_isFuzzy)         flags |= Item_Fuzzy;
+        if (item->m_isTranslated)    flags |= Item_Translated;
+        if (item->m_isModified)      flags |= Item_Modified;
+        if (item->m_isPreTranslated) flags |= Item_PreTranslated;
+        if (deferred)                flags |= Item_HasDeferredData;
+        if (hasOriginal)             flags |= Item_HasOriginalText;
+        if (issue)                   flags |= Item_HasIssue;
+        if (issue && issue->severity == CatalogItem::Issue::Error)
+                                     flags |= Item_IssueIsError;
+
+        w.Write(flags);
+        w.Write((int32_t)item->m_id);
+        w.Write((int32_t)item->m_lineNum);
+        w.Write(item->m_string);
+        if (item->m_hasPlural)
+            w.Write(item->m_plural);
+        if (item->m_hasContext)
+            w.Write(item->m_context);
+        w.Write(item->m_translations);
+        w.Write(item->m_moreFlags.str());
+        w.Write(item->m_comment);
+        // Deferred data aren't loaded yet, they will be parsed from the original
+        // text again after restoring the item. Note that reading them here would
+        // be racy, because they may be loaded concurrently.
+        w.Write(deferred ? wxArrayString() : item->m_references.ToArray());
+        w.Write(deferred ? wxArrayString() : item->m_extractedComments);
+        w.Write(deferred ? wxArrayString() : item->m_oldMsgid);
+        if (hasOriginal)
+        {
+            w.Write((uint64_t)item->m_originalText.begin);
+            w.Write((uint64_t)item->m_originalText.end);
+        }
+        if (issue)
+            w.Write(issue->message);
+    }
+
+    w.Write((uint32_t)catalog.m_deletedItems.size());
+    for (auto& d: catalog.m_deletedItems)
+    {
+        w.Write((int32_t)d.m_lineNum);
+        w.Write(d.m_deletedLines);
+        w.Write(d.m_references);
+        w.Write(d.m_extractedComments);
+        w.Write(d.m_flags);
+        w.Write(d.m_comment);
+        const bool hasOriginal = isOriginal(d.m_originalText);
+        w.Write((uint8_t)hasOriginal);
+        if (hasOriginal)
+        {
+            w.Write((uint64_t)d.m_originalText.begin);
+            w.Write((uint64_t)d.m_originalText.end);
+        }
+    }
+
+    // Failure to write the cache isn't an error worth reporting, the file
+    // will be just parsed again next time:
+    wxLogNull nolog;
+    if (!wxFileName::DirExists(dir) && !wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL))
+        return;
+
+    const wxString filename = GetCacheFileName(dir, key.path);
+    const wxString tempname = filename + ".tmp";
+    {
+        wxFile f;
+        if (!f.Create(tempname, /*overwrite=*/true))
+            return;
+        if (f.Write(data.data(), data.size()) != data.size() || !f.Close())
+        {
+            wxRemoveFile(tempname);
+            return;
+        }
+    }
+    if (!wxRenameFile(tempname, filename, /*overwrite=*/true))
+    {
+        wxRemoveFile(tempname);
+        return;
+    }
+
+    wxLogTrace("poedit", "stored %s in cache", key.path);
+    RemoveOldCacheFiles(dir);
+}
@@ -0,0 +1,106 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef Poedit_catalog_po_cache_h
+#define Poedit_catalog_po_cache_h
+
+#include "catalog.h"
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+class POCatalog;
+class POFileData;
+
+
+/**
+    On-disk cache of parsed PO catalogs.
+
+    Opening a large catalog in the editor is dominated by parsing it,
+    detecting languages used in it and validating it. The cache stores
+    catalog's state after all of that in a compact binary file that is read
+    back directly from memory-mapped data, so that reopening an unchanged
+    file only needs to recreate its items.
+
+    Entries are keyed on file's path, size, modification time and a hash of
+    its content. Stale or damaged cache files are silently ignored and the
+    file is parsed as usual.
+
+    The cache is disabled until Enable() is called.
+ */
+class POCatalogCache
+{
+public:
+    /// Identification of the cached file's content.
+    struct Key
+    {
+        wxString path;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+
+        /// Computes the key of @a path with content @a data.
+        static Key Compute(const wxString& path, const char *data, size_t size);
+    };
+
+    /// Validation results stored together with catalog's content.
+    struct Validation
+    {
+        Catalog::ValidationResults results;
+        bool warningsChecked = false;
+    };
+
+    /// Enables the cache, with cache files stored in @a dir.
+    static void Enable(const wxString& dir);
+
+    /// Is the cache enabled?
+    static bool IsEnabled();
+
+    /**
+        Restores @a catalog's content from the cache.
+
+        @param key          Key of the file being loaded.
+        @param originalData File's content, used by restored items' original text.
+
+        Items' issues are restored too and the validation results they came
+        from are stored in the catalog, to be used by its next Validate().
+
+        @return true on success; if false is returned, @a catalog wasn't modified.
+     */
+    static bool Load(POCatalog& catalog, const Key& key,
+                     const std::shared_ptr<const POFileData>& originalData);
+
+    /**
+        Stores @a catalog's content, including items' issues, in the cache.
+
+        Must be called right after validating the freshly loaded catalog,
+        before it is modified in any way.
+     */
+    static void Store(const POCatalog& catalog, const Key& key, const Validation& validation);
+};
+
+#endif // Poedit_catalog_po_cache_h
@@ -0,0 +1,540 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "catalog_po.h"
+
+#include "cat_operations.h"
+#include "catalog_merge.h"
+#include "concurrency.h"
+#include "configuration.h"
+#include "str_helpers.h"
+#include "utility.h"
+
+#include <wx/hashmap.h>
+
+#include <algorithm>
+#include <future>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+
+namespace
+{
+
+// Key identifying a message for exact matching, same as in MO files
+inline std::wstring MessageKey(const CatalogItem& item)
+{
+    std::wstring key;
+    if (item.HasContext())
+    {
+        key = item.GetContext().ToStdWstring();
+        key += L'\x04';
+    }
+    key += item.GetRawString().ToStdWstring();
+    return key;
+}
+
+
+inline wxString QuotedString(const wxString& s)
+{
+    return "\"" + EscapeCString(s) + "\"";
+}
+
+/// Formats "#|" lines with previous msgid of a fuzzy matched message, as msgmerge --previous does.
+wxArrayString FormatPreviousMsgid(const CatalogItem& item)
+{
+    wxArrayString lines;
+    if (item.HasContext())
+        lines.push_back("msgctxt " + QuotedString(item.GetContext()));
+    lines.push_back("msgid " + QuotedString(item.GetRawString()));
+    if (item.HasPlural())
+        lines.push_back("msgid_plural " + QuotedString(item.GetRawPluralString()));
+    return lines;
+}
+
+
+/// Content of an obsolete message parsed from its "#~" lines.
+struct ObsoleteMessage
+{
+    bool hasContext = false;
+    wxString context;
+    bool hasMsgid = false;
+    wxString msgid;
+    bool hasPlural = false;
+    wxString plural;
+    wxArrayString translations;
+    wxArrayString previous;
+};
+
+inline bool IsObsoleteMsgidLine(const wxString& line)
+{
+    return line.starts_with("#~ msgid ");
+}
+
+/**
+    Parses raw lines of obsolete message.
+
+    Returns false if the lines contain something unexpected, in which case
+    the message is kept as it is and not considered for merging.
+ */
+bool ParseObsoleteMessage(const wxArrayString& lines, ObsoleteMessage& msg)
+{
+    wxString *field = nullptr;
+
+    for (auto line: lines)
+    {
+        if (!line.starts_with("#~"))
+            return false;
+        line.Remove(0, 2);
+
+        if (line.starts_with("|"))
+        {
+            msg.previous.push_back(line.Mid(1).Trim(false));
+            continue;
+        }
+
+        line.Trim(false).Trim(true);
+
+        wxString value;
+        if (line.StartsWith("msgctxt ", &value))
+        {
+            msg.hasContext = true;
+            field = &msg.context;
+        }
+        else if (line.StartsWith("msgid_plural ", &value))
+        {
+            msg.hasPlural = true;
+            field = &msg.plural;
+        }
+        else if (line.StartsWith("msgid ", &value))
+        {
+            msg.hasMsgid = true;
+            field = &msg.msgid;
+        }
+        else if (line.StartsWith("msgstr ", &value))
+        {
+            if (!msg.translations.empty())
+                return false;
+            msg.translations.push_back(wxString());
+            field = &msg.translations.back();
+        }
+        else if (line.StartsWith("msgstr[", &value))
+        {
+            unsigned long index;
+            const size_t close = value.find("] ");
+            if (close == wxString::npos || !value.substr(0, close).ToULong(&index) || index != msg.translations.size())
+                return false;
+            msg.translations.push_back(wxString());
+            field = &msg.translations.back();
+            value.Remove(0, close + 2);
+        }
+        else if (line.starts_with("\""))
+        {
+            value = line;
+        }
+        else
+        {
+            return false;
+        }
+
+        value.Trim(false);
+        if (!field || value.length() < 2 || !value.starts_with("\"") || !value.ends_with("\""))
+            return false;
+        *field += UnescapeCString(value.substr(1, value.length() - 2));
+    }
+
+    return msg.hasMsgid && !msg.translations.empty() && (msg.hasPlural || msg.translations.size() == 1);
+}
+
+/// Formats "#~" lines of a message that became obsolete.
+wxArrayString FormatObsoleteMessage(const CatalogItem& item)
+{
+    wxArrayString lines;
+    for (auto& prev: item.GetOldMsgidRaw())
+        lines.push_back("#~| " + prev);
+    if (item.HasContext())
+        lines.push_back("#~ msgctxt " + QuotedString(item.GetContext()));
+    lines.push_back("#~ msgid " + QuotedString(item.GetRawString()));
+    if (item.HasPlural())
+    {
+        lines.push_back("#~ msgid_plural " + QuotedString(item.GetRawPluralString()));
+        unsigned index = 0;
+        for (auto& t: item.GetTranslations())
+            lines.push_back(wxString::Format("#~ msgstr[%u] ", index++) + QuotedString(t));
+    }
+    else
+    {
+        lines.push_back("#~ msgstr " + QuotedString(item.GetTranslation()));
+    }
+    return lines;
+}
+
+
+
+inline MergeStats::Key MakeStatsKey(const CatalogItemPtr& i)
+{
+    return {i->GetRawString(), i->GetRawPluralString(), i->GetContext(), i->GetRawSymbolicId()};
+}
+
+/// Compares items' MergeStats::Key without constructing it.
+inline bool StatsKeysEqual(const CatalogItem& a, const CatalogItem& b)
+{
+    return a.GetRawString() == b.GetRawString() &&
+           a.GetRawPluralString() == b.GetRawPluralString() &&
+           a.GetContext() == b.GetContext() &&
+           a.GetRawSymbolicId() == b.GetRawSymbolicId();
+}
+
+/// Runs @a func(begin, end) on ranges of [0, count) in parallel.
+template<typename TFunc>
+void ForRangesInParallel(size_t count, size_t minChunk, const TFunc& func)
+{
+    const unsigned workers = dispatch::default_parallelism();
+    const size_t chunk = std::max(count / workers + 1, minChunk);
+
+    dispatch::parallel_for((count + chunk - 1) / chunk, workers, [&](size_t c)
+    {
+        func(c * chunk, std::min((c + 1) * chunk, count));
+    });
+}
+
+
+/**
+    Set of items' MergeStats keys, used by ComputeMergeStats().
+
+    Keys are represented by the items themselves and their precomputed
+    hashes, stored in an open-addressing hash table, so that no strings
+    need to be copied to compare catalogs.
+ */
+class StatsKeysSet
+{
+public:
+    explicit StatsKeysSet(const CatalogItemArray& items) : m_items(items), m_hashes(items.size())
+    {
+        ForRangesInParallel(items.size(), 1000, [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+                m_hashes[i] = Hash(*m_items[i]);
+        });
+
+        size_t capacity = 16;
+        while (capacity < items.size() * 2)
+            capacity *= 2;
+        m_mask = capacity - 1;
+        m_slots.resize(capacity, EMPTY);
+
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            size_t slot = m_hashes[i] & m_mask;
+            for (;;)
+            {
+                const uint32_t existing = m_slots[slot];
+                if (existing == EMPTY)
+                {
+                    m_slots[slot] = (uint32_t)i;
+                    break;
+                }
+                if (m_hashes[existing] == m_hashes[i] && StatsKeysEqual(*m_items[existing], *m_items[i]))
+                    break;  // duplicate key
+                slot = (slot + 1) & m_mask;
+            }
+        }
+    }
+
+    /// Does the set contain key of @a item (with hash @a hash)?
+    bool Contains(const CatalogItem& item, size_t hash) const
+    {
+        size_t slot = hash & m_mask;
+        for (;;)
+        {
+            const uint32_t existing = m_slots[slot];
+            if (existing == EMPTY)
+                return false;
+            if (m_hashes[existing] == hash && StatsKeysEqual(*m_items[existing], item))
+                return true;
+            slot = (slot + 1) & m_mask;
+        }
+    }
+
+    /// Returns keys of items with keys not present in @a other, sorted.
+    std::vector<MergeStats::Key> Difference(const StatsKeysSet& other) const
+    {
+        // The table is split into shards probed in parallel:
+        std::mutex mutex;
+        std::vector<uint32_t> missing;
+        ForRangesInParallel(m_slots.size(), 4096, [&](size_t begin, size_t end)
+        {
+            std::vector<uint32_t> found;
+            for (size_t slot = begin; slot < end; slot++)
+            {
+                const uint32_t i = m_slots[slot];
+                if (i != EMPTY && !other.Contains(*m_items[i], m_hashes[i]))
+                    found.push_back(i);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            missing.insert(missing.end(), found.begin(), found.end());
+        });
+
+        // Only keys that are actually reported are constructed:
+        std::vector<MergeStats::Key> keys;
+        keys.reserve(missing.size());
+        for (auto i: missing)
+            keys.push_back(MakeStatsKey(m_items[i]));
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    }
+
+private:
+    static const uint32_t EMPTY = uint32_t(-1);
+
+    static size_t Hash(const CatalogItem& item)
+    {
+        wxStringHash hasher;
+        size_t h = hasher(item.GetRawString());
+        auto combine = [&h](size_t v){ h ^= v + size_t(0x9e3779b97f4a7c15ULL) + (h << 6) + (h >> 2); };
+        combine(hasher(item.GetRawPluralString()));
+        combine(hasher(item.GetContext()));
+        combine(hasher(item.GetRawSymbolicId()));
+        return h;
+    }
+
+    const CatalogItemArray& m_items;
+    std::vector<size_t> m_hashes;
+    std::vector<uint32_t> m_slots;
+    size_t m_mask;
+};
+
+} // anonymous namespace
+
+
+void ComputeMergeStats(MergeStats& r, const CatalogItemArray& items, const CatalogItemArray& refItems)
+{
+    // Both sides are hashed in parallel, then diffed against each other:
+    auto refKeysFuture = std::async(std::launch::async, [&refItems]{ return std::make_unique<StatsKeysSet>(refItems); });
+    StatsKeysSet keys(items);
+    auto refKeys = refKeysFuture.get();
+
+    r.removed = keys.Difference(*refKeys);
+    r.added = refKeys->Difference(keys);
+}
+
+
+bool POCatalog::Merge(const POCatalogPtr& refcat, MergeStats *stats)
+{
+    if (!refcat)
+        return false;
+
+    const CatalogItemArray& refs = refcat->m_items;
+
+    if (stats)
+        ComputeMergeStats(*stats, m_items, refs);
+
+    const unsigned nplurals = std::max(GetPluralForms().nplurals(), 1u);
+
+    // Messages that can provide translations: current ones first, so that
+    // they take precedence, followed by obsolete ones that can be revived.
+    // Poedit's parser may split a single obsolete message into several
+    // entries, so they are grouped back together.
+    CatalogItemArray defs(m_items);
+    std::vector<std::pair<size_t, size_t>> defsObsoleteRanges;
+    for (size_t i = 0; i < m_deletedItems.size(); )
+    {
+        const POCatalogDeletedData& deleted = m_deletedItems[i];
+        wxArrayString lines = deleted.GetDeletedLines();
+        size_t end = i + 1;
+        while (end < m_deletedItems.size() &&
+               std::none_of(lines.begin(), lines.end(), IsObsoleteMsgidLine))
+        {
+            for (auto& ln: m_deletedItems[end++].GetDeletedLines())
+                lines.push_back(ln);
+        }
+
+        ObsoleteMessage msg;
+        if (ParseObsoleteMessage(lines, msg))
+        {
+            auto d = std::make_shared<POCatalogItem>();
+            if (!deleted.GetFlags().empty())
+                d->SetFlags(deleted.GetFlags());
+            d->SetString(msg.msgid);
+            if (msg.hasPlural)
+                d->SetPluralString(msg.plural);
+            if (msg.hasContext)
+                d->SetContext(msg.context);
+            d->SetTranslations(msg.translations);
+            d->SetComment(deleted.GetComment());
+            d->SetOldMsgid(msg.previous);
+            defs.push_back(d);
+            defsObsoleteRanges.emplace_back(i, end);
+            i = end;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    // Find exact matches using a hash index, then fuzzy matches for the rest:
+    std::unordered_map<std::wstring, size_t> index;
+    index.reserve(defs.size());
+    for (size_t i = 0; i < defs.size(); i++)
+        index.emplace(MessageKey(*defs[i]), i);
+
+    std::vector<int> match(refs.size(), -1);
+    std::vector<bool> exact(refs.size(), false);
+    std::vector<size_t> unmatched;
+    for (size_t r = 0; r < refs.size(); r++)
+    {
+        auto found = index.find(MessageKey(*refs[r]));
+        if (found != index.end())
+        {
+            match[r] = int(found->second);
+            exact[r] = true;
+        }
+        else if (!refs[r]->GetRawString().empty())
+        {
+            unmatched.push_back(r);
+        }
+    }
+
+    if (!unmatched.empty() && Config::MergeBehavior() != Merge_None)
+        FindFuzzyMatches(defs, refs, unmatched, match);
+
+    // Build the merged list of messages in reference catalog's order:
+    CatalogItemArray merged;
+    merged.reserve(refs.size());
+    std::vector<bool> used(defs.size(), false);
+    bool hasPluralItems = false;
+
+    for (size_t r = 0; r < refs.size(); r++)
+    {
+        auto ref = std::static_pointer_cast<POCatalogItem>(refs[r]);
+        auto item = std::make_shared<POCatalogItem>();
+        item->SetId(int(merged.size() + 1));
+        item->SetString(ref->GetRawString());
+        if (ref->HasPlural())
+        {
+            item->SetPluralString(ref->GetRawPluralString());
+            hasPluralItems = true;
+        }
+        if (ref->HasContext())
+            item->SetContext(ref->GetContext());
+        item->SetRawReferences(ref->GetRawReferences());
+        for (auto& c: ref->GetExtractedComments())
+            item->AddExtractedComments(c);
+
+        bool fuzzy = false;
+        wxArrayString translations;
+
+        if (match[r] != -1)
+        {
+            auto& def = defs[match[r]];
+            used[match[r]] = true;
+
+            translations = def->GetTranslations();
+            if (ref->HasPlural() && !def->HasPlural())
+            {
+                const wxString t = def->GetTranslation();
+                translations.clear();
+                translations.Add(t, nplurals);
+            }
+            else if (!ref->HasPlural() && def->HasPlural())
+            {
+                const wxString t = def->GetTranslation();
+                translations.clear();
+                translations.Add(t);
+            }
+
+            const bool translated = !def->GetTranslation().empty();
+            if (!exact[r] || def->HasPlural() != ref->HasPlural() || def->GetRawPluralString() != ref->GetRawPluralString())
+            {
+                fuzzy = translated;
+                if (fuzzy)
+                    item->SetOldMsgid(def->IsFuzzy() && def->HasOldMsgid() ? def->GetOldMsgidRaw() : FormatPreviousMsgid(*def));
+            }
+            else if (def->IsFuzzy())
+            {
+                fuzzy = true;
+                item->SetOldMsgid(def->GetOldMsgidRaw());
+            }
+
+            item->SetComment(def->GetComment());
+        }
+        else
+        {
+            translations.Add(wxString(), ref->HasPlural() ? nplurals : 1);
+        }
+
+        item->SetFlags(fuzzy ? ", fuzzy" + ref->m_moreFlags.str() : ref->m_moreFlags.str());
+        item->SetTranslations(translations);
+        merged.push_back(item);
+    }
+
+    // Translated messages that are no longer used become obsolete ones, while
+    // obsolete messages that weren't revived are kept as they were:
+    POCatalogDeletedDataArray deleted;
+    for (size_t i = 0; i < m_items.size(); i++)
+    {
+        auto& item = m_items[i];
+        if (used[i] || item->GetTranslation().empty())
+            continue;
+        POCatalogDeletedData d(FormatObsoleteMessage(*item));
+        d.SetFlags(item->GetFlags());
+        d.SetComment(item->GetComment());
+        deleted.push_back(d);
+    }
+
+    std::vector<bool> revived(m_deletedItems.size(), false);
+    for (size_t i = 0; i < defsObsoleteRanges.size(); i++)
+    {
+        if (!used[m_items.size() + i])
+            continue;
+        for (size_t j = defsObsoleteRanges[i].first; j < defsObsoleteRanges[i].second; j++)
+            revived[j] = true;
+    }
+    for (size_t i = 0; i < m_deletedItems.size(); i++)
+    {
+        if (!revived[i])
+            deleted.push_back(m_deletedItems[i]);
+    }
+
+    m_items = std::move(merged);
+    m_deletedItems = std::move(deleted);
+    m_hasPluralItems = hasPluralItems;
+    InvalidateItemsIndexes();
+
+    // Header is kept, except for information about the reference, as msgmerge does:
+    auto& refHeader = refcat->Header();
+    if (!refHeader.CreationDate.empty())
+        m_header.CreationDate = refHeader.CreationDate;
+    const wxString bugsTo = refHeader.GetHeader("Report-Msgid-Bugs-To");
+    if (!bugsTo.empty())
+        m_header.SetHeader("Report-Msgid-Bugs-To", bugsTo);
+
+    PostCreation();
+
+    return true;
+}
@@ -0,0 +1,1185 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "catalog_po_validator.h"
+
+#include "language.h"
+
+#include <wx/intl.h>
+#include <wx/tokenzr.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <string>
+
+
+namespace
+{
+
+// ----------------------------------------------------------------------
+// Parsed format strings
+// ----------------------------------------------------------------------
+
+// Types of format strings' arguments. Arguments of different types are
+// incompatible, except for ArgAny which matches anything in non-strict checks.
+typedef int ArgType;
+
+const ArgType ArgAny        = 0;
+const ArgType ArgInt        = 1;
+const ArgType ArgUnsigned   = 2;
+const ArgType ArgFloat      = 3;
+const ArgType ArgChar       = 4;
+const ArgType ArgString     = 5;
+const ArgType ArgPointer    = 6;
+const ArgType ArgCountPtr   = 7;
+const ArgType ArgObject     = 8;
+
+// Size modifiers of C arguments, combined with the base type:
+const int SizeShift         = 4;
+const int SizeChar          = 1;
+const int SizeShort         = 2;
+const int SizeLong          = 3;
+const int SizeLongLong      = 4;
+const int SizeIntMax        = 5;
+const int SizeSizeT         = 6;
+const int SizePtrdiff       = 7;
+const int SizeFirstPRI      = 8;
+
+inline ArgType WithSize(ArgType type, int size) { return type | (size << SizeShift); }
+
+inline bool AreCompatible(ArgType a, ArgType b, bool strict)
+{
+    return a == b || (!strict && (a == ArgAny || b == ArgAny));
+}
+
+
+/// Argument referenced by a format string, either by number or by name
+struct ArgKey
+{
+    explicit ArgKey(unsigned n) : number(n) {}
+    explicit ArgKey(const std::wstring& n) : number(0), name(n) {}
+
+    unsigned number;
+    std::wstring name;
+
+    bool operator<(const ArgKey& other) const
+    {
+        if (number != other.number)
+            return number < other.number;
+        return name < other.name;
+    }
+
+    wxString Describe() const
+    {
+        if (name.empty())
+            return wxString::Format("%u", number);
+        else
+            return "'" + wxString(name) + "'";
+    }
+};
+
+
+/// Arguments used by a format string
+struct FormatSpec
+{
+    std::map<ArgKey, ArgType> args;
+    /// Arguments are referenced by name (mapping) rather than by position (tuple)
+    bool named = false;
+
+    bool AddArg(const ArgKey& key, ArgType type, wxString& reason)
+    {
+        auto r = args.emplace(key, type);
+        if (!r.second && r.first->second != type)
+        {
+            if (r.first->second == ArgAny)
+            {
+                r.first->second = type;
+            }
+            else if (type != ArgAny)
+            {
+                reason = wxString::Format(_("The string refers to argument %s in incompatible ways."), key.Describe());
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+
+// ----------------------------------------------------------------------
+// Format strings parsers
+// ----------------------------------------------------------------------
+
+typedef bool (*FormatParser)(const std::wstring& s, FormatSpec& spec, wxString& reason);
+
+inline bool IsOneOf(wchar_t c, const wchar_t *chars)
+{
+    for (; *chars; chars++)
+    {
+        if (c == *chars)
+            return true;
+    }
+    return false;
+}
+
+inline bool IsDigit(wchar_t c) { return c >= '0' && c <= '9'; }
+
+inline bool IsIdentStart(wchar_t c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+inline bool IsIdentChar(wchar_t c) { return IsIdentStart(c) || IsDigit(c); }
+
+inline wxString EndsInDirective()
+{
+    return _("The string ends in the middle of a directive.");
+}
+
+inline wxString InvalidConversion(unsigned directive, wchar_t c)
+{
+    return wxString::Format(_("In the directive number %u, the character '%s' is not a valid conversion specifier."),
+                            directive, wxString(c));
+}
+
+// Parses "N$" argument number, if present; leaves i unchanged otherwise.
+bool ParseArgNumber(const std::wstring& s, size_t& i, unsigned directive, unsigned& number, wxString& reason)
+{
+    size_t j = i;
+    unsigned n = 0;
+    while (j < s.length() && IsDigit(s[j]))
+        n = 10 * n + (s[j++] - '0');
+
+    if (j == i || j >= s.length() || s[j] != '$')
+        return true;
+
+    if (n == 0)
+    {
+        reason = wxString::Format(_("In the directive number %u, the argument number 0 is not a positive integer."), directive);
+        return false;
+    }
+
+    number = n;
+    i = j + 1;
+    return true;
+}
+
+inline void SkipDigits(const std::wstring& s, size_t& i)
+{
+    while (i < s.length() && IsDigit(s[i]))
+        i++;
+}
+
+
+// C and Objective-C printf-style format strings
+bool ParseCFormatImpl(const std::wstring& s, bool objc, FormatSpec& spec, wxString& reason)
+{
+    static const wchar_t *PRI_SIZES[] =
+    {
+        L"8", L"16", L"32", L"64",
+        L"LEAST8", L"LEAST16", L"LEAST32", L"LEAST64",
+        L"FAST8", L"FAST16", L"FAST32", L"FAST64",
+        L"MAX", L"PTR"
+    };
+
+    const size_t len = s.length();
+    unsigned directives = 0;
+    unsigned unnumbered = 0;
+    bool usesNumbered = false;
+
+    auto addArg = [&](unsigned number, ArgType type)
+    {
+        if (number)
+            usesNumbered = true;
+        else
+            number = ++unnumbered;
+        return spec.AddArg(ArgKey(number), type, reason);
+    };
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] != '%')
+            continue;
+
+        directives++;
+        if (++i >= len)
+        {
+            reason = EndsInDirective();
+            return false;
+        }
+        if (s[i] == '%')
+            continue;
+
+        unsigned number = 0;
+        if (!ParseArgNumber(s, i, directives, number, reason))
+            return false;
+
+        // flags:
+        while (i < len && IsOneOf(s[i], L"-+ #0'I"))
+            i++;
+
+        // width and precision:
+        for (int part = 0; part < 2; part++)
+        {
+            if (part == 1)
+            {
+                if (i >= len || s[i] != '.')
+                    break;
+                i++;
+            }
+
+            if (i < len && s[i] == '*')
+            {
+                i++;
+                unsigned widthNumber = 0;
+                if (!ParseArgNumber(s, i, directives, widthNumber, reason))
+                    return false;
+                if (!addArg(widthNumber, ArgInt))
+                    return false;
+            }
+            else
+            {
+                SkipDigits(s, i);
+            }
+        }
+
+        if (i >= len)
+        {
+            reason = EndsInDirective();
+            return false;
+        }
+
+        ArgType type;
+        if (s[i] == '<')
+        {
+            // system-dependent integer format, e.g. <PRId64>
+            auto end = s.find('>', i);
+            if (end == std::wstring::npos)
+            {
+                reason = EndsInDirective();
+                return false;
+            }
+
+            const std::wstring macro = s.substr(i + 1, end - i - 1);
+            int size = 0;
+            if (macro.length() > 4 && macro.compare(0, 3, L"PRI") == 0 && IsOneOf(macro[3], L"diouxX"))
+            {
+                for (size_t k = 0; k < sizeof(PRI_SIZES) / sizeof(PRI_SIZES[0]); k++)
+                {
+                    if (macro.compare(4, std::wstring::npos, PRI_SIZES[k]) == 0)
+                        size = SizeFirstPRI + (int)k;
+                }
+            }
+            if (!size)
+            {
+                reason = wxString::Format(_("In the directive number %u, the token after '<' is not the name of a format specifier macro."), directives);
+                return false;
+            }
+
+            type = WithSize(IsOneOf(macro[3], L"di") ? ArgInt : ArgUnsigned, size);
+            i = end;
+        }
+        else
+        {
+            int size = 0;
+            for (; i < len; i++)
+            {
+                const wchar_t c = s[i];
+                if (c == 'h')
+                    size = (size == SizeShort) ? SizeChar : SizeShort;
+                else if (c == 'l')
+                    size = (size == SizeLong) ? SizeLongLong : SizeLong;
+                else if (c == 'L' || c == 'q')
+                    size = SizeLongLong;
+                else if (c == 'j')
+                    size = SizeIntMax;
+                else if (c == 'z' || c == 'Z')
+                    size = SizeSizeT;
+                else if (c == 't')
+                    size = SizePtrdiff;
+                else
+                    break;
+            }
+
+            if (i >= len)
+            {
+                reason = EndsInDirective();
+                return false;
+            }
+
+            switch (s[i])
+            {
+                case 'd': case 'i':
+                    type = WithSize(ArgInt, size);
+                    break;
+                case 'o': case 'u': case 'x': case 'X':
+                    type = WithSize(ArgUnsigned, size);
+                    break;
+                case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                    type = WithSize(ArgFloat, size == SizeLongLong ? SizeLongLong : 0);
+                    break;
+                case 'c':
+                    type = WithSize(ArgChar, size == SizeLong ? SizeLong : 0);
+                    break;
+                case 'C':
+                    type = WithSize(ArgChar, SizeLong);
+                    break;
+                case 's':
+                    type = WithSize(ArgString, size == SizeLong ? SizeLong : 0);
+                    break;
+                case 'S':
+                    type = WithSize(ArgString, SizeLong);
+                    break;
+                case 'p':
+                    type = ArgPointer;
+                    break;
+                case 'n':
+                    type = WithSize(ArgCountPtr, size);
+                    break;
+                case 'm':
+                    // glibc's strerror(errno), doesn't consume any argument
+                    continue;
+                case '@':
+                    if (objc)
+                    {
+                        type = ArgObject;
+                        break;
+                    }
+                    // fall through
+                default:
+                    reason = InvalidConversion(directives, s[i]);
+                    return false;
+            }
+        }
+
+        if (!addArg(number, type))
+            return false;
+    }
+
+    if (usesNumbered && unnumbered)
+    {
+        reason = _("The string refers to arguments both through absolute argument numbers and through unnumbered argument specifications.");
+        return false;
+    }
+
+    // numbered arguments must not have gaps:
+    unsigned expected = 1;
+    for (auto& a: spec.args)
+    {
+        if (a.first.number != expected)
+        {
+            reason = wxString::Format(_("The string refers to argument number %u but ignores argument number %u."),
+                                      a.first.number, expected);
+            return false;
+        }
+        expected++;
+    }
+
+    return true;
+}
+
+bool ParseCFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    return ParseCFormatImpl(s, /*objc=*/false, spec, reason);
+}
+
+bool ParseObjCFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    return ParseCFormatImpl(s, /*objc=*/true, spec, reason);
+}
+
+
+// Python's %-style format strings, either with positional or named arguments
+bool ParsePythonFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    unsigned directives = 0;
+    unsigned unnamed = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] != '%')
+            continue;
+
+        directives++;
+        if (++i >= len)
+        {
+            reason = EndsInDirective();
+            return false;
+        }
+        if (s[i] == '%')
+            continue;
+
+        std::wstring name;
+        bool hasName = false;
+        if (s[i] == '(')
+        {
+            size_t depth = 1;
+            size_t start = ++i;
+            for (; i < len; i++)
+            {
+                if (s[i] == '(')
+                    depth++;
+                else if (s[i] == ')' && --depth == 0)
+                    break;
+            }
+            if (i >= len)
+            {
+                reason = EndsInDirective();
+                return false;
+            }
+            name = s.substr(start, i - start);
+            hasName = true;
+            i++;
+        }
+
+        while (i < len && IsOneOf(s[i], L"-+ #0"))
+            i++;
+
+        for (int part = 0; part < 2; part++)
+        {
+            if (part == 1)
+            {
+                if (i >= len || s[i] != '.')
+                    break;
+                i++;
+            }
+
+            if (i < len && s[i] == '*')
+            {
+                if (hasName)
+                {
+                    reason = wxString::Format(_("In the directive number %u, the width or precision is given by an argument, which is not possible with named arguments."), directives);
+                    return false;
+                }
+                i++;
+                if (!spec.AddArg(ArgKey(++unnamed), ArgInt, reason))
+                    return false;
+            }
+            else
+            {
+                SkipDigits(s, i);
+            }
+        }
+
+        while (i < len && IsOneOf(s[i], L"hlL"))
+            i++;
+
+        if (i >= len)
+        {
+            reason = EndsInDirective();
+            return false;
+        }
+
+        ArgType type;
+        switch (s[i])
+        {
+            case 'c':
+                type = ArgChar;
+                break;
+            case 's': case 'r': case 'a':
+                type = ArgAny;
+                break;
+            case 'i': case 'd': case 'u': case 'o': case 'x': case 'X':
+                type = ArgInt;
+                break;
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+                type = ArgFloat;
+                break;
+            default:
+                reason = InvalidConversion(directives, s[i]);
+                return false;
+        }
+
+        if (hasName)
+        {
+            spec.named = true;
+            if (!spec.AddArg(ArgKey(name), type, reason))
+                return false;
+        }
+        else
+        {
+            if (!spec.AddArg(ArgKey(++unnamed), type, reason))
+                return false;
+        }
+    }
+
+    if (spec.named && unnamed)
+    {
+        reason = _("The string refers to arguments both through argument names and through unnamed argument specifications.");
+        return false;
+    }
+
+    return true;
+}
+
+
+// Python's str.format() strings
+bool ParsePythonBraceField(const std::wstring& s, size_t& i, bool toplevel, unsigned& directives,
+                           int& autoNumber, bool& explicitNumbers, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    directives++;
+    i++; // skip '{'
+
+    std::wstring name;
+    if (i < len && IsDigit(s[i]))
+    {
+        const size_t start = i;
+        SkipDigits(s, i);
+        name = s.substr(start, i - start);
+        explicitNumbers = true;
+    }
+    else if (i < len && IsIdentStart(s[i]))
+    {
+        const size_t start = i;
+        while (i < len && IsIdentChar(s[i]))
+            i++;
+        name = s.substr(start, i - start);
+    }
+    else
+    {
+        name = std::to_wstring(autoNumber++);
+    }
+
+    if (autoNumber > 0 && explicitNumbers)
+    {
+        reason = _("The string mixes automatic and manual field numbering.");
+        return false;
+    }
+
+    // attributes and indexes:
+    while (i < len)
+    {
+        if (s[i] == '.')
+        {
+            const size_t start = ++i;
+            while (i < len && IsIdentChar(s[i]))
+                i++;
+            if (i == start)
+            {
+                reason = wxString::Format(_("In the directive number %u, there is an unterminated attribute or index."), directives);
+                return false;
+            }
+        }
+        else if (s[i] == '[')
+        {
+            const size_t start = ++i;
+            while (i < len && s[i] != ']')
+                i++;
+            if (i >= len || i == start)
+            {
+                reason = wxString::Format(_("In the directive number %u, there is an unterminated attribute or index."), directives);
+                return false;
+            }
+            i++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    // conversion:
+    if (i < len && s[i] == '!')
+    {
+        i++;
+        if (i >= len || !IsOneOf(s[i], L"rsa"))
+        {
+            reason = wxString::Format(_("In the directive number %u, the conversion is invalid."), directives);
+            return false;
+        }
+        i++;
+    }
+
+    // format spec, which may contain nested fields:
+    if (i < len && s[i] == ':')
+    {
+        i++;
+        while (i < len && s[i] != '}')
+        {
+            if (s[i] == '{')
+            {
+                if (!toplevel)
+                {
+                    reason = wxString::Format(_("In the directive number %u, fields are nested too deeply."), directives);
+                    return false;
+                }
+                if (!ParsePythonBraceField(s, i, false, directives, autoNumber, explicitNumbers, spec, reason))
+                    return false;
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    if (i >= len || s[i] != '}')
+    {
+        reason = EndsInDirective();
+        return false;
+    }
+    i++; // skip '}'
+
+    return spec.AddArg(ArgKey(name), ArgAny, reason);
+}
+
+bool ParsePythonBraceFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    unsigned directives = 0;
+    int autoNumber = 0;
+    bool explicitNumbers = false;
+
+    spec.named = true;
+
+    for (size_t i = 0; i < len; )
+    {
+        if (s[i] == '{')
+        {
+            if (i + 1 < len && s[i + 1] == '{')
+            {
+                i += 2;
+                continue;
+            }
+            if (!ParsePythonBraceField(s, i, true, directives, autoNumber, explicitNumbers, spec, reason))
+                return false;
+        }
+        else if (s[i] == '}')
+        {
+            if (i + 1 < len && s[i + 1] == '}')
+            {
+                i += 2;
+                continue;
+            }
+            reason = wxString::Format(_("The string contains a lone '}' after directive number %u."), directives);
+            return false;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    return true;
+}
+
+
+// PHP's sprintf() format strings
+bool ParsePHPFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    unsigned directives = 0;
+    unsigned unnumbered = 0;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] != '%')
+            continue;
+
+        directives++;
+        if (++i >= len)
+        {
+            reason = EndsInDirective();
+            return false;
+        }
+        if (s[i] == '%')
+            continue;
+
+        unsigned number = 0;
+        if (!ParseArgNumber(s, i, directives, number, reason))
+            return false;
+
+        // flags, including custom padding character:
+        while (i < len)
+        {
+            if (IsOneOf(s[i], L"-+ 0"))
+                i++;
+            else if (s[i] == '\'' && i + 1 < len)
+                i += 2;
+            else
+                break;
+        }
+
+        SkipDigits(s, i);
+        if (i < len && s[i] == '.')
+        {
+            i++;
+            SkipDigits(s, i);
+        }
+
+        if (i >= len)
+        {
+            reason = EndsInDirective();
+            return false;
+        }
+
+        ArgType type;
+        switch (s[i])
+        {
+            case 'b': case 'c': case 'd': case 'o': case 'u': case 'x': case 'X':
+                type = ArgInt;
+                break;
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'h': case 'H':
+                type = ArgFloat;
+                break;
+            case 's':
+                type = ArgString;
+                break;
+            default:
+                reason = InvalidConversion(directives, s[i]);
+                return false;
+        }
+
+        if (!number)
+            number = ++unnumbered;
+        if (!spec.AddArg(ArgKey(number), type, reason))
+            return false;
+    }
+
+    return true;
+}
+
+
+// Qt's QString::arg() strings: %1 to %99, optionally localized as %L1
+bool ParseQtFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] != '%')
+            continue;
+
+        size_t j = i + 1;
+        if (j < len && s[j] == 'L')
+            j++;
+        if (j >= len || !IsDigit(s[j]))
+            continue;
+
+        unsigned number = s[j] - '0';
+        if (j + 1 < len && IsDigit(s[j + 1]))
+            number = 10 * number + (s[++j] - '0');
+
+        if (!spec.AddArg(ArgKey(number), ArgAny, reason))
+            return false;
+        i = j;
+    }
+
+    return true;
+}
+
+
+// Qt's plural forms strings with %n or %Ln
+bool ParseQtPluralFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    for (size_t i = 0; i + 1 < len; i++)
+    {
+        if (s[i] != '%')
+            continue;
+
+        size_t j = i + 1;
+        if (s[j] == 'L' && j + 1 < len)
+            j++;
+        if (s[j] == 'n')
+        {
+            spec.named = true;
+            if (!spec.AddArg(ArgKey(L"n"), ArgAny, reason))
+                return false;
+            i = j;
+        }
+    }
+
+    return true;
+}
+
+
+// KDE's i18n() strings: %1, %2, ...
+bool ParseKDEFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    for (size_t i = 0; i + 1 < len; i++)
+    {
+        if (s[i] != '%' || s[i + 1] < '1' || s[i + 1] > '9')
+            continue;
+
+        unsigned number = 0;
+        size_t j = i + 1;
+        while (j < len && IsDigit(s[j]))
+            number = 10 * number + (s[j++] - '0');
+
+        if (!spec.AddArg(ArgKey(number), ArgAny, reason))
+            return false;
+        i = j - 1;
+    }
+
+    return true;
+}
+
+
+// Perl's brace format strings: {name}
+bool ParsePerlBraceFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    spec.named = true;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] != '{' || i + 1 >= len || !IsIdentStart(s[i + 1]))
+            continue;
+
+        size_t j = i + 1;
+        while (j < len && IsIdentChar(s[j]))
+            j++;
+        if (j < len && s[j] == '}')
+        {
+            if (!spec.AddArg(ArgKey(s.substr(i + 1, j - i - 1)), ArgAny, reason))
+                return false;
+            i = j;
+        }
+    }
+
+    return true;
+}
+
+
+// Shell format strings: $VARIABLE or ${VARIABLE}
+bool ParseShellFormat(const std::wstring& s, FormatSpec& spec, wxString& reason)
+{
+    const size_t len = s.length();
+    spec.named = true;
+
+    for (size_t i = 0; i + 1 < len; i++)
+    {
+        if (s[i] != '$')
+            continue;
+
+        const bool braced = s[i + 1] == '{';
+        size_t start = braced ? i + 2 : i + 1;
+        size_t j = start;
+        if (j >= len || !IsIdentStart(s[j]))
+            continue;
+        while (j < len && IsIdentChar(s[j]))
+            j++;
+
+        const std::wstring name = s.substr(start, j - start);
+        if (braced)
+        {
+            if (j >= len || s[j] != '}')
+            {
+                reason = _("The string contains '${' without matching '}'.");
+                return false;
+            }
+            j++;
+        }
+
+        if (!spec.AddArg(ArgKey(name), ArgAny, reason))
+            return false;
+        i = j - 1;
+    }
+
+    return true;
+}
+
+
+struct FormatLanguage
+{
+    /// Name as used in the "xxx-format" flag
+    const char *name;
+    /// Human-readable name of the language
+    const char *displayName;
+    FormatParser parse;
+    /// Positional arguments must always match exactly
+    bool exactPositional;
+};
+
+const FormatLanguage FormatLanguages[] =
+{
+    { "c",              "C",                ParseCFormat,           false },
+    { "objc",           "Objective C",      ParseObjCFormat,        false },
+    { "python",         "Python",           ParsePythonFormat,      true },
+    { "python-brace",   "Python brace",     ParsePythonBraceFormat, false },
+    { "php",            "PHP",              ParsePHPFormat,         false },
+    { "qt",             "Qt",               ParseQtFormat,          false },
+    { "qt-plural",      "Qt plural",        ParseQtPluralFormat,    false },
+    { "kde",            "KDE",              ParseKDEFormat,         false },
+    { "perl-brace",     "Perl brace",       ParsePerlBraceFormat,   false },
+    { "sh",             "Shell",            ParseShellFormat,       false },
+};
+
+
+/// Compares arguments of the source and translation format strings
+wxString CompareFormatSpecs(const FormatLanguage& lang,
+                            const FormatSpec& source, const FormatSpec& translation, bool strict,
+                            const wxString& sourceName, const wxString& translationName)
+{
+    if (!source.args.empty() && !translation.args.empty() && source.named != translation.named)
+    {
+        if (source.named)
+            return wxString::Format(_("Format specifications in '%s' expect a mapping, those in '%s' expect a tuple."), sourceName, translationName);
+        else
+            return wxString::Format(_("Format specifications in '%s' expect a tuple, those in '%s' expect a mapping."), sourceName, translationName);
+    }
+
+    for (auto& a: translation.args)
+    {
+        auto s = source.args.find(a.first);
+        if (s == source.args.end())
+        {
+            return wxString::Format(_("A format specification for argument %s, as in '%s', doesn't exist in '%s'."),
+                                    a.first.Describe(), translationName, sourceName);
+        }
+        if (!AreCompatible(s->second, a.second, strict))
+        {
+            return wxString::Format(_("Format specifications in '%s' and '%s' for argument %s are not the same."),
+                                    sourceName, translationName, a.first.Describe());
+        }
+    }
+
+    if (strict || (lang.exactPositional && !source.named))
+    {
+        for (auto& a: source.args)
+        {
+            if (translation.args.find(a.first) == translation.args.end())
+            {
+                return wxString::Format(_("A format specification for argument %s doesn't exist in '%s'."),
+                                        a.first.Describe(), translationName);
+            }
+        }
+    }
+
+    return wxString();
+}
+
+
+inline wxString TranslationFieldName(const CatalogItem& item, size_t index)
+{
+    if (item.HasPlural())
+        return wxString::Format("msgstr[%u]", (unsigned)index);
+    else
+        return "msgstr";
+}
+
+} // anonymous namespace
+
+
+POValidator::POValidator(const PluralFormsExpr& pluralForms, bool hasPluralForms, unsigned pluralsCount)
+    : m_hasPluralForms(hasPluralForms),
+      m_nplurals(pluralForms.nplurals()),
+      m_pluralsCount(pluralsCount)
+{
+    if (!m_hasPluralForms)
+        return;
+
+    if (!pluralForms)
+    {
+        m_pluralFormsError = _("The Plural-Forms header contains an invalid expression.");
+        return;
+    }
+
+    // Evaluate the expression for the same range of numbers as msgfmt does
+    // and find which plural forms are used frequently:
+    std::vector<unsigned> histogram(m_nplurals, 0);
+    unsigned maxForm = 0;
+    for (int n = 0; n <= 1000; n++)
+    {
+        const unsigned form = pluralForms.evaluate_for_n(n);
+        maxForm = std::max(maxForm, form);
+        if (form < m_nplurals)
+            histogram[form]++;
+    }
+
+    if (maxForm >= m_nplurals)
+    {
+        m_pluralFormsError = wxString::Format(_("The Plural-Forms header says nplurals=%u, but the plural expression can produce values as large as %u."),
+                                              m_nplurals, maxForm);
+        return;
+    }
+
+    m_oftenUsedForms.resize(m_nplurals);
+    for (unsigned i = 0; i < m_nplurals; i++)
+        m_oftenUsedForms[i] = histogram[i] > 5;
+}
+
+
+wxString POValidator::CheckItem(const CatalogItem& item) const
+{
+    // msgfmt ignores these entries entirely, so they can't cause errors:
+    if (item.IsFuzzy() || item.GetTranslation().empty() || item.GetRawString().empty())
+        return wxString();
+
+    std::vector<std::wstring> translations;
+    if (item.HasPlural())
+    {
+        for (unsigned i = 0; i < std::max(m_pluralsCount, 1u); i++)
+            translations.push_back(item.GetTranslation(i).ToStdWstring());
+    }
+    else
+    {
+        translations.push_back(item.GetTranslation().ToStdWstring());
+    }
+
+    wxString err;
+    if (item.HasPlural())
+        err = CheckPluralForms(translations);
+    if (err.empty())
+        err = CheckNewlines(item, translations);
+    if (err.empty())
+        err = CheckFormat(item, translations);
+    return err;
+}
+
+
+bool POValidator::HasUnsupportedFormat(const CatalogItem& item) const
+{
+    if (item.IsFuzzy() || item.GetTranslation().empty() || item.GetRawString().empty())
+        return false;
+
+    const wxString flags = item.GetFlags();
+    if (!flags.Contains("-format"))
+        return false;
+
+    wxStringTokenizer tok(flags, ",");
+    while (tok.HasMoreTokens())
+    {
+        wxString flag = tok.GetNextToken().Strip(wxString::both);
+        if (!flag.EndsWith("-format", &flag) || flag.starts_with("no-"))
+            continue;
+        flag.StartsWith("possible-", &flag);
+
+        auto known = std::find_if(std::begin(FormatLanguages), std::end(FormatLanguages),
+                                  [&flag](const FormatLanguage& lang){ return flag == lang.name; });
+        if (known == std::end(FormatLanguages))
+            return true;
+    }
+
+    return false;
+}
+
+
+wxString POValidator::CheckPluralForms(const std::vector<std::wstring>& translations) const
+{
+    if (!m_hasPluralForms)
+        return _(L"This file has entries with plural forms, but doesn’t have Plural-Forms header configured.");
+
+    if (!m_pluralFormsError.empty())
+        return m_pluralFormsError;
+
+    if (translations.size() != m_nplurals)
+        return _(L"Entries in this file have different plural forms count from what the file’s Plural-Forms header says");
+
+    return wxString();
+}
+
+
+wxString POValidator::CheckNewlines(const CatalogItem& item, const std::vector<std::wstring>& translations) const
+{
+    const wxString& msgid = item.GetRawString();
+    const wxString& msgidPlural = item.GetRawPluralString();
+
+    const bool begins = msgid.starts_with("\n");
+    const bool ends = msgid.ends_with("\n");
+
+    if (item.HasPlural())
+    {
+        if (msgidPlural.starts_with("\n") != begins)
+            return _("'msgid' and 'msgid_plural' entries do not both begin with '\\n'.");
+        if (msgidPlural.ends_with("\n") != ends)
+            return _("'msgid' and 'msgid_plural' entries do not both end with '\\n'.");
+    }
+
+    for (size_t i = 0; i < translations.size(); i++)
+    {
+        const auto& t = translations[i];
+        if ((!t.empty() && t.front() == '\n') != begins)
+            return wxString::Format(_("'msgid' and '%s' entries do not both begin with '\\n'."), TranslationFieldName(item, i));
+        if ((!t.empty() && t.back() == '\n') != ends)
+            return wxString::Format(_("'msgid' and '%s' entries do not both end with '\\n'."), TranslationFieldName(item, i));
+    }
+
+    return wxString();
+}
+
+
+wxString POValidator::CheckFormat(const CatalogItem& item, const std::vector<std::wstring>& translations) const
+{
+    const wxString flags = item.GetFlags();
+    if (!flags.Contains("-format"))
+        return wxString();
+
+    const std::wstring source = (item.HasPlural() ? item.GetRawPluralString() : item.GetRawString()).ToStdWstring();
+    const wxString sourceName = item.HasPlural() ? "msgid_plural" : "msgid";
+
+    wxStringTokenizer tok(flags, ",");
+    while (tok.HasMoreTokens())
+    {
+        wxString flag = tok.GetNextToken().Strip(wxString::both);
+        if (!flag.EndsWith("-format", &flag) || flag.starts_with("no-"))
+            continue;
+        flag.StartsWith("possible-", &flag);
+
+        for (auto& lang: FormatLanguages)
+        {
+            if (flag != lang.name)
+                continue;
+
+            // Source string is assumed to be correct, it's not translator's
+            // responsibility if it isn't:
+            FormatSpec sourceSpec;
+            wxString reason;
+            if (!lang.parse(source, sourceSpec, reason))
+                break;
+
+            for (size_t i = 0; i < translations.size(); i++)
+            {
+                const wxString translationName = TranslationFieldName(item, i);
+
+                FormatSpec translationSpec;
+                if (!lang.parse(translations[i], translationSpec, reason))
+                {
+                    return wxString::Format(_("'%s' is not a valid %s format string, unlike '%s'. Reason: %s"),
+                                            translationName, lang.displayName, sourceName, reason);
+                }
+
+                // Translations for forms used only for a few numbers (e.g.
+                // "one" in English) may omit arguments, because the value
+                // may be implied by the text:
+                const bool strict = !item.HasPlural() ||
+                                    translations.size() == 1 ||
+                                    (i < m_oftenUsedForms.size() && m_oftenUsedForms[i]);
+
+                auto err = CompareFormatSpecs(lang, sourceSpec, translationSpec, strict, sourceName, translationName);
+                if (!err.empty())
+                    return err;
+            }
+            break;
+        }
+    }
+
+    return wxString();
+}
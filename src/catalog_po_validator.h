@@ -0,0 +1,93 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef Poedit_catalog_po_validator_h
+#define Poedit_catalog_po_validator_h
+
+#include "catalog.h"
+
+#include <vector>
+
+
+/**
+    Checks PO messages for errors, in the same way msgfmt --check does.
+
+    Verifies that translations are consistent with the source text with
+    respect to leading and trailing newlines, that they are valid format
+    strings if the message is flagged as such (c-format, python-format,
+    php-format etc.) and use the same arguments as the source, and that
+    plural forms agree with the catalog's Plural-Forms header. Format string
+    languages not implemented here are reported by HasUnsupportedFormat().
+
+    The validator doesn't modify anything and CheckItem() is safe to call
+    from multiple threads concurrently.
+ */
+class POValidator
+{
+public:
+    /**
+        Creates the validator.
+
+        @param pluralForms     Plural forms expression from the header.
+        @param hasPluralForms  Whether the header has Plural-Forms at all.
+        @param pluralsCount    Number of plural forms written for messages
+                               with plurals when saving the catalog.
+     */
+    POValidator(const PluralFormsExpr& pluralForms, bool hasPluralForms, unsigned pluralsCount);
+
+    /**
+        Checks a single message.
+
+        Fuzzy and untranslated messages are skipped, because msgfmt doesn't
+        compile them either.
+
+        @return Description of the first found error or empty string if the
+                message is OK.
+     */
+    wxString CheckItem(const CatalogItem& item) const;
+
+    /**
+        Returns true if the message is flagged with a format string language
+        that CheckItem() doesn't know, such as java-format or lua-format.
+
+        Such messages must be checked with msgfmt in addition to CheckItem().
+     */
+    bool HasUnsupportedFormat(const CatalogItem& item) const;
+
+private:
+    wxString CheckNewlines(const CatalogItem& item, const std::vector<std::wstring>& translations) const;
+    wxString CheckFormat(const CatalogItem& item, const std::vector<std::wstring>& translations) const;
+    wxString CheckPluralForms(const std::vector<std::wstring>& translations) const;
+
+    bool m_hasPluralForms;
+    unsigned m_nplurals;
+    unsigned m_pluralsCount;
+    wxString m_pluralFormsError;
+    // plural forms used for many values of n, where arguments must not be omitted
+    std::vector<bool> m_oftenUsedForms;
+};
+
+#endif // Poedit_catalog_po_validator_h
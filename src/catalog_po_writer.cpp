@@ -0,0 +1,1644 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "catalog_po_writer.h"
+
+#include "utility.h"
+
+#include <unicode/uchar.h>
+#include <unicode/utf8.h>
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+
+// ----------------------------------------------------------------------
+// Line breaking
+// ----------------------------------------------------------------------
+
+// gettext tools wrap long strings using libunistring's implementation of
+// the Unicode line breaking algorithm (UAX #14). To produce identical output,
+// the code below replicates the same (pair table based) algorithm, using
+// character properties from ICU instead.
+
+namespace
+{
+
+enum LineBreakClass
+{
+    // classes handled by the pair table:
+    LB_OP, LB_CL, LB_CP, LB_QU, LB_GL, LB_NS, LB_EX, LB_SY, LB_IS, LB_PR, LB_PO, LB_NU,
+    LB_AL, LB_HL, LB_ID, LB_IN, LB_HY, LB_BA, LB_BB, LB_B2, LB_WJ, LB_H2, LB_H3, LB_JL,
+    LB_JV, LB_JT, LB_RI, LB_EB, LB_EM,
+    // classes with special handling:
+    LB_BK, LB_SP, LB_ZW, LB_CM, LB_ZWJ
+};
+
+// Actions in the pair table: prohibited, indirect (only if separated by
+// spaces) and direct break.
+enum LineBreakAction : char { P, I, D };
+
+const LineBreakAction LineBreakPairTable[][LB_EM + 1] =
+{
+    /*        OP CL CP QU GL NS EX SY IS PR PO NU AL HL ID IN HY BA BB B2 WJ H2 H3 JL JV JT RI EB EM */
+    /* OP */ { P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P, P },
+    /* CL */ { D, P, P, I, I, P, P, P, P, I, I, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* CP */ { D, P, P, I, I, I, P, P, P, I, I, I, I, I, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* QU */ { P, P, P, I, I, I, P, P, P, I, I, I, I, I, I, I, I, I, I, I, P, I, I, I, I, I, I, I, I },
+    /* GL */ { I, P, P, I, I, I, P, P, P, I, I, I, I, I, I, I, I, I, I, I, P, I, I, I, I, I, I, I, I },
+    /* NS */ { D, P, P, I, I, I, P, P, P, D, D, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* EX */ { D, P, P, I, I, I, P, P, P, D, D, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* SY */ { D, P, P, I, I, I, P, P, P, D, D, I, D, I, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* IS */ { D, P, P, I, I, I, P, P, P, D, D, I, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* PR */ { I, P, P, I, I, I, P, P, P, D, D, I, I, I, I, I, I, I, D, D, P, I, I, I, I, I, D, I, I },
+    /* PO */ { I, P, P, I, I, I, P, P, P, D, D, I, I, I, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* NU */ { I, P, P, I, I, I, P, P, P, I, I, I, I, I, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* AL */ { I, P, P, I, I, I, P, P, P, I, I, I, I, I, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* HL */ { I, P, P, I, I, I, P, P, P, I, I, I, I, I, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* ID */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* IN */ { D, P, P, I, I, I, P, P, P, D, D, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* HY */ { D, P, P, I, D, I, P, P, P, D, D, I, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* BA */ { D, P, P, I, D, I, P, P, P, D, D, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+    /* BB */ { I, P, P, I, I, I, P, P, P, I, I, I, I, I, I, I, I, I, I, I, P, I, I, I, I, I, I, I, I },
+    /* B2 */ { D, P, P, I, I, I, P, P, P, D, D, D, D, D, D, I, I, I, D, P, P, D, D, D, D, D, D, D, D },
+    /* WJ */ { I, P, P, I, I, I, P, P, P, I, I, I, I, I, I, I, I, I, I, I, P, I, I, I, I, I, I, I, I },
+    /* H2 */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, D, D, D, I, I, D, D, D },
+    /* H3 */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, D, D, D, D, I, D, D, D },
+    /* JL */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, I, I, I, I, D, D, D, D },
+    /* JV */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, D, D, D, I, I, D, D, D },
+    /* JT */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, D, D, D, D, I, D, D, D },
+    /* RI */ { D, P, P, I, I, I, P, P, P, D, D, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, I, D, D },
+    /* EB */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, I },
+    /* EM */ { D, P, P, I, I, I, P, P, P, D, I, D, D, D, D, I, I, I, D, D, P, D, D, D, D, D, D, D, D },
+};
+
+enum : char
+{
+    BREAK_UNDEFINED = 0,
+    BREAK_PROHIBITED = 1,
+    BREAK_POSSIBLE = 2,
+    BREAK_MANDATORY = 3
+};
+
+LineBreakClass GetLineBreakClass(UChar32 c, bool cjk)
+{
+    if (c < 0x80)
+    {
+        // fast path for ASCII
+        switch (c)
+        {
+            case ' ': return LB_SP;
+            case '\n': case '\r': case 0x0B: case 0x0C: return LB_BK;
+            case '\t': case '|': return LB_BA;
+            case '-': return LB_HY;
+            case '(': case '[': case '{': return LB_OP;
+            case ')': case ']': return LB_CP;
+            case '}': return LB_CL;
+            case '"': case '\'': return LB_QU;
+            case '!': case '?': return LB_EX;
+            case '/': return LB_SY;
+            case ',': case '.': case ':': case ';': return LB_IS;
+            case '$': case '+': case '\\': return LB_PR;
+            case '%': return LB_PO;
+            default:
+                if (c >= '0' && c <= '9')
+                    return LB_NU;
+                if (c < 0x20 || c == 0x7F)
+                    return LB_CM;
+                return LB_AL;
+        }
+    }
+
+    switch (u_getIntPropertyValue(c, UCHAR_LINE_BREAK))
+    {
+        case U_LB_OPEN_PUNCTUATION:         return LB_OP;
+        case U_LB_CLOSE_PUNCTUATION:        return LB_CL;
+        case U_LB_CLOSE_PARENTHESIS:        return LB_CP;
+        case U_LB_QUOTATION:                return LB_QU;
+        case U_LB_GLUE:                     return LB_GL;
+        case U_LB_NONSTARTER:
+        case U_LB_CONDITIONAL_JAPANESE_STARTER:
+                                            return LB_NS;
+        case U_LB_EXCLAMATION:              return LB_EX;
+        case U_LB_BREAK_SYMBOLS:            return LB_SY;
+        case U_LB_INFIX_NUMERIC:            return LB_IS;
+        case U_LB_PREFIX_NUMERIC:           return LB_PR;
+        case U_LB_POSTFIX_NUMERIC:          return LB_PO;
+        case U_LB_NUMERIC:                  return LB_NU;
+        case U_LB_HEBREW_LETTER:            return LB_HL;
+        case U_LB_IDEOGRAPHIC:
+        case U_LB_CONTINGENT_BREAK:         return LB_ID;
+        case U_LB_INSEPARABLE:              return LB_IN;
+        case U_LB_HYPHEN:                   return LB_HY;
+        case U_LB_BREAK_AFTER:              return LB_BA;
+        case U_LB_BREAK_BEFORE:             return LB_BB;
+        case U_LB_BREAK_BOTH:               return LB_B2;
+        case U_LB_WORD_JOINER:              return LB_WJ;
+        case U_LB_H2:                       return LB_H2;
+        case U_LB_H3:                       return LB_H3;
+        case U_LB_JL:                       return LB_JL;
+        case U_LB_JV:                       return LB_JV;
+        case U_LB_JT:                       return LB_JT;
+        case U_LB_REGIONAL_INDICATOR:       return LB_RI;
+        case U_LB_E_BASE:                   return LB_EB;
+        case U_LB_E_MODIFIER:               return LB_EM;
+        case U_LB_MANDATORY_BREAK:
+        case U_LB_CARRIAGE_RETURN:
+        case U_LB_LINE_FEED:
+        case U_LB_NEXT_LINE:                return LB_BK;
+        case U_LB_SPACE:                    return LB_SP;
+        case U_LB_ZWSPACE:                  return LB_ZW;
+        case U_LB_COMBINING_MARK:
+        case U_LB_SURROGATE:                return LB_CM;
+        case U_LB_ZWJ:                      return LB_ZWJ;
+        case U_LB_AMBIGUOUS:                return cjk ? LB_ID : LB_AL;
+        default:                            return LB_AL; // AL, SA, XX
+    }
+}
+
+inline bool IsEastAsianWide(UChar32 c)
+{
+    switch (u_getIntPropertyValue(c, UCHAR_EAST_ASIAN_WIDTH))
+    {
+        case U_EA_FULLWIDTH:
+        case U_EA_WIDE:
+        case U_EA_HALFWIDTH:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// Width of the character in columns, -1 for control characters
+int GetCharWidth(UChar32 c, bool cjk)
+{
+    if (c < 0x20 || (c >= 0x7F && c < 0xA0))
+        return c == 0 ? 0 : -1;
+    if (c < 0x300 && c != 0xAD)
+        return (cjk && c >= 0xA1) ? 2 : 1;
+
+    switch (u_charType(c))
+    {
+        case U_NON_SPACING_MARK:
+        case U_ENCLOSING_MARK:
+        case U_FORMAT_CHAR:
+            return 0;
+        default:
+            break;
+    }
+    if ((c >= 0x1160 && c < 0x1200) || (c >= 0xD7B0 && c < 0xD800))
+        return 0; // Hangul Jamo medial vowels and final consonants
+
+    // in legacy CJK encodings, most characters are double-width:
+    if (cjk && c < 0xFF61 && c != 0x20A9)
+        return 2;
+
+    switch (u_getIntPropertyValue(c, UCHAR_EAST_ASIAN_WIDTH))
+    {
+        case U_EA_WIDE:
+        case U_EA_FULLWIDTH:
+            return 2;
+        default:
+            break;
+    }
+
+    // unassigned code points in CJK blocks are wide too:
+    if (!u_isdefined(c) &&
+        ((c >= 0x2E80 && c < 0xA4D0) || (c >= 0xAC00 && c < 0xD7A4) || (c >= 0xF900 && c < 0xFB00) ||
+         (c >= 0x20000 && c < 0x2FFFE) || (c >= 0x30000 && c < 0x3FFFE)))
+    {
+        return 2;
+    }
+
+    return 1;
+}
+
+/// Determines break opportunities in UTF-8 string @a s, stores them into @a p
+void GetPossibleLineBreaks(const char *s, size_t n, bool cjk, char *p)
+{
+    memset(p, BREAK_PROHIBITED, n);
+
+    int lastClass = LB_BK;  // class of the last non-space character
+    bool seenSpace = false; // whether spaces follow lastClass character
+    bool lastIsWide = false;
+    bool afterZWJ = false;
+    bool afterHebrew = false, afterHebrewHyphen = false;
+    int riCount = 0;
+
+    int32_t i = 0;
+    const int32_t length = (int32_t)n;
+    while (i < length)
+    {
+        char *q = p + i;
+        UChar32 c;
+        U8_NEXT_OR_FFFD(s, i, length, c);
+        const int cls = GetLineBreakClass(c, cjk);
+
+        switch (cls)
+        {
+            case LB_BK:
+                *q = BREAK_MANDATORY;
+                lastClass = LB_BK;
+                seenSpace = afterZWJ = afterHebrew = afterHebrewHyphen = false;
+                continue;
+
+            case LB_SP:
+                seenSpace = true;
+                afterZWJ = afterHebrew = afterHebrewHyphen = false;
+                continue;
+
+            case LB_ZW:
+                lastClass = LB_ZW;
+                seenSpace = afterZWJ = afterHebrew = afterHebrewHyphen = false;
+                continue;
+
+            case LB_CM:
+            case LB_ZWJ:
+                // combining marks attach to the preceding character, unless
+                // there's nothing to attach to, in which case they act as AL
+                if (lastClass == LB_ZW || (seenSpace && lastClass != LB_BK))
+                    *q = BREAK_POSSIBLE;
+                if (lastClass == LB_BK || lastClass == LB_ZW || seenSpace)
+                    lastClass = LB_AL;
+                seenSpace = afterHebrew = afterHebrewHyphen = false;
+                afterZWJ = (cls == LB_ZWJ);
+                riCount = 0;
+                continue;
+
+            default:
+                break;
+        }
+
+        if (lastClass == LB_BK)
+            ; // don't break at the beginning of a line
+        else if (lastClass == LB_ZW)
+            *q = BREAK_POSSIBLE;
+        else if (afterZWJ && !seenSpace)
+            ; // don't break after ZWJ
+        else if (afterHebrewHyphen)
+            ; // don't break after Hebrew + hyphen
+        else if (cls == LB_RI && lastClass == LB_RI && !seenSpace)
+        {
+            // regional indicators form pairs
+            if (riCount % 2 == 0)
+                *q = BREAK_POSSIBLE;
+        }
+        else if (cls == LB_OP && !seenSpace && IsEastAsianWide(c) && (lastClass == LB_AL || lastClass == LB_HL || lastClass == LB_NU))
+            *q = BREAK_POSSIBLE; // wide opening punctuation isn't glued to preceding text
+        else if (lastClass == LB_CP && lastIsWide && !seenSpace && (cls == LB_AL || cls == LB_HL || cls == LB_NU))
+            *q = BREAK_POSSIBLE;
+        else
+        {
+            switch (LineBreakPairTable[lastClass][cls])
+            {
+                case D:
+                    *q = BREAK_POSSIBLE;
+                    break;
+                case I:
+                    if (seenSpace)
+                        *q = BREAK_POSSIBLE;
+                    break;
+                case P:
+                    break;
+            }
+        }
+
+        afterHebrewHyphen = (cls == LB_HY || cls == LB_BA) && afterHebrew && !seenSpace;
+        afterHebrew = (cls == LB_HL);
+        riCount = (cls == LB_RI) ? (lastClass == LB_RI && !seenSpace ? riCount + 1 : 1) : 0;
+        lastClass = cls;
+        lastIsWide = (cls == LB_CP) && IsEastAsianWide(c);
+        seenSpace = afterZWJ = false;
+    }
+}
+
+/**
+    Chooses line breaks in @a s so that the lines fit into @a width columns
+    where possible, with the first line starting at @a startColumn. Breaks
+    in @a overrides, if not BREAK_UNDEFINED, take precedence over the
+    Unicode rules. On return, @a p contains BREAK_POSSIBLE where the line
+    should be broken.
+ */
+void GetWidthLineBreaks(const char *s, size_t n, int width, int startColumn,
+                        const char *overrides, bool cjk, char *p)
+{
+    GetPossibleLineBreaks(s, n, cjk, p);
+
+    char *lastBreak = nullptr;
+    int lastColumn = startColumn;
+    int pieceWidth = 0;
+
+    int32_t i = 0;
+    const int32_t length = (int32_t)n;
+    while (i < length)
+    {
+        const int32_t start = i;
+        UChar32 c;
+        U8_NEXT_OR_FFFD(s, i, length, c);
+
+        char *q = p + start;
+        if (overrides[start] != BREAK_UNDEFINED)
+            *q = overrides[start];
+
+        if (*q == BREAK_POSSIBLE || *q == BREAK_MANDATORY)
+        {
+            // an atomic piece of text ends here
+            if (lastBreak && lastColumn + pieceWidth > width)
+            {
+                *lastBreak = BREAK_POSSIBLE;
+                lastColumn = 0;
+            }
+        }
+
+        if (*q == BREAK_MANDATORY)
+        {
+            lastBreak = nullptr;
+            lastColumn = 0;
+            pieceWidth = 0;
+        }
+        else
+        {
+            if (*q == BREAK_POSSIBLE)
+            {
+                // start a new piece, the break may be used later
+                lastBreak = q;
+                lastColumn += pieceWidth;
+                pieceWidth = 0;
+            }
+            *q = BREAK_PROHIBITED;
+
+            const int w = GetCharWidth(c, cjk);
+            if (w >= 0)
+                pieceWidth += w;
+        }
+    }
+
+    if (lastBreak && lastColumn + pieceWidth > width)
+        *lastBreak = BREAK_POSSIBLE;
+}
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------
+
+namespace
+{
+
+const int DEFAULT_PAGE_WIDTH = 79;
+
+inline bool IsOneOf(char c, const char *chars)
+{
+    return c != '\0' && strchr(chars, c) != nullptr;
+}
+
+inline bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool StartsWith(std::string_view s, const char *prefix)
+{
+    return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+inline bool EndsWith(std::string_view s, const char *suffix)
+{
+    const size_t len = strlen(suffix);
+    return s.length() >= len && s.compare(s.length() - len, len, suffix) == 0;
+}
+
+// Parses a string of digits like strtoul() does, i.e. saturating on overflow
+inline unsigned long ParseNumber(std::string_view digits)
+{
+    unsigned long value = 0;
+    for (char c: digits)
+    {
+        const unsigned long d = (unsigned long)(c - '0');
+        if (value > (ULONG_MAX - d) / 10)
+            return ULONG_MAX;
+        value = value * 10 + d;
+    }
+    return value;
+}
+
+// Appends decimal representation of the number to the output
+inline void AppendNumber(std::string& out, unsigned long value)
+{
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr - buf);
+}
+
+inline std::string ToUpper(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](char c){ return (char)toupper((unsigned char)c); });
+    return s;
+}
+
+inline bool IsUTF8Charset(const std::string& charset)
+{
+    const auto upper = ToUpper(charset);
+    return upper == "UTF-8" || upper == "UTF8";
+}
+
+// Legacy multibyte encodings in which gettext treats most characters as double-width
+bool IsCJKCharset(const std::string& charset)
+{
+    const auto upper = ToUpper(charset);
+    static const char *cjk[] = { "EUC-JP", "GB2312", "EUC-CN", "GBK", "EUC-TW", "BIG5", "EUC-KR", "CP949", "JOHAB" };
+    for (auto c: cjk)
+    {
+        if (upper == c)
+            return true;
+    }
+    return false;
+}
+
+
+// Kinds of format directives that we know how to recognize in strings, so
+// that lines aren't wrapped in the middle of a directive:
+enum class DirectiveSyntax
+{
+    None,
+    Printf,
+    PythonPrintf,
+    Brace
+};
+
+struct FormatLanguage
+{
+    const char *name;
+    DirectiveSyntax syntax;
+};
+
+// Known format languages, in the order used by gettext when writing flags:
+const FormatLanguage FormatLanguages[] =
+{
+    { "c",              DirectiveSyntax::Printf },
+    { "objc",           DirectiveSyntax::Printf },
+    { "c++",            DirectiveSyntax::Brace },
+    { "python",         DirectiveSyntax::PythonPrintf },
+    { "python-brace",   DirectiveSyntax::Brace },
+    { "java",           DirectiveSyntax::Brace },
+    { "java-printf",    DirectiveSyntax::Printf },
+    { "csharp",         DirectiveSyntax::Brace },
+    { "javascript",     DirectiveSyntax::Printf },
+    { "scheme",         DirectiveSyntax::None },
+    { "lisp",           DirectiveSyntax::None },
+    { "elisp",          DirectiveSyntax::None },
+    { "librep",         DirectiveSyntax::None },
+    { "rust",           DirectiveSyntax::Brace },
+    { "go",             DirectiveSyntax::Printf },
+    { "ruby",           DirectiveSyntax::Printf },
+    { "sh",             DirectiveSyntax::None },
+    { "awk",            DirectiveSyntax::Printf },
+    { "lua",            DirectiveSyntax::Printf },
+    { "object-pascal",  DirectiveSyntax::None },
+    { "smalltalk",      DirectiveSyntax::None },
+    { "qt",             DirectiveSyntax::None },
+    { "qt-plural",      DirectiveSyntax::None },
+    { "kde",            DirectiveSyntax::None },
+    { "kde-kuit",       DirectiveSyntax::None },
+    { "boost",          DirectiveSyntax::Printf },
+    { "tcl",            DirectiveSyntax::Printf },
+    { "perl",           DirectiveSyntax::Printf },
+    { "perl-brace",     DirectiveSyntax::Brace },
+    { "php",            DirectiveSyntax::Printf },
+    { "gcc-internal",   DirectiveSyntax::Printf },
+    { "gfc-internal",   DirectiveSyntax::Printf },
+    { "ycp",            DirectiveSyntax::None }
+};
+
+const size_t FormatLanguagesCount = sizeof(FormatLanguages) / sizeof(FormatLanguages[0]);
+
+enum class FormatState : char
+{
+    Undecided,
+    Yes,
+    No,
+    Possible,
+    Impossible
+};
+
+// Syntax checks, in gettext's order
+const char *SyntaxChecks[] = { "ellipsis-unicode", "space-ellipsis", "quote-unicode", "bullet-unicode" };
+const size_t SyntaxChecksCount = sizeof(SyntaxChecks) / sizeof(SyntaxChecks[0]);
+
+
+// Values in format directives map:
+enum : char
+{
+    DIRECTIVE_NONE = 0,
+    DIRECTIVE_START,
+    DIRECTIVE_INSIDE
+};
+
+inline void MarkDirective(std::vector<char>& attr, size_t start, size_t end)
+{
+    attr[start] = DIRECTIVE_START;
+    for (size_t i = start + 1; i <= end; i++)
+        attr[i] = DIRECTIVE_INSIDE;
+}
+
+// Finds printf-style directives. Like gettext, stops at the first invalid one.
+void FindPrintfDirectives(const std::string& s, bool python, std::vector<char>& attr)
+{
+    const size_t len = s.length();
+    size_t i = 0;
+
+    auto skipDigits = [&]{ while (i < len && IsDigit(s[i])) i++; };
+    auto skipWidth = [&]
+    {
+        if (i < len && s[i] == '*')
+        {
+            i++;
+            const size_t num = i;
+            skipDigits();
+            if (i > num && i < len && s[i] == '$')
+                i++;
+            else
+                i = num;
+        }
+        else
+        {
+            skipDigits();
+        }
+    };
+
+    while (i < len)
+    {
+        if (s[i] != '%')
+        {
+            i++;
+            continue;
+        }
+
+        const size_t start = i++;
+        if (i < len && s[i] == '%')
+        {
+            MarkDirective(attr, start, i++);
+            continue;
+        }
+
+        if (python && i < len && s[i] == '(')
+        {
+            const size_t close = s.find(')', i);
+            if (close == std::string::npos)
+                return;
+            i = close + 1;
+        }
+        else
+        {
+            // positional argument, e.g. %1$s
+            const size_t num = i;
+            skipDigits();
+            if (i > num && i < len && s[i] == '$')
+                i++;
+            else
+                i = num;
+        }
+
+        while (i < len && IsOneOf(s[i], "-+ #0'I"))
+            i++;
+        skipWidth();
+        if (i < len && s[i] == '.')
+        {
+            i++;
+            skipWidth();
+        }
+        while (i < len && IsOneOf(s[i], "hlLqjzZt"))
+            i++;
+
+        if (i >= len || !IsOneOf(s[i], "diouxXeEfFgGaAcsSpnCrbv@"))
+            return;
+
+        MarkDirective(attr, start, i++);
+    }
+}
+
+// Finds brace-style directives, such as {0} or {name:>10}
+void FindBraceDirectives(const std::string& s, std::vector<char>& attr)
+{
+    const size_t len = s.length();
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] == '{')
+        {
+            if (i + 1 < len && s[i+1] == '{')
+            {
+                MarkDirective(attr, i, i + 1);
+                i++;
+                continue;
+            }
+            const size_t close = s.find_first_of("{}", i + 1);
+            if (close == std::string::npos || s[close] != '}')
+                return;
+            MarkDirective(attr, i, close);
+            i = close;
+        }
+        else if (s[i] == '}' && i + 1 < len && s[i+1] == '}')
+        {
+            MarkDirective(attr, i, i + 1);
+            i++;
+        }
+    }
+}
+
+
+// Parses line of the form `keyword "string"` or just `"string"`
+bool ParseFieldLine(const std::string& line, std::string& keyword, std::string& value)
+{
+    size_t pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos)
+        return false;
+
+    const size_t kwstart = pos;
+    while (pos < line.length() && !IsOneOf(line[pos], " \t\""))
+        pos++;
+    keyword.assign(line, kwstart, pos - kwstart);
+
+    pos = line.find_first_not_of(" \t", pos);
+    const size_t last = line.find_last_not_of(" \t\r");
+    if (pos == std::string::npos || line[pos] != '"' || last <= pos || line[last] != '"')
+        return false;
+
+    value = UnescapeCString(line.substr(pos + 1, last - pos - 1));
+    return true;
+}
+
+// Previous msgid information, as parsed from #| lines
+struct PreviousMsgid
+{
+    bool hasContext = false, hasMsgid = false, hasPlural = false;
+    std::string context, msgid, plural;
+};
+
+bool ParsePrevious(const std::vector<std::string>& lines, PreviousMsgid& prev)
+{
+    std::string keyword, value;
+    std::string *field = nullptr;
+
+    for (auto& ln: lines)
+    {
+        if (!ParseFieldLine(ln, keyword, value))
+            return false;
+
+        if (keyword.empty())
+        {
+            if (!field)
+                return false;
+            *field += value;
+            continue;
+        }
+
+        if (keyword == "msgctxt" && !prev.hasContext && !prev.hasMsgid)
+        {
+            prev.hasContext = true;
+            field = &prev.context;
+        }
+        else if (keyword == "msgid" && !prev.hasMsgid)
+        {
+            prev.hasMsgid = true;
+            field = &prev.msgid;
+        }
+        else if (keyword == "msgid_plural" && prev.hasMsgid && !prev.hasPlural)
+        {
+            prev.hasPlural = true;
+            field = &prev.plural;
+        }
+        else
+        {
+            return false;
+        }
+
+        *field = value;
+    }
+
+    return true;
+}
+
+
+// File position from #: line, referring to the text it was parsed from
+struct FilePos
+{
+    std::string_view file;
+    bool hasLine = false;
+    unsigned long line = 0;
+
+    bool operator<(const FilePos& other) const
+    {
+        return std::tie(file, hasLine, line) < std::tie(other.file, other.hasLine, other.line);
+    }
+
+    bool operator==(const FilePos& other) const
+    {
+        return file == other.file && hasLine == other.hasLine && line == other.line;
+    }
+};
+
+const char FIRST_STRONG_ISOLATE[] = "\xE2\x81\xA8";
+const char POP_DIRECTIONAL_ISOLATE[] = "\xE2\x81\xA9";
+
+// Parses references in the same way gettext does; file names with spaces
+// in them are enclosed in U+2068 and U+2069
+void ParseReferences(std::string_view text, std::vector<FilePos>& out)
+{
+    const size_t len = text.length();
+    size_t pos = 0;
+
+    auto parseLineNumber = [](std::string_view num, FilePos& fp)
+    {
+        if (num.empty() || !std::all_of(num.begin(), num.end(), IsDigit))
+            return false;
+        fp.hasLine = true;
+        fp.line = ParseNumber(num);
+        return true;
+    };
+
+    for (;;)
+    {
+        while (pos < len && IsOneOf(text[pos], " \t\r\n"))
+            pos++;
+        if (pos >= len)
+            break;
+
+        FilePos fp;
+        if (text.compare(pos, 3, FIRST_STRONG_ISOLATE) == 0)
+        {
+            pos += 3;
+            size_t end = text.find(POP_DIRECTIONAL_ISOLATE, pos);
+            if (end == std::string_view::npos)
+                end = len;
+            fp.file = text.substr(pos, end - pos);
+            pos = std::min(end + 3, len);
+
+            size_t numEnd = pos;
+            while (numEnd < len && !IsOneOf(text[numEnd], " \t\r\n"))
+                numEnd++;
+            if (pos < numEnd && text[pos] == ':')
+                parseLineNumber(text.substr(pos + 1, numEnd - pos - 1), fp);
+            pos = numEnd;
+        }
+        else
+        {
+            const size_t start = pos;
+            while (pos < len && !IsOneOf(text[pos], " \t\r\n"))
+                pos++;
+            fp.file = text.substr(start, pos - start);
+
+            const size_t colon = fp.file.rfind(':');
+            if (colon != std::string_view::npos && colon > 0 && parseLineNumber(fp.file.substr(colon + 1), fp))
+                fp.file = fp.file.substr(0, colon);
+        }
+
+        out.push_back(fp);
+    }
+}
+
+} // anonymous namespace
+
+
+// ----------------------------------------------------------------------
+// POWriter
+// ----------------------------------------------------------------------
+
+struct POWriter::FlagsInfo
+{
+    explicit FlagsInfo(const std::string& flags);
+
+    /// Appends the #, line (without EOL) to @a out; returns false if there's none
+    bool AppendLine(std::string& out, bool hasTranslation) const;
+
+    bool fuzzy = false;
+    bool noWrap = false;
+    bool hasRange = false;
+    unsigned long rangeMin = 0, rangeMax = 0;
+    FormatState formats[FormatLanguagesCount] = {};
+    FormatState checks[SyntaxChecksCount] = {};
+    std::vector<std::string> unknownFormats;
+
+    /// Syntax of directives of the format language used by the message
+    DirectiveSyntax syntax = DirectiveSyntax::None;
+};
+
+
+POWriter::FlagsInfo::FlagsInfo(const std::string& flags)
+{
+    const size_t len = flags.length();
+    size_t pos = 0;
+
+    auto nextToken = [&](const char *separators)
+    {
+        while (pos < len && IsOneOf(flags[pos], separators))
+            pos++;
+        const size_t start = pos;
+        while (pos < len && !IsOneOf(flags[pos], separators))
+            pos++;
+        return std::string_view(flags).substr(start, pos - start);
+    };
+
+    for (;;)
+    {
+        const std::string_view token = nextToken(" \t\r\n,");
+        if (token.empty())
+            break;
+
+        if (token == "fuzzy")
+        {
+            fuzzy = true;
+        }
+        else if (token == "wrap" || token == "no-wrap")
+        {
+            noWrap = (token == "no-wrap");
+        }
+        else if (token == "range:")
+        {
+            const std::string_view range = nextToken(" \t\r\n,");
+            const size_t dots = range.find("..");
+            if (dots != std::string_view::npos && dots > 0 && dots + 2 < range.length() &&
+                std::all_of(range.begin(), range.begin() + dots, IsDigit) &&
+                std::all_of(range.begin() + dots + 2, range.end(), IsDigit))
+            {
+                rangeMin = ParseNumber(range.substr(0, dots));
+                rangeMax = ParseNumber(range.substr(dots + 2));
+                hasRange = rangeMin <= rangeMax;
+            }
+        }
+        else if (EndsWith(token, "-format") || EndsWith(token, "-check"))
+        {
+            const bool isFormat = EndsWith(token, "-format");
+            std::string_view name = token.substr(0, token.length() - (isFormat ? 7 : 6));
+            FormatState state = FormatState::Yes;
+            if (StartsWith(name, "no-"))
+            {
+                state = FormatState::No;
+                name.remove_prefix(3);
+            }
+            else if (isFormat && StartsWith(name, "possible-"))
+            {
+                state = FormatState::Possible;
+                name.remove_prefix(9);
+            }
+            else if (isFormat && StartsWith(name, "impossible-"))
+            {
+                state = FormatState::Impossible;
+                name.remove_prefix(11);
+            }
+
+            bool known = false;
+            if (isFormat)
+            {
+                for (size_t i = 0; i < FormatLanguagesCount; i++)
+                {
+                    if (name == FormatLanguages[i].name)
+                    {
+                        formats[i] = state;
+                        known = true;
+                        break;
+                    }
+                }
+                // preserve format flags of languages we don't know about yet:
+                if (!known && std::find(unknownFormats.begin(), unknownFormats.end(), token) == unknownFormats.end())
+                    unknownFormats.emplace_back(token);
+            }
+            else
+            {
+                for (size_t i = 0; i < SyntaxChecksCount; i++)
+                {
+                    if (name == SyntaxChecks[i])
+                    {
+                        checks[i] = state;
+                        break;
+                    }
+                }
+            }
+        }
+        // else: unknown flags are dropped, as gettext tools do
+    }
+
+    for (size_t i = 0; i < FormatLanguagesCount; i++)
+    {
+        if (formats[i] == FormatState::Yes || formats[i] == FormatState::Possible)
+        {
+            syntax = FormatLanguages[i].syntax;
+            break;
+        }
+    }
+}
+
+
+bool POWriter::FlagsInfo::AppendLine(std::string& out, bool hasTranslation) const
+{
+    const size_t start = out.length();
+    out += "#,";
+    bool first = true;
+    auto add = [&](const char *prefix, const char *flag, const char *suffix)
+    {
+        if (!first)
+            out += ',';
+        out += ' ';
+        out += prefix;
+        out += flag;
+        out += suffix;
+        first = false;
+    };
+
+    // fuzzy flag makes no sense on untranslated entries
+    if (fuzzy && hasTranslation)
+        add("", "fuzzy", "");
+
+    for (size_t i = 0; i < FormatLanguagesCount; i++)
+    {
+        switch (formats[i])
+        {
+            case FormatState::Yes:
+            case FormatState::Possible:
+                add("", FormatLanguages[i].name, "-format");
+                break;
+            case FormatState::No:
+                add("no-", FormatLanguages[i].name, "-format");
+                break;
+            case FormatState::Undecided:
+            case FormatState::Impossible:
+                break;
+        }
+    }
+    for (auto& f: unknownFormats)
+        add("", f.c_str(), "");
+
+    if (hasRange)
+    {
+        add("range: ", "", "");
+        AppendNumber(out, rangeMin);
+        out += "..";
+        AppendNumber(out, rangeMax);
+    }
+
+    if (noWrap)
+        add("", "no-wrap", "");
+
+    for (size_t i = 0; i < SyntaxChecksCount; i++)
+    {
+        if (checks[i] == FormatState::Yes)
+            add("", SyntaxChecks[i], "-check");
+        else if (checks[i] == FormatState::No)
+            add("no-", SyntaxChecks[i], "-check");
+    }
+
+    if (first)
+        out.resize(start);
+    return !first;
+}
+
+
+/// Obsolete message being assembled from (possibly several) deleted items
+struct POWriter::ObsoleteMessage
+{
+    Entry entry;
+    std::vector<std::string> rawLines;
+    int line = 0;
+
+    bool valid = true;
+    bool hasMsgid = false;
+    std::string *field = nullptr;
+
+    void AddLines(const std::vector<std::string>& lines);
+    void ParseLine(const std::string& line);
+
+    bool IsComplete() const { return valid && hasMsgid && !entry.translations.empty(); }
+};
+
+
+void POWriter::ObsoleteMessage::AddLines(const std::vector<std::string>& lines)
+{
+    for (auto& ln: lines)
+    {
+        rawLines.push_back(ln);
+        if (valid)
+            ParseLine(ln);
+    }
+}
+
+
+void POWriter::ObsoleteMessage::ParseLine(const std::string& line)
+{
+    if (!StartsWith(line, "#~"))
+    {
+        valid = false;
+        return;
+    }
+
+    if (line.length() > 2 && line[2] == '|')
+    {
+        if (hasMsgid)
+            valid = false;
+        else
+            entry.previous.push_back(line.substr(3));
+        return;
+    }
+
+    std::string keyword, value;
+    if (!ParseFieldLine(line.substr(2), keyword, value))
+    {
+        valid = false;
+        return;
+    }
+
+    if (keyword.empty())
+    {
+        if (field)
+            *field += value;
+        else
+            valid = false;
+        return;
+    }
+
+    if (keyword == "msgctxt" && !entry.hasContext && !hasMsgid)
+    {
+        entry.hasContext = true;
+        field = &entry.context;
+    }
+    else if (keyword == "msgid" && !hasMsgid)
+    {
+        hasMsgid = true;
+        field = &entry.msgid;
+    }
+    else if (keyword == "msgid_plural" && hasMsgid && !entry.hasPlural && entry.translations.empty())
+    {
+        entry.hasPlural = true;
+        field = &entry.msgidPlural;
+    }
+    else if (keyword == "msgstr" && hasMsgid && !entry.hasPlural && entry.translations.empty())
+    {
+        entry.translations.emplace_back();
+        field = &entry.translations.back();
+    }
+    else if (StartsWith(keyword, "msgstr[") && entry.hasPlural &&
+             keyword == "msgstr[" + std::to_string(entry.translations.size()) + "]")
+    {
+        entry.translations.emplace_back();
+        field = &entry.translations.back();
+    }
+    else
+    {
+        valid = false;
+        return;
+    }
+
+    *field = value;
+}
+
+
+void POWriter::Entry::AddRawComments(const std::string& text)
+{
+    auto content = [](const std::string& line, size_t from)
+    {
+        if (from < line.length() && line[from] == ' ')
+            from++;
+        return from < line.length() ? line.substr(from) : std::string();
+    };
+
+    size_t pos = 0;
+    while (pos < text.length())
+    {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos)
+            end = text.length();
+        std::string line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] != '#')
+            continue;
+
+        switch (line.length() > 1 ? line[1] : '\0')
+        {
+            case '.':
+                extractedComments.push_back(content(line, 2));
+                break;
+            case ':':
+                references.push_back(content(line, 2));
+                break;
+            case ',':
+            case '=':
+            case '!':
+                flags += ", " + content(line, 2);
+                break;
+            case '|':
+                previous.push_back(content(line, 2));
+                break;
+            default:
+                comments.push_back(content(line, 1));
+                break;
+        }
+    }
+}
+
+
+void POWriter::Entry::Clear()
+{
+    comments.clear();
+    extractedComments.clear();
+    references.clear();
+    flags.clear();
+    previous.clear();
+    hasContext = false;
+    context.clear();
+    msgid.clear();
+    hasPlural = false;
+    msgidPlural.clear();
+    translations.clear();
+}
+
+
+POWriter::POWriter(std::string& output, int wrapping, const std::string& charset, bool crlf)
+    : m_output(output),
+      m_eol(crlf ? "\r\n" : "\n"),
+      m_lines(0),
+      m_empty(true)
+{
+    // same semantics as msgcat's --width and --no-wrap options:
+    m_wrap = wrapping > 0;
+    m_pageWidth = m_wrap ? std::max(wrapping, 20) : DEFAULT_PAGE_WIDTH;
+
+    m_cjk = IsCJKCharset(charset);
+    m_utf8 = charset.empty() || IsUTF8Charset(charset);
+}
+
+
+POWriter::~POWriter()
+{
+}
+
+
+void POWriter::EndLine()
+{
+    m_output += m_eol;
+    m_lines++;
+}
+
+
+void POWriter::WriteLine(const std::string& line)
+{
+    m_output += line;
+    EndLine();
+}
+
+
+void POWriter::WriteLine(const char *prefix, const std::string& text)
+{
+    m_output += prefix;
+    m_output += text;
+    EndLine();
+}
+
+
+void POWriter::BeginMessage()
+{
+    // messages are separated by an empty line
+    if (!m_empty)
+        WriteLine(std::string());
+    m_empty = false;
+}
+
+
+int POWriter::Write(const Entry& entry)
+{
+    BeginMessage();
+    const int firstLine = m_lines + 1;
+
+    const FlagsInfo flags(entry.flags);
+    WriteComments(entry, flags, /*obsolete=*/false);
+    WritePrevious(entry, flags, /*obsolete=*/false);
+    WriteMessageFields(entry, flags, /*obsolete=*/false);
+
+    return firstLine;
+}
+
+
+int POWriter::WriteObsolete(const Entry& entry, const std::vector<std::string>& lines)
+{
+    const bool hasComments = !entry.comments.empty() || !entry.extractedComments.empty() ||
+                             !entry.references.empty() || !entry.flags.empty();
+
+    // Poedit's parser starts a new deleted item at every "#~ msgid" line, so
+    // e.g. obsolete messages with context are split in two. Merge them back:
+    if (m_obsolete && (hasComments || m_obsolete->hasMsgid || !m_obsolete->valid))
+        FlushObsolete();
+
+    if (!m_obsolete)
+    {
+        m_obsolete.reset(new ObsoleteMessage);
+        m_obsolete->entry = entry;
+        m_obsolete->entry.previous.clear();
+        m_obsolete->line = m_lines + (m_empty ? 1 : 2);
+    }
+
+    m_obsolete->AddLines(lines);
+    return m_obsolete->line;
+}
+
+
+int POWriter::WriteVerbatim(const char *text, size_t length, bool continuation)
+{
+    FlushObsolete();
+
+    if (!continuation)
+        BeginMessage();
+    m_empty = false;
+    const int firstLine = m_lines + 1;
+
+    m_output.append(text, length);
+    m_lines += (int)std::count(text, text + length, '\n');
+    if (length && text[length - 1] != '\n')
+    {
+        m_output += m_eol;
+        m_lines++;
+    }
+
+    return firstLine;
+}
+
+
+void POWriter::FlushObsolete()
+{
+    if (!m_obsolete)
+        return;
+
+    std::unique_ptr<ObsoleteMessage> msg;
+    msg.swap(m_obsolete);
+
+    BeginMessage();
+
+    const FlagsInfo flags(msg->entry.flags);
+    WriteComments(msg->entry, flags, /*obsolete=*/true);
+
+    PreviousMsgid prev;
+    if (msg->IsComplete() && ParsePrevious(msg->entry.previous, prev))
+    {
+        WritePrevious(msg->entry, flags, /*obsolete=*/true);
+        WriteMessageFields(msg->entry, flags, /*obsolete=*/true);
+    }
+    else
+    {
+        // we don't understand the content, so at least keep it intact
+        for (auto& ln: msg->rawLines)
+            WriteLine(ln);
+    }
+}
+
+
+void POWriter::Finish()
+{
+    FlushObsolete();
+}
+
+
+void POWriter::WriteComments(const Entry& entry, const FlagsInfo& flags, bool obsolete)
+{
+    for (auto& c: entry.comments)
+    {
+        if (c.empty())
+            WriteLine("#");
+        else
+            WriteLine("# ", c);
+    }
+
+    for (auto& c: entry.extractedComments)
+    {
+        if (c.empty())
+            WriteLine("#.");
+        else
+            WriteLine("#. ", c);
+    }
+
+    if (!entry.references.empty())
+        WriteReferences(entry.references);
+
+    if (obsolete)
+    {
+        if (flags.fuzzy)
+            WriteLine("#, fuzzy");
+    }
+    else
+    {
+        const bool hasTranslation = !entry.translations.empty() && !entry.translations.front().empty();
+        if (flags.AppendLine(m_output, hasTranslation))
+            EndLine();
+    }
+}
+
+
+/// Scratch buffers used by WriteReferences(), reused for all messages
+struct POWriter::ReferencesBuffer
+{
+    std::vector<FilePos> refs;
+    std::vector<size_t> order;
+    std::vector<bool> duplicate;
+};
+
+
+void POWriter::WriteReferences(const std::vector<std::string>& references)
+{
+    if (!m_referencesBuffer)
+        m_referencesBuffer.reset(new ReferencesBuffer);
+    auto& refs = m_referencesBuffer->refs;
+    auto& order = m_referencesBuffer->order;
+    auto& duplicate = m_referencesBuffer->duplicate;
+
+    refs.clear();
+    for (auto& r: references)
+        ParseReferences(r, refs);
+
+    if (refs.empty())
+        return;
+
+    // find duplicates, of which only the first occurrence is written:
+    const size_t count = refs.size();
+    duplicate.assign(count, false);
+    if (count > 1)
+    {
+        order.resize(count);
+        for (size_t i = 0; i < count; i++)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&refs](size_t a, size_t b)
+        {
+            if (refs[a] < refs[b])
+                return true;
+            if (refs[b] < refs[a])
+                return false;
+            return a < b;
+        });
+        for (size_t i = 1; i < count; i++)
+        {
+            if (refs[order[i]] == refs[order[i - 1]])
+                duplicate[order[i]] = true;
+        }
+    }
+
+    m_output += "#:";
+    size_t column = 2;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (duplicate[i])
+            continue;
+        auto& r = refs[i];
+
+        std::string_view file = r.file;
+        while (file.length() >= 2 && file[0] == '.' && file[1] == '/')
+            file.remove_prefix(2);
+
+        char number[32];
+        size_t numberLength = 0;
+        if (r.hasLine)
+        {
+            number[0] = ':';
+            numberLength = std::to_chars(number + 1, number + sizeof(number), r.line).ptr - number;
+        }
+
+        const size_t len = file.length() + numberLength + 1;
+        if (column > 2 && column + len > (size_t)m_pageWidth)
+        {
+            EndLine();
+            m_output += "#:";
+            column = 2;
+        }
+
+        m_output += ' ';
+        if (m_utf8 && file.find_first_of(" \t") != std::string_view::npos)
+        {
+            m_output += FIRST_STRONG_ISOLATE;
+            m_output += file;
+            m_output += POP_DIRECTIONAL_ISOLATE;
+        }
+        else
+        {
+            m_output += file;
+        }
+        m_output.append(number, numberLength);
+        column += len;
+    }
+    EndLine();
+}
+
+
+void POWriter::WritePrevious(const Entry& entry, const FlagsInfo& flags, bool obsolete)
+{
+    if (entry.previous.empty())
+        return;
+
+    const char *prefix = obsolete ? "#~| " : "#| ";
+
+    PreviousMsgid prev;
+    if (!ParsePrevious(entry.previous, prev))
+    {
+        for (auto& ln: entry.previous)
+            WriteLine(prefix, ln);
+        return;
+    }
+
+    if (prev.hasContext)
+        WriteString(prefix, "msgctxt", prev.context, flags);
+    if (prev.hasMsgid)
+        WriteString(prefix, "msgid", prev.msgid, flags);
+    if (prev.hasPlural)
+        WriteString(prefix, "msgid_plural", prev.plural, flags);
+}
+
+
+void POWriter::WriteMessageFields(const Entry& entry, const FlagsInfo& flags, bool obsolete)
+{
+    const char *prefix = obsolete ? "#~ " : nullptr;
+    static const std::string empty;
+
+    if (entry.hasContext)
+        WriteString(prefix, "msgctxt", entry.context, flags);
+    WriteString(prefix, "msgid", entry.msgid, flags);
+
+    if (entry.hasPlural)
+    {
+        WriteString(prefix, "msgid_plural", entry.msgidPlural, flags);
+        const size_t count = std::max(entry.translations.size(), size_t(1));
+        for (size_t i = 0; i < count; i++)
+        {
+            WriteString(prefix, "msgstr[" + std::to_string(i) + "]",
+                        i < entry.translations.size() ? entry.translations[i] : empty,
+                        flags);
+        }
+    }
+    else
+    {
+        WriteString(prefix, "msgstr", entry.translations.empty() ? empty : entry.translations.front(), flags);
+    }
+}
+
+
+void POWriter::WriteString(const char *prefix, const std::string& name, const std::string& value, const FlagsInfo& flags)
+{
+    const int prefixLen = prefix ? (int)strlen(prefix) : 0;
+
+    // reuse buffers to avoid allocations for every string written:
+    auto& directives = m_directives;
+    auto& portion = m_portion;
+    auto& overrides = m_overrides;
+    auto& breaks = m_breaks;
+
+    // don't break lines inside format directives:
+    directives.clear();
+    switch (flags.syntax)
+    {
+        case DirectiveSyntax::Printf:
+        case DirectiveSyntax::PythonPrintf:
+            directives.resize(value.length(), DIRECTIVE_NONE);
+            FindPrintfDirectives(value, flags.syntax == DirectiveSyntax::PythonPrintf, directives);
+            break;
+        case DirectiveSyntax::Brace:
+            directives.resize(value.length(), DIRECTIVE_NONE);
+            FindBraceDirectives(value, directives);
+            break;
+        case DirectiveSyntax::None:
+            break;
+    }
+
+    // Continuation lines start after the prefix and opening quote; the width
+    // leaves room for the closing quote. Columns are relative to that start:
+    const int startColumnAfterBreak = prefixLen + 1;
+    const int width = (m_wrap && !flags.noWrap ? m_pageWidth : INT_MAX) - 1 - startColumnAfterBreak;
+
+    const size_t len = value.length();
+    size_t pos = 0;
+    bool firstLine = true;
+    do
+    {
+        // process the value in portions delimited by \n:
+        size_t end = value.find('\n', pos);
+        end = (end == std::string::npos) ? len : end + 1;
+
+        portion.clear();
+        overrides.clear();
+        for (size_t i = pos; i < end; i++)
+        {
+            const char c = value[i];
+            const char brk = (!directives.empty() && directives[i] == DIRECTIVE_INSIDE) ? BREAK_PROHIBITED : BREAK_UNDEFINED;
+
+            char escaped = 0;
+            switch (c)
+            {
+                case '"':  escaped = '"'; break;
+                case '\\': escaped = '\\'; break;
+                case '\b': escaped = 'b'; break;
+                case '\f': escaped = 'f'; break;
+                case '\n': escaped = 'n'; break;
+                case '\r': escaped = 'r'; break;
+                case '\t': escaped = 't'; break;
+                default: break;
+            }
+
+            if (escaped)
+            {
+                portion += '\\';
+                portion += escaped;
+                overrides += brk;
+                overrides += BREAK_PROHIBITED;
+            }
+            else
+            {
+                portion += c;
+                overrides += brk;
+            }
+        }
+
+        // don't break immediately before the \n at the end:
+        if (end > pos && value[end - 1] == '\n')
+            overrides[portion.length() - 2] = BREAK_PROHIBITED;
+
+        breaks.resize(portion.length());
+
+        int startColumn;
+        for (;;)
+        {
+            startColumn = prefixLen + (firstLine ? (int)name.length() + 1 : 0) + 1 - startColumnAfterBreak;
+            GetWidthLineBreaks(portion.data(), portion.length(), width, startColumn, overrides.data(), m_cjk, breaks.data());
+
+            // If the string is going to be wrapped, put it on separate lines,
+            // starting with an empty string on the first one:
+            if (firstLine && !portion.empty() &&
+                (end < len || startColumn > width || std::find(breaks.begin(), breaks.end(), BREAK_POSSIBLE) != breaks.end()))
+            {
+                if (prefix)
+                    m_output += prefix;
+                m_output += name;
+                m_output += " \"\"";
+                EndLine();
+                firstLine = false;
+                continue;
+            }
+            break;
+        }
+
+        // write the lines directly to the output, in runs between breaks:
+        if (prefix)
+            m_output += prefix;
+        if (firstLine)
+        {
+            m_output += name;
+            m_output += ' ';
+        }
+        m_output += '"';
+        size_t runStart = 0;
+        for (size_t i = 0; i < portion.length(); i++)
+        {
+            if (breaks[i] == BREAK_POSSIBLE)
+            {
+                m_output.append(portion, runStart, i - runStart);
+                m_output += '"';
+                EndLine();
+                if (prefix)
+                    m_output += prefix;
+                m_output += '"';
+                runStart = i;
+            }
+        }
+        m_output.append(portion, runStart, std::string::npos);
+        m_output += '"';
+        EndLine();
+
+        pos = end;
+        firstLine = false;
+    }
+    while (pos < len);
+}
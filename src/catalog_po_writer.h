@@ -0,0 +1,173 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef Poedit_catalog_po_writer_h
+#define Poedit_catalog_po_writer_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/**
+    Writer of PO files' content.
+
+    Formats messages exactly the way GNU gettext's tools (msgcat, msgmerge)
+    do, including their line wrapping, so that files saved by Poedit don't
+    need to be reformatted with msgcat afterwards and produce minimal diffs
+    against files maintained with gettext tools.
+
+    All strings are UTF-8 encoded and unescaped. Output is UTF-8 too, it's
+    up to the caller to convert it into file's charset if needed.
+ */
+class POWriter
+{
+public:
+    /// Single message to write.
+    struct Entry
+    {
+        /// Translator comments (without the leading "# ")
+        std::vector<std::string> comments;
+        /// Extracted comments (without the leading "#. ")
+        std::vector<std::string> extractedComments;
+        /// References lines as stored in the file (without the leading "#: ")
+        std::vector<std::string> references;
+        /// Flags in the ", fuzzy, c-format" form used by CatalogItem
+        std::string flags;
+        /// Raw "#|" lines with previous msgid (without the leading "#| ")
+        std::vector<std::string> previous;
+
+        bool hasContext = false;
+        std::string context;
+        std::string msgid;
+        bool hasPlural = false;
+        std::string msgidPlural;
+        std::vector<std::string> translations;
+
+        /**
+            Adds comments in raw form, i.e. lines starting with "#", as stored
+            in CatalogItem or in header's comment.
+
+            Translator comments, extracted comments, references, flags and
+            previous msgid lines are sorted into the appropriate fields.
+         */
+        void AddRawComments(const std::string& text);
+
+        /// Clears all fields, keeping the capacity of scalar strings and of
+        /// the vectors (but not of their elements) for reuse.
+        void Clear();
+    };
+
+    /**
+        Creates the writer.
+
+        @param output   Buffer to append the output to.
+        @param wrapping Wrapping width; 0 or negative value disables wrapping.
+        @param charset  Charset the output will be converted to; affects
+                        wrapping in some legacy East Asian encodings.
+        @param crlf     Use DOS line endings instead of Unix ones.
+     */
+    POWriter(std::string& output, int wrapping, const std::string& charset, bool crlf);
+    ~POWriter();
+
+    POWriter(const POWriter&) = delete;
+    POWriter& operator=(const POWriter&) = delete;
+
+    /// Writes a message; returns 1-based line number of its first line.
+    int Write(const Entry& entry);
+
+    /**
+        Writes an obsolete (#~) message.
+
+        Obsolete messages are stored in raw form, with all "#~" lines
+        verbatim, and are reformatted as well if they can be parsed. @a entry
+        contains the message's comments and flags, the remaining fields are
+        ignored.
+
+        Poedit's parser may split a single obsolete message into several
+        items, this is accounted for and they are merged back together.
+        Obsolete messages must come after all normal messages.
+
+        @return 1-based line number of the message's first line.
+     */
+    int WriteObsolete(const Entry& entry, const std::vector<std::string>& lines);
+
+    /**
+        Writes a message's original text verbatim.
+
+        This is used for messages that weren't modified since they were
+        loaded, to preserve their formatting exactly. @a text must be UTF-8
+        and include all of message's lines; the line ending of the last one
+        is added if missing.
+
+        @param continuation Don't separate the text from the previous one with
+                            an empty line, because it continues it (used for
+                            obsolete messages split by Poedit's parser).
+
+        @return 1-based line number of the message's first line.
+     */
+    int WriteVerbatim(const char *text, size_t length, bool continuation = false);
+
+    /// Finishes writing, must be called after writing the last message.
+    void Finish();
+
+    /// Returns number of lines written so far.
+    int GetLinesCount() const { return m_lines; }
+
+private:
+    struct FlagsInfo;
+    struct ObsoleteMessage;
+    struct ReferencesBuffer;
+
+    void BeginMessage();
+    void EndLine();
+    void WriteLine(const std::string& line);
+    void WriteLine(const char *prefix, const std::string& text);
+    void WriteComments(const Entry& entry, const FlagsInfo& flags, bool obsolete);
+    void WriteReferences(const std::vector<std::string>& references);
+    void WritePrevious(const Entry& entry, const FlagsInfo& flags, bool obsolete);
+    void WriteMessageFields(const Entry& entry, const FlagsInfo& flags, bool obsolete);
+    void WriteString(const char *prefix, const std::string& name, const std::string& value, const FlagsInfo& flags);
+    void FlushObsolete();
+
+    std::string& m_output;
+    const char *m_eol;
+    int m_pageWidth;
+    bool m_wrap;
+    bool m_cjk;
+    bool m_utf8;
+
+    int m_lines;
+    bool m_empty;
+
+    std::unique_ptr<ObsoleteMessage> m_obsolete;
+
+    // scratch buffers used by WriteString() and WriteReferences()
+    std::string m_portion, m_overrides;
+    std::vector<char> m_breaks, m_directives;
+    std::unique_ptr<ReferencesBuffer> m_referencesBuffer;
+};
+
+#endif // Poedit_catalog_po_writer_h
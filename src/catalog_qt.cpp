@@ -404,3 +404,58 @@ void QtLinguistCatalog::RemoveDeletedItems()
 
     m_hasDeletedItems = false;
 }
+
+
+void QtLinguistCatalog::AddObsoleteItems(const Catalog& catalog, const CatalogItemArray& items)
+{
+    std::lock_guard<std::mutex> lock(m_documentMutex);
+
+    for (auto& item: items)
+    {
+        auto qtitem = dynamic_cast<const QtLinguistCatalogItem*>(item.get());
+        if (qtitem)
+            AddObsoleteMessage(qtitem->m_node);
+    }
+
+    // messages that were already obsolete are kept too, as lupdate does:
+    auto qtcatalog = dynamic_cast<const QtLinguistCatalog*>(&catalog);
+    if (qtcatalog && qtcatalog->m_hasDeletedItems)
+    {
+        const auto xpath_query = "//message[translation[@type='vanished' or @type='obsolete']]";
+        for (auto& x: qtcatalog->m_doc.select_nodes(xpath_query))
+            AddObsoleteMessage(x.node());
+    }
+}
+
+
+void QtLinguistCatalog::AddObsoleteMessage(pugi::xml_node message)
+{
+    // put the message into context with the same name, creating it if needed:
+    auto root = GetXMLRoot();
+    auto parent = root;
+    auto oldContext = message.parent();
+    if (strcmp(oldContext.name(), "context") == 0)
+    {
+        auto name = oldContext.child("name").text().get();
+        parent = root.find_child([=](xml_node n){ return strcmp(n.name(), "context") == 0 && strcmp(n.child("name").text().get(), name) == 0; });
+        if (!parent)
+        {
+            parent = root.append_child("context");
+            parent.append_child("name").text() = name;
+        }
+    }
+
+    // indent the message in the same way as in the original file:
+    auto ws_before = message.previous_sibling();
+    if (ws_before.type() == node_pcdata && is_whitespace_only(ws_before))
+        parent.append_copy(ws_before);
+
+    auto copy = parent.append_copy(message);
+    auto translation = copy.child("translation");
+    if (!translation)
+        translation = copy.append_child("translation");
+    if (strcmp(translation.attribute("type").value(), "obsolete") != 0)
+        attribute(translation, "type") = "vanished";
+
+    m_hasDeletedItems = true;
+}
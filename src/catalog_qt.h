@@ -73,6 +73,8 @@ protected:
     QtLinguistCatalog& m_owner;
     pugi::xml_node m_node;
     wxString m_symbolicId;
+
+    friend class QtLinguistCatalog;
 };
 
 
@@ -113,6 +115,9 @@ protected:
     void Parse(pugi::xml_node root);
     void ParseSubtree(int& id, pugi::xml_node root, const wxString& context);
 
+    void AddObsoleteItems(const Catalog& catalog, const CatalogItemArray& items) override;
+    void AddObsoleteMessage(pugi::xml_node message);
+
 protected:
     std::mutex m_documentMutex;
     pugi::xml_document m_doc;
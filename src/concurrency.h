@@ -71,10 +71,15 @@
     #endif
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <exception>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 #include <wx/app.h>
 #include <wx/weakref.h>
@@ -638,6 +643,86 @@ inline auto async(F&& f) -> future<typename detail::future_unwrapper<typename st
 }
 
 
+/**
+    Runs @a f(i) for every i in [0, count) on the background queue, using at
+    most @a maxWorkers concurrent tasks, and waits until all of them finish.
+
+    The calling thread does its share of the work too and only waits for the
+    helper tasks that actually started running; those still in the queue once
+    all work was claimed do nothing. This can therefore be safely used from
+    background tasks, even if all of the queue's threads are busy. If @a f
+    throws, no further calls are started and the first exception is rethrown
+    once the running ones finish.
+ */
+template<class F>
+inline void parallel_for(size_t count, unsigned maxWorkers, const F& f)
+{
+    // Shared with the helper tasks, because they may outlive this call if
+    // they didn't get to run before it returned:
+    struct State
+    {
+        std::atomic<size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        unsigned running = 0;
+        bool done = false;
+        std::exception_ptr error;
+
+        void run(size_t total, const F& func)
+        {
+            try
+            {
+                for (size_t i = next++; i < total; i = next++)
+                    func(i);
+            }
+            catch (...)
+            {
+                next = total;
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+    };
+    auto state = std::make_shared<State>();
+
+    const size_t workers = std::min(count, (size_t)std::max(maxWorkers, 1u));
+    for (size_t w = 1; w < workers; w++)
+    {
+        async([state, count, fn = &f]
+        {
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->done)
+                    return;  // all work was already claimed, *fn may be gone
+                state->running++;
+            }
+            state->run(count, *fn);
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->running--;
+            }
+            state->finished.notify_all();
+        });
+    }
+
+    state->run(count, f);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done = true;
+    state->finished.wait(lock, [&]{ return state->running == 0; });
+
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+/// Default number of workers for parallel_for()
+inline unsigned default_parallelism()
+{
+    return std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+}
+
+
 /// Run an operation on the main thread.
 template<class F>
 inline auto on_main(F&& f) -> future<typename detail::future_unwrapper<typename std::invoke_result<F>::type>::type>
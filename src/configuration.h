@@ -70,6 +70,10 @@ public:
     static bool ShowWarnings() { return Read("/show_warnings", true); }
     static void ShowWarnings(bool show) { Write("/show_warnings", show); }
 
+    // Keep strings extracted from source code up to date in the background
+    static bool UpdateFromSourcesInBackground() { return Read("/update_from_sources_in_background", false); }
+    static void UpdateFromSourcesInBackground(bool use) { Write("/update_from_sources_in_background", use); }
+
     static std::string CloudLastProject() { return Read("/cloud_last_project", std::string()); }
     static void CloudLastProject(const std::string& prj) { return Write("/cloud_last_project", prj); }
 
@@ -79,6 +79,7 @@
 #endif
 
 #include "app_updates.h"
+#include "catalog_po_cache.h"
 #include "colorscheme.h"
 #include "concurrency.h"
 #include "configuration.h"
@@ -87,6 +88,7 @@
 #include "localazy_client.h"
 #include "edapp.h"
 #include "edframe.h"
+#include "extractors/extraction_cache.h"
 #include "extractors/extractor_legacy.h"
 #include "filemonitor.h"
 #include "manager.h"
@@ -447,6 +449,10 @@ bool PoeditApp::OnInit()
 
     SetupLanguage();
 
+    // Speed up reopening of large files:
+    POCatalogCache::Enable(GetCacheDir("Catalogs"));
+    ExtractionCache::Enable(GetCacheDir("Extraction"));
+
 #ifdef __WXOSX__
     CreateMenu(Menu::Global);
     // so that help menu is correctly merged with system-provided menu
@@ -740,6 +740,10 @@ PoeditFrame::~PoeditFrame()
 {
     ms_instances.erase(this);
 
+    // don't exit while the file is still being written in the background:
+    if (m_runningSave)
+        m_runningSave->job->Wait();
+
     // don't leave file references window as the only one open:
     if (ms_instances.empty() && FileViewer::GetIfExists())
         FileViewer::GetIfExists()->Close();
@@ -756,6 +760,7 @@ PoeditFrame::~PoeditFrame()
     // write all changes:
     cfg->Flush();
 
+    m_backgroundUpdater.reset();
     m_catalog.reset();
     m_pendingHumanEditedItem.reset();
     m_navigationHistory.clear();
@@ -918,7 +923,8 @@ CatalogPtr PoeditFrame::PreOpenFileWithErrorsUI(const wxString& filename, wxWind
 
     try
     {
-        return Catalog::Create(filename);
+        // ReadCatalog() validates the catalog right away, so the cache can be used:
+        return Catalog::Create(filename, Catalog::CreationFlag_UseCache);
     }
     catch (...)
     {
@@ -999,6 +1005,9 @@ template<typename TFunctor1, typename TFunctor2>
 void PoeditFrame::DoIfCanDiscardCurrentDoc(const TFunctor1& completionHandler, const TFunctor2
 & failureHandler)
 {
+    // the document isn't saved until the background save finishes:
+    CompleteBackgroundSave();
+
     if ( !NeedsToAskIfCanDiscardCurrentDoc() )
     {
         completionHandler();
@@ -1089,6 +1098,9 @@ wxWindowPtr<wxMessageDialog> PoeditFrame::CreateAskAboutSavingDialog()
 
 void PoeditFrame::OnCloseWindow(wxCloseEvent& event)
 {
+    // don't lose errors of the save running in the background:
+    CompleteBackgroundSave();
+
     if (event.CanVeto() && NeedsToAskIfCanDiscardCurrentDoc())
     {
 #ifdef __WXOSX__
@@ -1482,6 +1494,7 @@ void PoeditFrame::EditCatalogProperties()
                 UpdateEditingUIAfterChange();
                 UpdateTitle();
                 UpdateMenu();
+                UpdateBackgroundUpdater();
                 if (prevLang != m_catalog->GetLanguage())
                 {
                     UpdateTextLanguage();
@@ -1542,6 +1555,7 @@ void PoeditFrame::EditCatalogPropertiesAndUpdateFromSources()
                 UpdateEditingUIAfterChange();
             UpdateTitle();
             UpdateMenu();
+            UpdateBackgroundUpdater();
             if (prevLang != m_catalog->GetLanguage())
             {
                 UpdateTextLanguage();
@@ -1564,6 +1578,8 @@ void PoeditFrame::UpdateAfterPreferencesChange()
     g_focusToText = (bool)wxConfig::Get()->Read("focus_to_text",
                                                  (long)false);
 
+    UpdateBackgroundUpdater();
+
     if (m_list)
     {
         SetCustomFonts();
@@ -1615,7 +1631,12 @@ void PoeditFrame::UpdateCatalog(const wxString& pot_file)
             return;
         }
 
-        bg_work = PerformUpdateFromSourcesWithUI(this, cat);
+        // use strings extracted in the background, if they are up to date:
+        std::shared_ptr<BackgroundSourcesUpdater::Result> prepared;
+        if (m_backgroundUpdater && m_backgroundUpdater->IsFor(cat))
+            prepared = m_backgroundUpdater->TakeResult();
+
+        bg_work = PerformUpdateFromSourcesWithUI(this, cat, prepared);
     }
     else
     {
@@ -1630,6 +1651,9 @@ void PoeditFrame::UpdateCatalog(const wxString& pot_file)
         m_catalog = updated_catalog;
         m_modified = true;
 
+        // pending changes were just merged, start over with the updated catalog:
+        m_backgroundUpdater.reset();
+
         EnsureAppropriateContentView();
         NotifyCatalogChanged(m_catalog);
         RefreshControls();
@@ -1708,6 +1732,14 @@ void PoeditFrame::OnUpdateFromPOTUpdate(wxUpdateUIEvent& event)
             event.SetText(MSW_OR_OTHER(_(L"Update from &POT file…"), _(L"Update from &POT File…")));
             break;
 
+        case Catalog::Type::XLIFF:
+        case Catalog::Type::JSON:
+        case Catalog::Type::JSON_FLUTTER:
+        case Catalog::Type::RESX:
+        case Catalog::Type::QT_LINGUIST:
+            event.SetText(MSW_OR_OTHER(_(L"Update from &reference file…"), _(L"Update from &Reference File…")));
+            break;
+
         default:
             event.Enable(false);
             break;
@@ -2244,10 +2276,7 @@ void PoeditFrame::ReadCatalog(const CatalogPtr& cat)
 #ifdef __WXMSW__
         wxWindowUpdateLocker no_updates(this);
 #endif
-        {
-            // the file was just loaded, it is identical to in-memory content and we can pass `fileWithSameContent`
-            cat->Validate(/*fileWithSameContent=*/cat->GetFileName());
-        }
+        cat->Validate();
 
         m_catalog = cat;
         m_fileMonitor->SetFile(m_catalog->GetFileName());
@@ -2591,6 +2620,8 @@ void PoeditFrame::NotifyCatalogChanged(const CatalogPtr& cat)
         m_sidebar->ResetCatalog();
     if (m_list)
         m_list->CatalogChanged(cat);
+
+    UpdateBackgroundUpdater();
 }
 
 
@@ -2640,6 +2671,17 @@ void PoeditFrame::UpdateStatusBar()
             text.Printf(wxPLURAL("%d entry", "%d entries", all), all);
         }
 
+        if (m_backgroundUpdater)
+        {
+            auto pending = m_backgroundUpdater->GetPendingChanges();
+            if (pending && pending->changes_count() > 0)
+            {
+                text += L"  •  ";
+                // TRANSLATORS: Shown in the status bar if source code changed since the file was last updated from it
+                text += wxString::Format(_("Source code changes: %d new, %d removed"), (int)pending->added.size(), (int)pending->removed.size());
+            }
+        }
+
         bar->SetStatusText(text, 1);
 
         auto width = bar->GetTextExtent(text).x + PX(8);
@@ -2649,6 +2691,30 @@ void PoeditFrame::UpdateStatusBar()
 }
 
 
+void PoeditFrame::UpdateBackgroundUpdater()
+{
+    const bool enable = Config::UpdateFromSourcesInBackground() &&
+                        m_catalog &&
+                        m_catalog->GetFileType() == Catalog::Type::PO &&
+                        m_catalog->HasSourcesAvailable();
+    if (!enable)
+    {
+        if (m_backgroundUpdater)
+        {
+            m_backgroundUpdater.reset();
+            UpdateStatusBar();
+        }
+        return;
+    }
+
+    if (m_backgroundUpdater && m_backgroundUpdater->IsFor(m_catalog))
+        return;
+
+    m_backgroundUpdater = BackgroundSourcesUpdater::Create(m_catalog, [this]{ UpdateStatusBar(); });
+    UpdateStatusBar();
+}
+
+
 void PoeditFrame::UpdateTitle()
 {
 #ifdef __WXOSX__
@@ -2779,28 +2845,50 @@ void PoeditFrame::WriteCatalog(const wxString& catalog)
 template<typename TFunctor>
 void PoeditFrame::WriteCatalog(const wxString& catalog, TFunctor completionHandler)
 {
-    wxBusyCursor bcur;
+    DoWriteCatalog(catalog, completionHandler);
+}
 
-    dispatch::future<void> tmUpdateThread;
-    if (Config::UseTM() && m_catalog->HasCapability(Catalog::Cap::Translations))
+
+namespace
+{
+
+// Commit pending writes made in OnNewTranslationEntered():
+void CommitTranslationMemory()
+{
+    try
     {
-        tmUpdateThread = dispatch::async([=]{
-            try
-            {
-                // Commit pending writes made in OnNewTranslationEntered():
-                auto tm = TranslationMemory::Get().GetWriter();
-                tm->Commit();
-            }
-            catch ( const Exception& e )
-            {
-                wxLogWarning(_("Failed to update translation memory: %s"), e.What());
-            }
-            catch ( ... )
-            {
-                wxLogWarning(_("Failed to update translation memory: %s"), "unknown error");
-            }
-        });
+        auto tm = TranslationMemory::Get().GetWriter();
+        tm->Commit();
     }
+    catch ( const Exception& e )
+    {
+        wxLogWarning(_("Failed to update translation memory: %s"), e.What());
+    }
+    catch ( ... )
+    {
+        wxLogWarning(_("Failed to update translation memory: %s"), "unknown error");
+    }
+}
+
+} // anonymous namespace
+
+
+void PoeditFrame::DoWriteCatalog(const wxString& catalog, std::function<void(bool)> completionHandler)
+{
+    // PO files are saved in the background. Saves requested while one is
+    // running are coalesced into a single one, done after it finishes:
+    if (m_runningSave)
+    {
+        if (!m_queuedSave)
+            m_queuedSave.reset(new QueuedSave);
+        m_queuedSave->filename = catalog;
+        m_queuedSave->completionHandlers.push_back(completionHandler);
+        return;
+    }
+
+    wxBusyCursor bcur;
+
+    const bool updateTM = Config::UseTM() && m_catalog->HasCapability(Catalog::Cap::Translations);
 
     if (m_catalog->GetFileType() == Catalog::Type::PO)
     {
@@ -2809,6 +2897,69 @@ void PoeditFrame::WriteCatalog(const wxString& catalog, TFunctor completionHandl
         dt.TranslatorEmail = wxConfig::Get()->Read("translator_email", dt.TranslatorEmail);
     }
 
+    // Sync destination must be determined now, callers may change it after
+    // starting the save (see CloudSyncWithCrowdin()):
+    auto cloudSync = m_catalog->GetCloudSync();
+
+    auto poCatalog = std::dynamic_pointer_cast<POCatalog>(m_catalog);
+    if (poCatalog && !poCatalog->HasSideloadedReferenceFile())
+    {
+        // Take a snapshot of the catalog on the main thread, then write it,
+        // validate it and compile it in the background:
+        std::shared_ptr<POCatalog::SaveJob> job;
+        try
+        {
+            job = poCatalog->PrepareSave(catalog, true);
+        }
+        catch (...)
+        {
+            ShowSaveErrorDialog(catalog);
+        }
+
+        if (!job)
+        {
+            completionHandler(false);
+            return;
+        }
+
+        m_runningSave.reset(new RunningSave);
+        m_runningSave->job = job;
+        m_runningSave->catalog = poCatalog;
+        m_runningSave->filename = catalog;
+        m_runningSave->cloudSync = cloudSync;
+        m_runningSave->completionHandler = completionHandler;
+        m_runningSave->guard.reset(new FileMonitor::WritingGuard(*m_fileMonitor));
+
+        // Edits made from now on aren't part of the saved snapshot and will
+        // make the document modified again. Closing the document waits for
+        // the save to finish (see CompleteBackgroundSave()), so that the
+        // modified state is restored and reported if the save fails:
+        m_runningSave->wasModified = m_modified;
+        m_modified = false;
+        UpdateTitle();
+
+        // FinishBackgroundSave() waits for the TM update too:
+        if (updateTM)
+            m_runningSave->tmUpdate = dispatch::async([]{ CommitTranslationMemory(); });
+
+        dispatch::async([=]
+        {
+            return job->Run();
+        })
+        .then_on_window(this, [=](POCatalog::SaveJob::Results)
+        {
+            // the save may have been finished synchronously already:
+            if (m_runningSave && m_runningSave->job == job)
+                FinishBackgroundSave();
+        });
+
+        return;
+    }
+
+    dispatch::future<void> tmUpdateThread;
+    if (updateTM)
+        tmUpdateThread = dispatch::async([]{ CommitTranslationMemory(); });
+
     FileMonitor::WritingGuard guard(*m_fileMonitor);
 
     Catalog::ValidationResults validation_results;
@@ -2822,29 +2973,100 @@ void PoeditFrame::WriteCatalog(const wxString& catalog, TFunctor completionHandl
     catch (...)
     {
         was_ok = false;
-        wxMessageDialog dlg
-        (
-            this,
-            wxString::Format(_(L"The file “%s” couldn’t be saved."), wxFileName(catalog).GetFullName()),
-            _("Error saving file"),
-            wxOK | wxICON_ERROR
-        );
-        dlg.SetExtendedMessage(DescribeCurrentException());
-        dlg.ShowModal();
+        ShowSaveErrorDialog(catalog);
     }
 
-    if (!was_ok)
+    if (tmUpdateThread.valid())
+        tmUpdateThread.wait();
+
+    if (was_ok)
+        m_modified = false;
+
+    FinishWriteCatalog(catalog, was_ok, validation_results, mo_compilation_status, cloudSync, completionHandler);
+}
+
+
+void PoeditFrame::FinishBackgroundSave()
+{
+    std::unique_ptr<RunningSave> save;
+    save.swap(m_runningSave);
+
+    save->job->Wait();
+    if (save->tmUpdate.valid())
+        save->tmUpdate.wait();
+    auto& results = save->job->GetResults();
+
+    if (results.saved)
+    {
+        if (m_catalog == save->catalog)
+            save->job->ApplyResults(*save->catalog, results);
+    }
+    else
+    {
+        m_modified = m_modified || save->wasModified;
+    }
+
+    FinishWriteCatalog(save->filename, results.saved, results.validation, results.moCompilationStatus, save->cloudSync, save->completionHandler);
+    save->guard.reset();
+
+    if (m_queuedSave)
     {
-        if (tmUpdateThread.valid())
-            tmUpdateThread.wait();
+        std::unique_ptr<QueuedSave> queued;
+        queued.swap(m_queuedSave);
+        auto handlers = queued->completionHandlers;
+        DoWriteCatalog(queued->filename, [handlers](bool saved){
+            for (auto& h: handlers)
+                h(saved);
+        });
+    }
+}
+
+
+void PoeditFrame::CompleteBackgroundSave()
+{
+    // finishing the save may start a queued one, which must be waited for too:
+    while (m_runningSave)
+    {
+        wxBusyCursor bcur;
+        m_runningSave->job->Wait();
+        FinishBackgroundSave();
+    }
+}
+
+
+void PoeditFrame::ShowSaveErrorDialog(const wxString& catalog)
+{
+    wxMessageDialog dlg
+    (
+        this,
+        wxString::Format(_(L"The file “%s” couldn’t be saved."), wxFileName(catalog).GetFullName()),
+        _("Error saving file"),
+        wxOK | wxICON_ERROR
+    );
+    dlg.SetExtendedMessage(DescribeCurrentException());
+    dlg.ShowModal();
+}
+
+
+void PoeditFrame::FinishWriteCatalog(const wxString& catalog,
+                                     bool saved,
+                                     Catalog::ValidationResults validation_results,
+                                     Catalog::CompilationStatus mo_compilation_status,
+                                     std::shared_ptr<CloudSyncDestination> cloudSync,
+                                     std::function<void(bool)> completionHandler)
+{
+    if (!saved)
+    {
+        UpdateTitle();
         completionHandler(false);
         return;
     }
 
     m_catalog->SetFileName(catalog);
-    m_modified = false;
     m_fileExistsOnDisk = true;
     m_fileMonitor->SetFile(m_catalog->GetFileName());
+    // sources are relative to the file, which may have been saved elsewhere:
+    UpdateBackgroundUpdater();
 
     UpdateTitle();
 
@@ -2855,14 +3077,11 @@ void PoeditFrame::WriteCatalog(const wxString& catalog, TFunctor completionHandl
     if (ManagerFrame::Get())
         ManagerFrame::Get()->NotifyFileChanged(GetFileName());
 
-    if (m_catalog->GetCloudSync())
+    if (cloudSync)
     {
-        CloudSyncProgressWindow::RunSync(this, m_catalog->GetCloudSync(), m_catalog);
+        CloudSyncProgressWindow::RunSync(this, cloudSync, m_catalog);
     }
 
-    if (tmUpdateThread.valid())
-        tmUpdateThread.wait();
-
     if (m_list && m_list->sortOrder().errorsFirst)
         m_list->Sort();
 
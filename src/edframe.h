@@ -26,6 +26,7 @@
 #ifndef _EDFRAME_H_
 #define _EDFRAME_H_
 
+#include <functional>
 #include <memory>
 #include <set>
 
@@ -39,6 +40,7 @@ class WXDLLIMPEXP_FWD_CORE wxSplitterEvent;
 
 #include "catalog.h"
 #include "catalog_po.h"
+#include "concurrency.h"
 #include "gexecute.h"
 #include "edlistctrl.h"
 #include "edapp.h"
@@ -58,6 +60,7 @@ class FindFrame;
 class MainToolbar;
 class Sidebar;
 class EditingArea;
+class BackgroundSourcesUpdater;
 
 /** This class provides main editing frame. It handles user's input
     and provides frontend to catalog editing engine. Nothing fancy.
@@ -219,6 +222,8 @@ class PoeditFrame : public PoeditFrameBase
 
         /// Updates statistics in statusbar.
         void UpdateStatusBar();
+        /// Starts or stops updating from sources in the background, as configured.
+        void UpdateBackgroundUpdater();
         void InitStatusBar();
         /// Updates frame title.
         void UpdateTitle();
@@ -263,6 +268,18 @@ private:
         template<typename F>
         void GetSaveAsFilenameThenDo(const CatalogPtr& cat, F then);
         void DoSaveAs(const wxString& filename);
+        void DoWriteCatalog(const wxString& catalog, std::function<void(bool)> completionHandler);
+        void FinishWriteCatalog(const wxString& catalog,
+                                bool saved,
+                                Catalog::ValidationResults validation_results,
+                                Catalog::CompilationStatus mo_compilation_status,
+                                std::shared_ptr<CloudSyncDestination> cloudSync,
+                                std::function<void(bool)> completionHandler);
+        void ShowSaveErrorDialog(const wxString& catalog);
+        /// Handles results of the save running in the background once it's done
+        void FinishBackgroundSave();
+        /// Waits for the background save (if any) and finishes it right away
+        void CompleteBackgroundSave();
         void OnEditProperties(wxCommandEvent& event);
         void OnUpdateEditProperties(wxUpdateUIEvent& event);
 
@@ -362,6 +379,31 @@ private:
         std::unique_ptr<FileMonitor> m_fileMonitor;
         bool m_fileExistsOnDisk;
 
+        // Strings extracted from source code in the background, if enabled
+        std::shared_ptr<BackgroundSourcesUpdater> m_backgroundUpdater;
+
+        // Saving running in the background, see DoWriteCatalog()
+        struct RunningSave
+        {
+            std::shared_ptr<POCatalog::SaveJob> job;
+            POCatalogPtr catalog;
+            wxString filename;
+            bool wasModified;
+            std::shared_ptr<CloudSyncDestination> cloudSync;
+            std::function<void(bool)> completionHandler;
+            std::unique_ptr<FileMonitor::WritingGuard> guard;
+            dispatch::future<void> tmUpdate;
+        };
+        std::unique_ptr<RunningSave> m_runningSave;
+
+        // Save requested while another one was running, done after it finishes
+        struct QueuedSave
+        {
+            wxString filename;
+            std::vector<std::function<void(bool)>> completionHandlers;
+        };
+        std::unique_ptr<QueuedSave> m_queuedSave;
+
         wxString m_fileNamePartOfTitle;
 
         std::unique_ptr<MainToolbar> m_toolbar;
@@ -0,0 +1,440 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "extraction_cache.h"
+
+#include "str_helpers.h"
+#include "utility.h"
+
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+
+
+namespace
+{
+
+// Identifies index files; increase whenever their format changes:
+const char INDEX_SIGNATURE[] = "POEDIT-EXTRACTION-INDEX 2";
+
+// Files modified this many seconds before the index was written (or later)
+// may have been modified again without changing their modification time,
+// whose resolution is too coarse on some filesystems:
+const int64_t RACY_MTIME_WINDOW = 2;
+
+std::mutex gs_cacheMutex;
+wxString gs_cacheDir;
+
+
+inline uint64_t HashString(const wxString& s)
+{
+    const std::string utf8 = str::to_utf8(s);
+    return HashBytes(utf8.data(), utf8.size());
+}
+
+
+/// Writes @a data to @a filename atomically, returns false on failure.
+bool WriteFileAtomically(const wxString& filename, const std::string& data)
+{
+    const wxString tempname = filename + ".tmp";
+    {
+        wxFile f;
+        if (!f.Create(tempname, /*overwrite=*/true))
+            return false;
+        if (f.Write(data.data(), data.size()) != data.size() || !f.Close())
+        {
+            wxRemoveFile(tempname);
+            return false;
+        }
+    }
+    if (!wxRenameFile(tempname, filename, /*overwrite=*/true))
+    {
+        wxRemoveFile(tempname);
+        return false;
+    }
+    return true;
+}
+
+
+/// Copies extracted output @a pot into the cache as @a output.
+bool CopyOutput(const wxString& pot, const wxString& output)
+{
+    const wxString tempname = output + ".tmp";
+    if (!wxCopyFile(pot, tempname, /*overwrite=*/true))
+        return false;
+    if (!wxRenameFile(tempname, output, /*overwrite=*/true))
+    {
+        wxRemoveFile(tempname);
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+
+void ExtractionCache::Enable(const wxString& dir)
+{
+    std::lock_guard<std::mutex> lock(gs_cacheMutex);
+    gs_cacheDir = dir;
+}
+
+
+bool ExtractionCache::IsEnabled()
+{
+    std::lock_guard<std::mutex> lock(gs_cacheMutex);
+    return !gs_cacheDir.empty();
+}
+
+
+ExtractionCache::ExtractionCache(const wxString& basePath, const wxString& key)
+    : m_key(key), m_basePath(basePath)
+{
+    {
+        std::lock_guard<std::mutex> lock(gs_cacheMutex);
+        m_dir = gs_cacheDir;
+    }
+    if (m_dir.empty())
+        return;
+
+    wxLogNull nolog;
+    if (!wxFileName::DirExists(m_dir) && !wxFileName::Mkdir(m_dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL))
+    {
+        m_dir.clear();
+        return;
+    }
+
+    wxFileName absBasePath = wxFileName::DirName(basePath);
+    absBasePath.MakeAbsolute();
+    m_indexFile = m_dir + wxFILE_SEP_PATH
+                        + wxString::Format("%016llx.index", (unsigned long long)HashString(absBasePath.GetFullPath() + "\n" + key));
+    LoadIndex();
+}
+
+
+void ExtractionCache::LoadIndex()
+{
+    if (!wxFileExists(m_indexFile))
+        return;
+
+    wxStructStat st;
+    if (wxStat(m_indexFile, &st) != 0)
+        return;
+    m_indexTime = (int64_t)st.st_mtime;
+
+    MappedFile data;
+    if (!data.Open(m_indexFile))
+        return;
+
+    // The index is a text file with the signature on the first line and one
+    // line per file in "hash<TAB>size<TAB>mtime<TAB>group<TAB>path" format
+    // after it.
+    const char *p = data.begin();
+    const char *end = data.end();
+
+    auto nextLine = [&p, end]() -> std::string
+    {
+        const char *eol = std::find(p, end, '\n');
+        std::string line(p, eol);
+        p = (eol == end) ? end : eol + 1;
+        return line;
+    };
+
+    if (nextLine() != INDEX_SIGNATURE)
+    {
+        wxLogTrace("poedit.extractor", "ignoring incompatible extraction cache index %s", m_indexFile);
+        return;
+    }
+
+    while (p < end)
+    {
+        const std::string line = nextLine();
+        const char *s = line.c_str();
+        char *next;
+
+        Entry e;
+        e.hash = strtoull(s, &next, 16);
+        if (*next != '\t')
+            continue;
+        e.size = strtoull(next + 1, &next, 10);
+        if (*next != '\t')
+            continue;
+        e.mtime = strtoll(next + 1, &next, 10);
+        if (*next != '\t')
+            continue;
+        e.group = strtoull(next + 1, &next, 16);
+        if (*next != '\t' || next[1] == '\0')
+            continue;
+
+        m_index[str::to_wx(next + 1)] = e;
+    }
+
+    wxLogTrace("poedit.extractor", "loaded extraction cache index with %d files", (int)m_index.size());
+}
+
+
+wxString ExtractionCache::GetOutputFileName(const wxString& file, const Entry& entry) const
+{
+    if (entry.group)
+        return m_dir + wxFILE_SEP_PATH + wxString::Format("group-%016llx.pot", (unsigned long long)entry.group);
+
+    return m_dir + wxFILE_SEP_PATH
+                 + wxString::Format("%016llx-%016llx.pot",
+                                    (unsigned long long)HashString(m_key + "\n" + file),
+                                    (unsigned long long)entry.hash);
+}
+
+
+wxString ExtractionCache::Lookup(const wxString& file)
+{
+    if (m_dir.empty())
+        return wxString();
+
+    const wxString path = m_basePath + file;
+
+    wxStructStat st;
+    if (wxStat(path, &st) != 0)
+        return wxString();
+
+    Entry entry;
+    entry.size = (uint64_t)st.st_size;
+    entry.mtime = (int64_t)st.st_mtime;
+
+    Entry cached;
+    bool isCached = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto i = m_index.find(file);
+        if (i != m_index.end())
+        {
+            cached = i->second;
+            isCached = true;
+        }
+    }
+
+    const bool racy = isCached && cached.mtime + RACY_MTIME_WINDOW >= m_indexTime;
+    bool unchanged = isCached && !racy && cached.size == entry.size && cached.mtime == entry.mtime;
+    if (unchanged)
+    {
+        entry.hash = cached.hash;
+        entry.group = cached.group;
+    }
+    else
+    {
+        // The file may have been only touched, check its content too:
+        MappedFile data;
+        {
+            wxLogNull nolog;
+            if (!data.Open(path))
+                return wxString();
+        }
+        entry.hash = HashBytes(data.Data(), data.Size());
+        unchanged = isCached && cached.size == entry.size && cached.hash == entry.hash;
+        if (unchanged)
+            entry.group = cached.group;
+    }
+
+    if (unchanged)
+    {
+        auto output = GetOutputFileName(file, entry);
+        if (wxFileExists(output))
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // writing the index again makes the checked modification time
+            // safe to use next time:
+            if (entry.mtime != cached.mtime || racy)
+                m_modified = true;
+            m_current[file] = entry;
+            return output;
+        }
+    }
+
+    entry.group = 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending[file] = entry;
+    return wxString();
+}
+
+
+void ExtractionCache::Store(const wxString& file, const wxString& pot)
+{
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto i = m_pending.find(file);
+        if (i == m_pending.end())
+            return;
+        entry = i->second;
+    }
+
+    // Failure to write the cache isn't an error worth reporting, the file
+    // will be just extracted again next time:
+    wxLogNull nolog;
+    if (!CopyOutput(pot, GetOutputFileName(file, entry)))
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.erase(file);
+    m_current[file] = entry;
+    m_modified = true;
+}
+
+
+void ExtractionCache::StoreGroup(const std::vector<wxString>& files, const wxString& pot)
+{
+    std::vector<std::pair<wxString, Entry>> entries;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& f: files)
+        {
+            auto i = m_pending.find(f);
+            if (i == m_pending.end())
+                return;
+            entries.push_back(*i);
+        }
+    }
+    if (entries.empty())
+        return;
+
+    // Group's ID identifies the project, its files and their content, so that
+    // outputs of different groups never overwrite each other:
+    wxString groupKey(m_indexFile);
+    for (auto& e: entries)
+        groupKey += wxString::Format("\n%016llx\t", (unsigned long long)e.second.hash) + e.first;
+    const uint64_t group = std::max<uint64_t>(HashString(groupKey), 1);
+    for (auto& e: entries)
+        e.second.group = group;
+
+    wxLogNull nolog;
+    if (!CopyOutput(pot, GetOutputFileName(entries.front().first, entries.front().second)))
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& e: entries)
+    {
+        m_pending.erase(e.first);
+        m_current[e.first] = e.second;
+    }
+    m_modified = true;
+}
+
+
+std::set<wxString> ExtractionCache::ReleaseIncompleteGroups()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::map<uint64_t, size_t> groupSizes, unchangedCounts;
+    for (auto& i: m_index)
+    {
+        if (i.second.group)
+            groupSizes[i.second.group]++;
+    }
+    for (auto& i: m_current)
+    {
+        if (i.second.group)
+            unchangedCounts[i.second.group]++;
+    }
+
+    std::set<wxString> released;
+    for (auto i = m_current.begin(); i != m_current.end(); )
+    {
+        const auto group = i->second.group;
+        if (group && unchangedCounts[group] != groupSizes[group])
+        {
+            released.insert(GetOutputFileName(i->first, i->second));
+            Entry entry = i->second;
+            entry.group = 0;
+            m_pending[i->first] = entry;
+            i = m_current.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (!released.empty())
+        wxLogTrace("poedit.extractor", "%d cached groups of files were modified", (int)released.size());
+
+    return released;
+}
+
+
+void ExtractionCache::Save()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_dir.empty() || (!m_modified && m_current.size() == m_index.size()))
+        return;
+
+    std::string data(INDEX_SIGNATURE);
+    data += '\n';
+    for (auto& i: m_current)
+    {
+        auto& e = i.second;
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%016llx\t%llu\t%lld\t%016llx\t", (unsigned long long)e.hash, (unsigned long long)e.size, (long long)e.mtime, (unsigned long long)e.group);
+        data += buf;
+        data += str::to_utf8(i.first);
+        data += '\n';
+    }
+
+    wxLogNull nolog;
+    if (!WriteFileAtomically(m_indexFile, data))
+        return;
+
+    // Remove outputs that are no longer used, i.e. for files that were
+    // modified or removed from the project since the index was loaded:
+    std::set<uint64_t> currentGroups;
+    for (auto& i: m_current)
+        currentGroups.insert(i.second.group);
+
+    std::set<wxString> unused;
+    for (auto& i: m_index)
+    {
+        if (i.second.group)
+        {
+            if (!currentGroups.count(i.second.group))
+                unused.insert(GetOutputFileName(i.first, i.second));
+            continue;
+        }
+        auto c = m_current.find(i.first);
+        if (c == m_current.end() || c->second.hash != i.second.hash || c->second.group)
+            unused.insert(GetOutputFileName(i.first, i.second));
+    }
+    for (auto& f: unused)
+        wxRemoveFile(f);
+
+    wxLogTrace("poedit.extractor", "saved extraction cache index with %d files", (int)m_current.size());
+
+    m_index = m_current;
+    m_modified = false;
+}
@@ -0,0 +1,155 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef Poedit_extraction_cache_h
+#define Poedit_extraction_cache_h
+
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <wx/string.h>
+
+
+/**
+    On-disk cache of strings extracted from individual source files.
+
+    Running extractors over all files of a large project takes long, even
+    though typically only a few files change between updates. The cache keeps
+    extractor's output (a partial POT file) for each source file, so that only
+    modified files need to be processed again and the rest is merged from
+    the cache.
+
+    Cached outputs are keyed on file's path, size, modification time and
+    a hash of its content, as well as extractor's options (see
+    Extractor::GetCacheKey()). Each project with given options has its own
+    index of files, entries for files no longer present in the project are
+    removed when the index is saved.
+
+    Modification times may only have a resolution of seconds, so files
+    modified shortly before the index was written are always compared by
+    their content.
+
+    When many files need extracting (e.g. the first time), running extractor
+    for each of them individually would be too slow. Such files are extracted
+    in groups instead and their output is cached for the whole group, see
+    StoreGroup(); it remains valid for as long as none of the files changes.
+
+    The cache is disabled until Enable() is called.
+ */
+class ExtractionCache
+{
+public:
+    /// Enables the cache, with cache files stored in @a dir.
+    static void Enable(const wxString& dir);
+
+    /// Is the cache enabled?
+    static bool IsEnabled();
+
+    /**
+        Opens the cache for extracting from sources in @a basePath.
+
+        @param basePath Base path of the sources; files are relative to it.
+        @param key      Extractor's options, see Extractor::GetCacheKey().
+     */
+    ExtractionCache(const wxString& basePath, const wxString& key);
+
+    ExtractionCache(const ExtractionCache&) = delete;
+    ExtractionCache& operator=(const ExtractionCache&) = delete;
+
+    /**
+        Returns cached output for @a file (relative to base path).
+
+        @return Filename of the POT file with the output or empty string if
+                the file isn't cached or was modified since. The output may
+                be shared with other files of the same group, in which case
+                it can only be used if ReleaseIncompleteGroups() doesn't
+                return it.
+
+        Can be called from multiple threads simultaneously.
+     */
+    wxString Lookup(const wxString& file);
+
+    /**
+        Checks groups' outputs once all files were looked up.
+
+        Output of a group can only be used if none of its files changed or
+        was removed from the project. Otherwise, the remaining files of the
+        group must be extracted again and are treated as modified.
+
+        @return Outputs, as returned by Lookup(), that mustn't be used.
+     */
+    std::set<wxString> ReleaseIncompleteGroups();
+
+    /**
+        Stores extracted output @a pot for @a file, previously passed to Lookup().
+
+        Can be called from multiple threads simultaneously.
+     */
+    void Store(const wxString& file, const wxString& pot);
+
+    /**
+        Stores extracted output @a pot for all of @a files together.
+
+        Can be called from multiple threads simultaneously.
+     */
+    void StoreGroup(const std::vector<wxString>& files, const wxString& pot);
+
+    /// Writes updated index to disk, removing outputs of files not looked up.
+    void Save();
+
+private:
+    struct Entry
+    {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        uint64_t hash = 0;
+        // ID of the group with shared output, 0 if the file has its own
+        uint64_t group = 0;
+    };
+
+    wxString GetOutputFileName(const wxString& file, const Entry& entry) const;
+    void LoadIndex();
+
+    wxString m_dir;
+    wxString m_key;
+    wxString m_basePath;
+    wxString m_indexFile;
+
+    std::mutex m_mutex;
+    // index as loaded from disk:
+    std::map<wxString, Entry> m_index;
+    // files looked up, but not cached yet:
+    std::map<wxString, Entry> m_pending;
+    // files with valid cached output, i.e. the index to save:
+    std::map<wxString, Entry> m_current;
+    bool m_modified = false;
+    // modification time of the index file as loaded
+    int64_t m_indexTime = 0;
+};
+
+#endif // Poedit_extraction_cache_h
@@ -25,138 +25,260 @@
 
 #include "extractor.h"
 
+#include "extraction_cache.h"
 #include "extractor_legacy.h"
 
+#include "catalog_po.h"
+#include "catalog_po_writer.h"
 #include "gexecute.h"
+#include "str_helpers.h"
 
 #include <wx/dir.h>
+#include <wx/file.h>
 #include <wx/filename.h>
+#include <wx/log.h>
 #include <wx/textfile.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#ifndef __WXMSW__
+    #include <dirent.h>
+    #include <errno.h>
+    #include <sys/stat.h>
+#endif
 
 namespace
 {
 
-// Path matching with support for wildcards
-
-struct PathToMatch
+inline void CheckReadPermissions(const wxString& basepath, const wxString& path)
 {
-    wxString path;
-    bool isWildcard;
-
-    bool MatchesFile(const wxString& fn) const
+    if (!wxIsReadable(basepath + path))
     {
-        if (isWildcard)
-            return wxMatchWild(path, fn);
-        else
-            return fn == path || fn.starts_with(path + "/");
+        BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::PermissionDenied));
     }
+}
+
+inline bool IsVCSDir(const wxString& d)
+{
+    return d == ".git" || d == ".svn" || d == ".hg" || d == ".bzr" || d == "CVS";
+}
+
+
+/// Entry of a directory as enumerated by ListDirectory()
+struct DirEntry
+{
+    wxString name;
+    bool isDir;
 };
 
-class PathsToMatch
+/**
+    Lists regular files and subdirectories in @a path, following symlinks.
+
+    Hidden entries and broken symlinks are skipped. Returns false if the
+    directory can't be opened, throws if it is because of permissions.
+ */
+bool ListDirectory(const wxString& path, std::vector<DirEntry>& entries)
 {
-public:
-    PathsToMatch() {}
-    explicit PathsToMatch(const wxArrayString& a)
+#ifdef __WXMSW__
+    wxDir dir(path);
+    if (!dir.IsOpened())
     {
-        paths.reserve(a.size());
-        for (auto& p: a)
-            paths.push_back({p, wxIsWild(p)});
+        if (!wxIsReadable(path))
+            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::PermissionDenied));
+        return false;
     }
 
-    bool MatchesFile(const wxString& fn) const
+    wxString name;
+    for (bool cont = dir.GetFirst(&name, wxEmptyString, wxDIR_FILES); cont; cont = dir.GetNext(&name))
+        entries.push_back({name, false});
+    for (bool cont = dir.GetFirst(&name, wxEmptyString, wxDIR_DIRS); cont; cont = dir.GetNext(&name))
+        entries.push_back({name, true});
+    return true;
+#else
+    const std::string dirpath(path.fn_str());
+    DIR *dir = opendir(dirpath.c_str());
+    if (!dir)
     {
-        for (auto& p: paths)
-        {
-            if (p.MatchesFile(fn))
-                return true;
-        }
+        if (errno == EACCES)
+            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::PermissionDenied));
         return false;
     }
 
-private:
-    std::vector<PathToMatch> paths;
-};
-
-inline void CheckReadPermissions(const wxString& basepath, const wxString& path)
-{
-    if (!wxIsReadable(basepath + path))
+    std::string fullpath;
+    while (auto ent = readdir(dir))
     {
-        BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::PermissionDenied));
+        const char *name = ent->d_name;
+        if (name[0] == '.')
+            continue;  // hidden files as well as . and ..
+
+        bool isDir = false;
+        bool needsStat = true;
+#ifdef DT_DIR
+        // d_type avoids stat() calls, except for symlinks and filesystems that don't provide it
+        if (ent->d_type == DT_DIR || ent->d_type == DT_REG)
+        {
+            isDir = ent->d_type == DT_DIR;
+            needsStat = false;
+        }
+#endif
+        if (needsStat)
+        {
+            fullpath = dirpath;
+            fullpath += '/';
+            fullpath += name;
+            struct stat st;
+            if (stat(fullpath.c_str(), &st) != 0)
+                continue;  // e.g. a broken symlink
+            if (S_ISDIR(st.st_mode))
+                isDir = true;
+            else if (!S_ISREG(st.st_mode))
+                continue;
+        }
+
+        entries.push_back({wxString(name, *wxConvFileName), isDir});
     }
-}
 
-inline bool IsVCSDir(const wxString& d)
-{
-    return d == ".git" || d == ".svn" || d == ".hg" || d == ".bzr" || d == "CVS";
+    closedir(dir);
+    return true;
+#endif
 }
 
 
-int FindInDir(const wxString& basepath, const wxString& dirname, const PathsToMatch& excludedPaths,
-              Extractor::FilesList& output,
-              dispatch::cancellation_token_ptr cancellation)
+/**
+    Collects files from directory trees in parallel.
+
+    Directories waiting to be enumerated are kept in a shared stack that
+    idle workers take work from, so that even very unbalanced trees are
+    processed using all workers. Each worker collects found files into its
+    own list.
+ */
+class ParallelDirWalker
 {
-    cancellation->throw_if_cancelled();
+public:
+    typedef std::function<bool(const wxString&)> FileFilter;
 
-    if (dirname.empty())
-        return 0;
+    ParallelDirWalker(const wxString& basepath, const PathsToMatch& excludedPaths, FileFilter filter,
+                      dispatch::cancellation_token_ptr cancellation)
+        : m_basepath(basepath), m_excludedPaths(excludedPaths), m_filter(filter), m_cancellation(cancellation)
+    {}
 
-    wxDir dir(basepath + dirname);
+    /// Collects files from given directories (relative to basepath), in unspecified order
+    Extractor::FilesList Walk(const std::vector<wxString>& dirs)
+    {
+        m_queue = dirs;
+        m_pending = dirs.size();
 
-    CheckReadPermissions(basepath, dirname);
+        const unsigned workers = dispatch::default_parallelism();
+        std::vector<Extractor::FilesList> found(workers);
+        dispatch::parallel_for(workers, workers, [&](size_t w){ Worker(found[w]); });
 
-    if (!dir.IsOpened())
-        return 0;
+        if (m_error)
+            std::rethrow_exception(m_error);
+
+        Extractor::FilesList output;
+        for (auto& f: found)
+            output.insert(output.end(), std::make_move_iterator(f.begin()), std::make_move_iterator(f.end()));
+        return output;
+    }
 
-    bool cont;
-    wxString iter;
-    int found = 0;
-    
-    cont = dir.GetFirst(&iter, wxEmptyString, wxDIR_FILES);
-    while (cont)
+private:
+    void Worker(Extractor::FilesList& output)
     {
-        cancellation->throw_if_cancelled();
+        std::vector<DirEntry> entries;
+        std::vector<wxString> subdirs;
 
-        const wxString filename = iter;
-        const wxString fullpath = (dirname == ".") ? filename : dirname + "/" + filename;
-        cont = dir.GetNext(&iter);
+        for (;;)
+        {
+            wxString dirname;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [this]{ return !m_queue.empty() || m_pending == 0 || m_error; });
+                if (m_pending == 0 || m_error)
+                    return;
+                dirname = std::move(m_queue.back());
+                m_queue.pop_back();
+            }
 
-        if (excludedPaths.MatchesFile(fullpath))
-            continue;
+            subdirs.clear();
+            try
+            {
+                m_cancellation->throw_if_cancelled();
+                ProcessDir(dirname, entries, subdirs, output);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error)
+                    m_error = std::current_exception();
+                m_cv.notify_all();
+                return;
+            }
 
-        // Normally, a file enumerated by wxDir exists, but in one special case, it may
-        // not: if it is a broken symlink. FileExists() follows the symlink to check.
-        if (!wxFileName::FileExists(basepath + fullpath))
-            continue;
-        
-        CheckReadPermissions(basepath, fullpath);
-        wxLogTrace("poedit.extractor", "  - %s", fullpath);
-        output.push_back(fullpath);
-        found++;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending += subdirs.size();
+            m_pending--;
+            for (auto& d: subdirs)
+                m_queue.push_back(std::move(d));
+            if (m_pending == 0 || !subdirs.empty())
+                m_cv.notify_all();
+        }
     }
 
-    cont = dir.GetFirst(&iter, wxEmptyString, wxDIR_DIRS);
-    while (cont)
+    void ProcessDir(const wxString& dirname, std::vector<DirEntry>& entries,
+                    std::vector<wxString>& subdirs, Extractor::FilesList& output)
     {
-        cancellation->throw_if_cancelled();
+        entries.clear();
+        if (!ListDirectory(m_basepath + dirname, entries))
+            return;
 
-        const wxString filename = iter;
-        const wxString fullpath = (dirname == ".") ? filename : dirname + "/" + filename;
-        cont = dir.GetNext(&iter);
+        for (auto& e: entries)
+        {
+            const wxString fullpath = (dirname == ".") ? e.name : dirname + "/" + e.name;
 
-        if (IsVCSDir(filename))
-            continue;
+            if (e.isDir)
+            {
+                if (IsVCSDir(e.name) || m_excludedPaths.MatchesFile(fullpath))
+                    continue;
+                subdirs.push_back(fullpath);
+            }
+            else
+            {
+                if (!m_filter(fullpath) || m_excludedPaths.MatchesFile(fullpath))
+                    continue;
+                CheckReadPermissions(m_basepath, fullpath);
+                wxLogTrace("poedit.extractor", "  - %s", fullpath);
+                output.push_back(fullpath);
+            }
+        }
+    }
 
-        if (excludedPaths.MatchesFile(fullpath))
-            continue;
+    const wxString m_basepath;
+    const PathsToMatch& m_excludedPaths;
+    FileFilter m_filter;
+    dispatch::cancellation_token_ptr m_cancellation;
 
-        CheckReadPermissions(basepath, fullpath);
-        found += FindInDir(basepath, fullpath, excludedPaths, output, cancellation);
-    }
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<wxString> m_queue;
+    size_t m_pending = 0;
+    std::exception_ptr m_error;
+};
 
-    return found;
-}
+
+// Modified files are extracted one by one only if there aren't more of them,
+// see Extractor::ExtractIncrementally():
+const size_t MAX_FILES_EXTRACTED_INDIVIDUALLY = 50;
+
+// Minimal number of files extracted together otherwise:
+const size_t MIN_FILES_PER_GROUP = 100;
 
 } // anonymous namespace
 
@@ -164,14 +286,20 @@ int FindInDir(const wxString& basepath, const wxString& dirname, const PathsToMa
 Extractor::FilesList Extractor::CollectAllFiles(const SourceCodeSpec& sources,
                                                 dispatch::cancellation_token_ptr cancellation)
 {
-    // TODO: Only collect files with recognized extensions
-
     wxLogTrace("poedit.extractor", "collecting files:");
 
     const auto basepath = sources.BasePath;
     const auto excludedPaths = PathsToMatch(sources.ExcludedPaths);
 
+    // Only collect files from directories if some extractor can handle them:
+    const FilesMatcher matcher(CreateAllExtractors(sources));
+    auto isSupported = [&matcher](const wxString& file)
+    {
+        return matcher.Match(file) != -1;
+    };
+
     FilesList output;
+    std::vector<wxString> dirs;
 
     for (auto& path: sources.SearchPaths)
     {
@@ -190,10 +318,8 @@ Extractor::FilesList Extractor::CollectAllFiles(const SourceCodeSpec& sources,
         }
         else if (wxFileName::DirExists(basepath + path))
         {
-            if (!FindInDir(basepath, path, excludedPaths, output, cancellation))
-            {
-                wxLogTrace("poedit.extractor", "no files found in '%s'", path);
-            }
+            if (!path.empty())
+                dirs.push_back(path);
         }
         else
         {
@@ -201,12 +327,30 @@ Extractor::FilesList Extractor::CollectAllFiles(const SourceCodeSpec& sources,
         }
     }
 
+    if (!dirs.empty())
+    {
+        ParallelDirWalker walker(basepath, excludedPaths, isSupported, cancellation);
+        auto found = walker.Walk(dirs);
+        output.insert(output.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+    }
+
     // Sort the filenames in some well-defined order. This is because directory
     // traversal has, generally speaking, undefined order, and the order differs
     // between filesystems. Finally, the order is reflected in the created PO
     // files and it is much better for diffs if it remains consistent.
     std::sort(output.begin(), output.end());
 
+    if (wxLog::IsAllowedTraceMask("poedit.extractor"))
+    {
+        for (auto& d: dirs)
+        {
+            auto prefix = (d == ".") ? wxString() : d + "/";
+            auto i = std::lower_bound(output.begin(), output.end(), prefix);
+            if (i == output.end() || !i->starts_with(prefix))
+                wxLogTrace("poedit.extractor", "no files found in '%s'", d);
+        }
+    }
+
     wxLogTrace("poedit.extractor", "finished collecting %d files", (int)output.size());
 
     return output;
@@ -215,45 +359,44 @@ Extractor::FilesList Extractor::CollectAllFiles(const SourceCodeSpec& sources,
 
 ExtractionOutput Extractor::ExtractWithAll(TempDirectory& tmpdir,
                                            const SourceCodeSpec& sourceSpec,
-                                           const std::vector<wxString>& files_,
+                                           const std::vector<wxString>& files,
                                            dispatch::cancellation_token_ptr cancellation)
 {
-    auto files = files_;
     wxLogTrace("poedit.extractor", "extracting from %d files", (int)files.size());
 
+    // Assign files to extractors in a single pass; the lists remain sorted:
+    const auto extractors = CreateAllExtractors(sourceSpec);
+    const FilesMatcher matcher(extractors);
+
+    std::vector<FilesList> assigned(extractors.size());
+    int unrecognized = 0;
+    for (auto& f: files)
+    {
+        const int i = matcher.Match(f);
+        if (i == -1)
+            unrecognized++;
+        else
+            assigned[i].push_back(f);
+    }
+
     std::vector<ExtractionOutput> partials;
 
-    for (auto ex: CreateAllExtractors(sourceSpec))
+    for (size_t i = 0; i < extractors.size(); i++)
     {
         cancellation->throw_if_cancelled();
 
-        const auto ex_files = ex->FilterFiles(files);
+        auto& ex = extractors[i];
+        const auto& ex_files = assigned[i];
         if (ex_files.empty())
             continue;
 
         wxLogTrace("poedit.extractor", " .. using extractor '%s' for %d files", ex->GetId(), (int)ex_files.size());
-        auto sub = ex->Extract(tmpdir, sourceSpec, ex_files);
+        auto sub = ex->ExtractIncrementally(tmpdir, sourceSpec, ex_files, cancellation);
         if (sub)
             partials.push_back(sub);
-
-        if (files.size() > ex_files.size())
-        {
-            FilesList remaining;
-            remaining.reserve(files.size() - ex_files.size());
-            // Note that this only works because the lists are sorted:
-            std::set_difference(files.begin(), files.end(),
-                                ex_files.begin(), ex_files.end(),
-                                std::inserter(remaining, remaining.begin()));
-            std::swap(files, remaining);
-        }
-        else
-        {
-            files.clear();
-            break; // no more work to do
-        }
     }
 
-    wxLogTrace("poedit.extractor", "extraction finished with %d unrecognized files and %d sub-POTs", (int)files.size(), (int)partials.size());
+    wxLogTrace("poedit.extractor", "extraction finished with %d unrecognized files and %d sub-POTs", unrecognized, (int)partials.size());
 
     if (partials.empty())
     {
@@ -271,6 +414,107 @@ ExtractionOutput Extractor::ExtractWithAll(TempDirectory& tmpdir,
 }
 
 
+ExtractionOutput Extractor::ExtractIncrementally(TempDirectory& tmpdir,
+                                                 const SourceCodeSpec& sourceSpec,
+                                                 const FilesList& files,
+                                                 dispatch::cancellation_token_ptr cancellation) const
+{
+    const auto key = GetCacheKey(sourceSpec);
+    if (key.empty())
+        return Extract(tmpdir, sourceSpec, files);
+
+    // Extractor's output for a file doesn't depend on other files, so files
+    // can be extracted in parts, concurrently, and the outputs concatenated.
+    // Parts are contiguous and concatenated in order, so the result is the
+    // same as when extracting from all files at once.
+    ExtractionCache cache(sourceSpec.BasePath, GetId() + "\n" + key);
+
+    std::vector<ExtractionOutput> partials(files.size());
+    dispatch::parallel_for(files.size(), dispatch::default_parallelism(), [&](size_t i)
+    {
+        cancellation->throw_if_cancelled();
+        partials[i].pot_file = cache.Lookup(files[i]);
+    });
+
+    const auto released = cache.ReleaseIncompleteGroups();
+
+    std::vector<size_t> modified;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        auto& pot = partials[i].pot_file;
+        if (!pot.empty() && released.find(pot) != released.end())
+            pot.clear();
+        if (pot.empty())
+            modified.push_back(i);
+    }
+
+    wxLogTrace("poedit.extractor", " .. %d files cached, extracting %d modified", int(files.size() - modified.size()), (int)modified.size());
+
+    // A few modified files are extracted individually, so that their output
+    // can be cached on its own. With more files, the overhead of running the
+    // extractor for each of them would be prohibitive (think of the first
+    // run on a large project), so they are extracted in groups, cached as
+    // a whole. Without the cache, the parts are only as many as can run
+    // concurrently.
+    size_t groupSize;
+    if (!ExtractionCache::IsEnabled())
+        groupSize = std::max(MIN_FILES_PER_GROUP, (modified.size() + dispatch::default_parallelism() - 1) / dispatch::default_parallelism());
+    else if (modified.size() > MAX_FILES_EXTRACTED_INDIVIDUALLY)
+        groupSize = MIN_FILES_PER_GROUP;
+    else
+        groupSize = 1;
+
+    const size_t groupsCount = (modified.size() + groupSize - 1) / groupSize;
+    if (groupsCount > 1)
+        wxLogTrace("poedit.extractor", " .. extracting in %d parts", (int)groupsCount);
+
+    // TempDirectory isn't thread-safe, so output filenames are created upfront
+    // and each extraction uses its own temporary directory:
+    std::vector<wxString> outputs;
+    for (size_t g = 0; g < groupsCount; g++)
+        outputs.push_back(tmpdir.CreateFileName("partial.pot"));
+
+    dispatch::parallel_for(groupsCount, dispatch::default_parallelism(), [&](size_t g)
+    {
+        cancellation->throw_if_cancelled();
+
+        FilesList group;
+        const size_t first = g * groupSize;
+        for (size_t n = first; n < std::min(first + groupSize, modified.size()); n++)
+            group.push_back(files[modified[n]]);
+
+        TempDirectory subdir;
+        auto sub = Extract(subdir, sourceSpec, group);
+        if (!sub || !wxRenameFile(sub.pot_file, outputs[g]))
+            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified, group.size() == 1 ? group.front() : wxString()));
+
+        // Don't cache output with warnings, so that they are reported every time:
+        if (!sub.errors)
+        {
+            if (group.size() == 1)
+                cache.Store(group.front(), outputs[g]);
+            else
+                cache.StoreGroup(group, outputs[g]);
+        }
+
+        partials[modified[first]] = {outputs[g], sub.errors};
+    });
+
+    cache.Save();
+
+    // Files of the same group share the same output, which must be used once:
+    std::vector<ExtractionOutput> used;
+    std::set<wxString> seen;
+    for (auto& p: partials)
+    {
+        if (p && seen.insert(p.pot_file).second)
+            used.push_back(p);
+    }
+
+    return ConcatPartials(tmpdir, used);
+}
+
+
 Extractor::FilesList Extractor::FilterFiles(const FilesList& files) const
 {
     FilesList out;
@@ -283,6 +527,74 @@ Extractor::FilesList Extractor::FilterFiles(const FilesList& files) const
 }
 
 
+Extractor::FilesMatcher::FilesMatcher(const ExtractorsList& extractors)
+{
+    for (int i = 0; i < (int)extractors.size(); i++)
+    {
+        auto& ex = *extractors[i];
+
+        // the first, i.e. highest priority, extractor wins:
+        for (auto& ext: ex.m_extensions)
+            m_extensions.emplace(ext, i);
+
+        for (auto& w: ex.m_wildcards)
+        {
+            auto rest = w.Mid(1);
+            if (w.starts_with("*") && !wxIsWild(rest))
+                m_suffixes.push_back({rest, i});
+            else
+                m_wildcards.push_back({w, i});
+        }
+    }
+}
+
+
+int Extractor::FilesMatcher::Match(const wxString& file) const
+{
+#ifdef __WXMSW__
+    auto f = file.Lower();
+#else
+    auto& f = file;
+#endif
+
+    int found = -1;
+
+    auto dot = f.find_last_of('.');
+    if (dot != wxString::npos)
+    {
+        auto i = m_extensions.find(f.substr(dot + 1));
+        if (i != m_extensions.end())
+            found = i->second;
+    }
+
+    // Patterns are sorted by extractors' priority, so only those of higher
+    // priority extractors than the one already found need to be checked:
+    for (auto& p: m_suffixes)
+    {
+        if (found != -1 && p.extractor >= found)
+            break;
+        if (f.length() >= p.pattern.length() && f.compare(f.length() - p.pattern.length(), p.pattern.length(), p.pattern) == 0)
+        {
+            found = p.extractor;
+            break;
+        }
+    }
+
+    for (auto& p: m_wildcards)
+    {
+        if (found != -1 && p.extractor >= found)
+            break;
+        if (f.Matches(p.pattern))
+        {
+            found = p.extractor;
+            break;
+        }
+    }
+
+    return found;
+}
+
+
 bool Extractor::IsFileSupported(const wxString& file) const
 {
 #ifdef __WXMSW__
@@ -332,6 +644,275 @@ void Extractor::RegisterWildcard(const wxString& wildcard)
 }
 
 
+namespace
+{
+
+// Width used by msgcat by default, which was used to concatenate partials before:
+const int POT_WRAPPING_WIDTH = 79;
+
+/// Parser of partial POT files, collecting their entries in writer's format.
+class PartialPOTParser : public POCatalogParser
+{
+public:
+    explicit PartialPOTParser(POLineSource *source) : POCatalogParser(source) {}
+
+    bool HasHeader = false;
+    POWriter::Entry Header;
+    std::vector<POWriter::Entry> Entries;
+
+protected:
+    bool OnEntry(const wxString& msgid,
+                 const wxString& msgid_plural,
+                 bool has_plural,
+                 bool has_context,
+                 const wxString& context,
+                 const wxArrayString& mtranslations,
+                 const wxString& flags,
+                 const wxArrayString& references,
+                 const wxString& comment,
+                 const wxArrayString& extractedComments,
+                 const wxArrayString& /*msgid_old*/,
+                 unsigned /*lineNumber*/) override
+    {
+        const bool isHeader = msgid.empty() && !has_context;
+        if (isHeader && HasHeader)
+            return true;
+
+        POWriter::Entry e;
+        e.AddRawComments(str::to_utf8(comment));
+        for (auto& c: extractedComments)
+            e.extractedComments.push_back(str::to_utf8(c));
+        for (auto& r: references)
+            e.references.push_back(str::to_utf8(r));
+        e.flags = str::to_utf8(flags);
+        e.hasContext = has_context;
+        e.context = str::to_utf8(context);
+        e.msgid = str::to_utf8(msgid);
+        e.hasPlural = has_plural;
+        e.msgidPlural = str::to_utf8(msgid_plural);
+
+        if (isHeader)
+        {
+            if (!mtranslations.empty())
+                e.translations.push_back(str::to_utf8(mtranslations[0]));
+            Header = std::move(e);
+            HasHeader = true;
+        }
+        else
+        {
+            // POT files shouldn't have any translations, make sure they don't:
+            e.translations.resize(has_plural ? 2 : 1);
+            Entries.push_back(std::move(e));
+        }
+        return true;
+    }
+};
+
+
+/// Returns value of @a field in header's text or empty string if not present.
+std::string GetHeaderField(const std::string& header, const std::string& field)
+{
+    const std::string prefix = field + ": ";
+    size_t pos = 0;
+    while (pos < header.length())
+    {
+        size_t eol = header.find('\n', pos);
+        if (eol == std::string::npos)
+            eol = header.length();
+        if (header.compare(pos, prefix.length(), prefix) == 0)
+            return header.substr(pos + prefix.length(), eol - pos - prefix.length());
+        pos = eol + 1;
+    }
+    return std::string();
+}
+
+/// Sets value of existing @a field in header's text.
+void SetHeaderField(std::string& header, const std::string& field, const std::string& value)
+{
+    const std::string prefix = field + ": ";
+    size_t pos = 0;
+    while (pos < header.length())
+    {
+        size_t eol = header.find('\n', pos);
+        if (eol == std::string::npos)
+            eol = header.length();
+        if (header.compare(pos, prefix.length(), prefix) == 0)
+        {
+            header.replace(pos + prefix.length(), eol - pos - prefix.length(), value);
+            return;
+        }
+        pos = eol + 1;
+    }
+}
+
+std::string GetHeaderCharset(const std::string& header)
+{
+    auto ct = GetHeaderField(header, "Content-Type");
+    auto pos = ct.find("charset=");
+    if (pos == std::string::npos)
+        return std::string();
+    ct = ct.substr(pos + 8);
+    return ct.substr(0, ct.find_first_of("; \t"));
+}
+
+/// Adds flags from ", flag1, flag2" formatted @a flags not yet present in @a into.
+void MergeFlags(std::string& into, const std::string& flags)
+{
+    size_t pos = 0;
+    while (pos < flags.length())
+    {
+        size_t end = flags.find(',', pos);
+        if (end == std::string::npos)
+            end = flags.length();
+        auto flag = flags.substr(pos, end - pos);
+        pos = end + 1;
+
+        flag.erase(0, flag.find_first_not_of(' '));
+        flag.erase(flag.find_last_not_of(' ') + 1);
+        if (flag.empty())
+            continue;
+
+        const std::string padded = into + ",";
+        if (padded.find(", " + flag + ",") == std::string::npos)
+            into += ", " + flag;
+    }
+}
+
+template<typename T>
+void AppendMissing(std::vector<T>& into, const std::vector<T>& items)
+{
+    for (auto& i: items)
+    {
+        if (std::find(into.begin(), into.end(), i) == into.end())
+            into.push_back(i);
+    }
+}
+
+
+/**
+    Concatenates POT files the way msgcat --use-first does, in memory.
+
+    Entries with the same context and msgid are merged into the first one,
+    taking union of their comments, references and flags. The first file's
+    header is used, with POT-Creation-Date set to the latest one.
+
+    Only UTF-8 or ASCII files can be concatenated; returns false if
+    a file couldn't be processed.
+ */
+bool ConcatPOTFiles(const std::vector<ExtractionOutput>& partials, const wxString& outfile)
+{
+    std::vector<std::unique_ptr<PartialPOTParser>> parsed(partials.size());
+    std::atomic<bool> ok(true);
+
+    dispatch::parallel_for(partials.size(), dispatch::default_parallelism(), [&](size_t i)
+    {
+        MappedFile data;
+        if (!ok || !data.Open(partials[i].pot_file))
+        {
+            ok = false;
+            return;
+        }
+
+        POUtf8LineSource source(data.begin(), data.end(), partials[i].pot_file);
+        auto parser = std::make_unique<PartialPOTParser>(&source);
+        if (!parser->Parse() || source.HasErrors() || !parser->HasHeader)
+        {
+            ok = false;
+            return;
+        }
+
+        const auto charset = GetHeaderCharset(parser->Header.translations.empty() ? std::string() : parser->Header.translations[0]);
+        if (charset != "CHARSET" && charset != "ASCII" && charset != "US-ASCII" && charset != "UTF-8")
+        {
+            wxLogTrace("poedit.extractor", "can't concatenate %s in charset %s in-process", partials[i].pot_file, charset);
+            ok = false;
+            return;
+        }
+
+        parsed[i] = std::move(parser);
+    });
+
+    if (!ok)
+        return false;
+
+    POWriter::Entry header = parsed.front()->Header;
+    if (header.translations.empty())
+        header.translations.emplace_back();
+    auto& headerText = header.translations[0];
+
+    std::string creationDate = GetHeaderField(headerText, "POT-Creation-Date");
+    bool isUTF8 = false;
+
+    std::vector<POWriter::Entry> entries;
+    std::unordered_map<std::string, size_t> index;
+
+    for (auto& p: parsed)
+    {
+        auto& text = p->Header.translations[0];
+        creationDate = std::max(creationDate, GetHeaderField(text, "POT-Creation-Date"));
+        if (GetHeaderCharset(text) == "UTF-8")
+            isUTF8 = true;
+
+        for (auto& e: p->Entries)
+        {
+            std::string key = e.hasContext ? "1" + e.context : "0";
+            key += '\x04';
+            key += e.msgid;
+
+            auto i = index.find(key);
+            if (i == index.end())
+            {
+                index.emplace(std::move(key), entries.size());
+                entries.push_back(std::move(e));
+                continue;
+            }
+
+            auto& into = entries[i->second];
+            AppendMissing(into.comments, e.comments);
+            AppendMissing(into.extractedComments, e.extractedComments);
+            // duplicate references are removed by POWriter:
+            into.references.insert(into.references.end(), e.references.begin(), e.references.end());
+            MergeFlags(into.flags, e.flags);
+            if (!into.hasPlural && e.hasPlural)
+            {
+                into.hasPlural = true;
+                into.msgidPlural = e.msgidPlural;
+                into.translations.resize(2);
+            }
+        }
+
+        p.reset();
+    }
+
+    if (!creationDate.empty())
+        SetHeaderField(headerText, "POT-Creation-Date", creationDate);
+    if (isUTF8 && GetHeaderCharset(headerText) != "UTF-8")
+    {
+        auto ct = GetHeaderField(headerText, "Content-Type");
+        auto pos = ct.find("charset=");
+        if (pos != std::string::npos)
+        {
+            ct.replace(pos + 8, ct.find_first_of("; \t", pos + 8) - (pos + 8), "UTF-8");
+            SetHeaderField(headerText, "Content-Type", ct);
+        }
+    }
+
+    std::string output;
+    POWriter writer(output, POT_WRAPPING_WIDTH, "UTF-8", /*crlf=*/false);
+    writer.Write(header);
+    for (auto& e: entries)
+        writer.Write(e);
+    writer.Finish();
+
+    wxFile f;
+    return f.Create(outfile, /*overwrite=*/true) &&
+           f.Write(output.data(), output.size()) == output.size() &&
+           f.Close();
+}
+
+} // anonymous namespace
+
+
 ExtractionOutput Extractor::ConcatPartials(TempDirectory& tmpdir, const std::vector<ExtractionOutput>& partials)
 {
     if (partials.empty())
@@ -345,6 +926,14 @@ ExtractionOutput Extractor::ConcatPartials(TempDirectory& tmpdir, const std::vec
 
     ExtractionOutput result;
     result.pot_file = tmpdir.CreateFileName("concatenated.pot");
+    for (auto& p: partials)
+        result.errors += p.errors;
+
+    if (ConcatPOTFiles(partials, result.pot_file))
+        return result;
+
+    // Fall back to msgcat, which can deal with any charsets:
+    wxLogTrace("poedit.extractor", "concatenating partials with msgcat");
 
     wxTextFile filelist;
     filelist.Create(tmpdir.CreateFileName("gettext_filelist.txt"));
@@ -361,7 +950,6 @@ ExtractionOutput Extractor::ConcatPartials(TempDirectory& tmpdir, const std::vec
         }
 #endif
         filelist.AddLine(fn);
-        result.errors += p.errors;
     }
     filelist.Write(wxTextFileType_Unix, wxConvFile);
 
@@ -369,7 +957,6 @@ ExtractionOutput Extractor::ConcatPartials(TempDirectory& tmpdir, const std::vec
     auto output = gt.run_sync("msgcat",
                               "--force-po",
                               // avoid corrupted content of duplicate "" headers
-                              // FIXME: merge headers intelligently, e.g. pick latest POT-Creation-Date
                               "--use-first",
                               "-o", result.pot_file,
                               "--files-from", filelist.GetName());
@@ -392,6 +979,7 @@ Extractor::ExtractorsList Extractor::CreateAllExtractors(const SourceCodeSpec& s
     CreateAllLegacyExtractors(all, sources);
 
     // Standard builtin extractors follow
+    CreateNativeExtractors(all, sources);
     CreateGettextExtractors(all, sources);
 
     std::stable_sort(all.begin(), all.end(), [](const auto& a, const auto& b)
@@ -30,8 +30,12 @@
 #include <memory>
 #include <stdexcept>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
+#include <wx/arrstr.h>
+#include <wx/filefn.h>
+#include <wx/hashmap.h>
 #include <wx/string.h>
 
 #include "concurrency.h"
@@ -55,6 +59,51 @@ struct SourceCodeSpec
     std::map<wxString, wxString> XHeaders;
 };
 
+
+/**
+    Matching of paths relative to SourceCodeSpec::BasePath against a list
+    of paths such as SourceCodeSpec::ExcludedPaths, with support for
+    wildcards. Paths use '/' as the separator.
+ */
+class PathsToMatch
+{
+public:
+    PathsToMatch() {}
+    explicit PathsToMatch(const wxArrayString& a)
+    {
+        for (auto& p: a)
+        {
+            if (wxIsWild(p))
+                wildcards.push_back(p);
+            else
+                paths.push_back(p);
+        }
+    }
+
+    /// Does @a fn match any of the paths or is it inside of one?
+    bool MatchesFile(const wxString& fn) const
+    {
+        // This is called for every file and directory, so avoid allocations:
+        for (auto& p: paths)
+        {
+            const size_t len = p.length();
+            if (fn.length() >= len && fn.compare(0, len, p) == 0 && (fn.length() == len || fn[len] == '/'))
+                return true;
+        }
+        for (auto& w: wildcards)
+        {
+            if (wxMatchWild(w, fn))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<wxString> paths;
+    std::vector<wxString> wildcards;
+};
+
+
 enum class ExtractionError
 {
     Unspecified,
@@ -108,8 +157,11 @@ public:
     static ExtractorsList CreateAllExtractors(const SourceCodeSpec& sources);
 
     /**
-        Collects all files from source code, possibly including files that
-        don't contain translations.
+        Collects all files from source code that can be handled by some
+        extractor, possibly including files that don't contain translations.
+
+        Files explicitly listed in search paths are always included. Directories
+        are traversed in parallel.
 
         The returned list is guaranteed to be sorted by operator<
 
@@ -128,6 +180,42 @@ public:
                                            const std::vector<wxString>& files,
                                            dispatch::cancellation_token_ptr cancellation);
 
+    /**
+        Assigns files to extractors that should process them.
+
+        Extensions and wildcards of all extractors are compiled into a single
+        hash table of extensions and a list of suffixes and remaining
+        wildcards, so that a file is typically classified with a single
+        lookup, instead of calling IsFileSupported() of every extractor.
+     */
+    class FilesMatcher
+    {
+    public:
+        /// Creates matcher for extractors in @a extractors, in priority order.
+        explicit FilesMatcher(const ExtractorsList& extractors);
+
+        /**
+            Returns index of the first extractor in the list that supports
+            @a file or -1 if no extractor does.
+
+            Can be called from multiple threads simultaneously.
+         */
+        int Match(const wxString& file) const;
+
+    private:
+        struct Pattern
+        {
+            wxString pattern;
+            int extractor;
+        };
+
+        std::unordered_map<wxString, int, wxStringHash, wxStringEqual> m_extensions;
+        // "*.ext.ext" wildcards matching file's suffix:
+        std::vector<Pattern> m_suffixes;
+        // other wildcards:
+        std::vector<Pattern> m_wildcards;
+    };
+
     // Extractor helpers:
 
     /// Returns only those files from @a files that are supported by this extractor.
@@ -156,11 +244,12 @@ public:
 
     /**
         Returns whether the file is recognized.
-        
-        Default implementation uses extension and wildcard matching, see
-        RegisterExtension() and RegisterWildcard().
+
+        Uses extension and wildcard matching, see RegisterExtension() and
+        RegisterWildcard(). To classify many files with multiple extractors,
+        use FilesMatcher instead.
       */
-    virtual bool IsFileSupported(const wxString& file) const;
+    bool IsFileSupported(const wxString& file) const;
 
     /// Add a known extension or wildcard to be used by default IsFileSupported
     /// (called from ctors)
@@ -175,6 +264,31 @@ public:
                                      const SourceCodeSpec& sourceSpec,
                                      const std::vector<wxString>& files) const = 0;
 
+    /**
+        Returns key identifying options that affect extraction output.
+
+        If non-empty, Extract() must produce the same output for the same
+        content of a file and the same key, regardless of other files. Files
+        are then extracted in parts that run concurrently, extracted strings
+        are cached and only changed files are processed again on subsequent
+        extractions, see ExtractionCache.
+
+        Default implementation returns empty string, i.e. output isn't cached
+        and all files are passed to a single Extract() call.
+     */
+    virtual wxString GetCacheKey(const SourceCodeSpec& /*sourceSpec*/) const { return wxString(); }
+
+    /**
+        Extracts from @a files in parts, using cached outputs where possible.
+
+        The output is the same as Extract()'s for all @a files. Extractors
+        without a cache key (see GetCacheKey()) simply call Extract().
+     */
+    ExtractionOutput ExtractIncrementally(TempDirectory& tmpdir,
+                                          const SourceCodeSpec& sourceSpec,
+                                          const FilesList& files,
+                                          dispatch::cancellation_token_ptr cancellation) const;
+
 protected:
     Extractor() : m_priority(Priority::Default) {}
     virtual ~Extractor() {}
@@ -194,6 +308,7 @@ protected:
     // private factories:
     static void CreateAllLegacyExtractors(ExtractorsList& into, const SourceCodeSpec& sources);
     static void CreateGettextExtractors(ExtractorsList& into, const SourceCodeSpec& sources);
+    static void CreateNativeExtractors(ExtractorsList& into, const SourceCodeSpec& sources);
 };
 
 #endif // Poedit_extractor_h
@@ -26,6 +26,7 @@
 #include "extractor.h"
 
 #include "gexecute.h"
+#include "version.h"
 
 #include <wx/textfile.h>
 
@@ -100,6 +101,32 @@ public:
     ExtractionOutput Extract(TempDirectory& tmpdir,
                              const SourceCodeSpec& sourceSpec,
                              const std::vector<wxString>& files) const override
+    {
+        auto cmd = PrepareCommand(tmpdir, sourceSpec, files);
+        GettextRunner runner;
+        return ProcessOutput(runner, cmd, runner.run_command_sync(cmd.cmdline));
+    }
+
+    wxString GetCacheKey(const SourceCodeSpec& sourceSpec) const override
+    {
+        // xgettext's output for a file is fully determined by its content,
+        // the options used and gettext version (bundled with Poedit):
+        return wxString(POEDIT_VERSION) + " " + GetOptions(sourceSpec);
+    }
+    
+protected:
+    virtual wxString GetAdditionalFlags() const = 0;
+
+private:
+    /// Prepared xgettext invocation
+    struct Command
+    {
+        wxString outfile;
+        wxString cmdline;
+    };
+
+    /// Prepares xgettext invocation for @a files.
+    Command PrepareCommand(TempDirectory& tmpdir, const SourceCodeSpec& sourceSpec, const std::vector<wxString>& files) const
     {
         using subprocess::quote_arg;
 
@@ -126,24 +153,50 @@ public:
         }
         filelist.Write(wxTextFileType_Unix, wxConvFile);
 
-        auto outfile = tmpdir.CreateFileName("gettext.pot");
+        Command cmd;
+        cmd.outfile = tmpdir.CreateFileName("gettext.pot");
 
-        wxString cmdline;
-        cmdline.Printf
+        cmd.cmdline.Printf
         (
-            "xgettext --force-po -o %s --directory=%s --files-from=%s --from-code=%s",
-            quote_arg(outfile),
+            "xgettext --force-po -o %s --directory=%s --files-from=%s",
+            quote_arg(cmd.outfile),
             quote_arg(basepath),
-            quote_arg(filelist.GetName()),
-            quote_arg(!sourceSpec.Charset.empty() ? sourceSpec.Charset : "UTF-8")
+            quote_arg(filelist.GetName())
         );
 
         if (check_gettext_version(0, 25))
         {
             // don't consider mtime of the temporary file passed to --files-from:
-            cmdline += wxString::Format(" --generated=%s", quote_arg(filelist.GetName()));
+            cmd.cmdline += wxString::Format(" --generated=%s", quote_arg(filelist.GetName()));
+        }
+
+        cmd.cmdline += " " + GetOptions(sourceSpec);
+        return cmd;
+    }
+
+    /// Checks result of running @a cmd.
+    ExtractionOutput ProcessOutput(const GettextRunner& runner, const Command& cmd, const subprocess::Output& output) const
+    {
+        auto err = runner.parse_stderr(output);
+
+        if (output.failed())
+        {
+            // Total failure - don't log warnings, focus on the hard errors
+            err.log_errors();
+            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
         }
 
+        return {cmd.outfile, err};
+    }
+
+    /// Returns xgettext options affecting the extraction.
+    wxString GetOptions(const SourceCodeSpec& sourceSpec) const
+    {
+        using subprocess::quote_arg;
+
+        wxString cmdline;
+        cmdline.Printf("--from-code=%s", quote_arg(!sourceSpec.Charset.empty() ? sourceSpec.Charset : "UTF-8"));
+
         if (check_gettext_version(0, 24, 1))
         {
             // FIXME: This is temporary, to avoid the implied slowness. Should be amended with
@@ -179,22 +232,8 @@ public:
         if (!extraFlags.empty())
             cmdline += " " + extraFlags;
 
-        GettextRunner runner;
-        auto output = runner.run_command_sync(cmdline);
-        auto err = runner.parse_stderr(output);
-
-        if (output.failed())
-        {
-            // Total failure - don't log warnings, focus on the hard errors
-            err.log_errors();
-            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
-        }
-
-        return {outfile, err};
+        return cmdline;
     }
-    
-protected:
-    virtual wxString GetAdditionalFlags() const = 0;
 };
 
 
@@ -0,0 +1,1041 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include "extractor.h"
+
+#include "catalog_po_writer.h"
+#include "str_helpers.h"
+
+#include <wx/datetime.h>
+#include <wx/file.h>
+#include <wx/log.h>
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+
+/*
+    Built-in extractor for C and C++ sources.
+
+    Scanning sources directly in Poedit is much faster than running xgettext,
+    which has to read all files again and is a separate process. The scanner
+    recognizes calls of keywords with string literal arguments, concatenation
+    of adjacent literals, escape sequences and comments tagged with
+    "TRANSLATORS:", and is meant to produce the same output as xgettext for
+    these constructs. Sources in other languages are always extracted with
+    xgettext.
+
+    It isn't a complete emulation of xgettext, though: files with constructs
+    that it doesn't handle exactly the same way (e.g. raw or prefixed string
+    literals in keyword arguments, special "xgettext:" comments, ambiguous
+    format strings) are passed to xgettext instead. The extractor is only
+    used if extraction isn't customized with xgettext flags, as those could
+    change the output in any way.
+
+    Conformance with xgettext is checked by tests/check_gettext_compat.sh.
+ */
+
+namespace
+{
+
+// C and C++ extensions, as in GETTEXT_EXTENSIONS:
+const char * const C_EXTENSIONS[] = { "c", "h", nullptr };
+const char * const CXX_EXTENSIONS[] = { "C", "c++", "cc", "cxx", "cpp", "hh", "hxx", "hpp", nullptr };
+
+// Keywords recognized by xgettext for C and C++ by default:
+const char * const DEFAULT_KEYWORDS[] = {
+    "gettext", "dgettext:2", "dcgettext:2",
+    "ngettext:1,2", "dngettext:2,3", "dcngettext:2,3",
+    "gettext_noop",
+    "pgettext:1c,2", "dpgettext:2c,3", "dcpgettext:2c,3",
+    "npgettext:1c,2,3", "dnpgettext:2c,3,4", "dcnpgettext:2c,3,4",
+    nullptr
+};
+
+// Tag of extracted comments, as passed to xgettext's --add-comments:
+const char COMMENTS_TAG[] = "TRANSLATORS:";
+
+// Width used by xgettext by default:
+const int POT_WRAPPING_WIDTH = 79;
+
+
+/// Positions of keyword's arguments as in xgettext's -k option (1-based, 0 if unused).
+struct KeywordShape
+{
+    int msgid = 1;
+    int plural = 0;
+    int context = 0;
+
+    bool operator==(const KeywordShape& other) const
+    {
+        return msgid == other.msgid && plural == other.plural && context == other.context;
+    }
+};
+
+typedef std::unordered_map<std::string, KeywordShape> KeywordsMap;
+
+/// Parses keyword specification; returns false if it uses features the scanner doesn't support.
+bool ParseKeyword(const std::string& spec, std::string& name, KeywordShape& shape)
+{
+    const auto colon = spec.find(':');
+    name = spec.substr(0, colon);
+    if (name.empty() || isdigit((unsigned char)name[0]))
+        return false;
+    for (char c: name)
+    {
+        if (!isalnum((unsigned char)c) && c != '_')
+            return false;
+    }
+
+    shape = KeywordShape();
+    if (colon == std::string::npos)
+        return true;
+
+    shape.msgid = 0;
+    size_t pos = colon + 1;
+    for (;;)
+    {
+        auto end = spec.find(',', pos);
+        if (end == std::string::npos)
+            end = spec.length();
+        auto arg = spec.substr(pos, end - pos);
+
+        const bool isContext = !arg.empty() && arg.back() == 'c';
+        if (isContext)
+            arg.pop_back();
+        // also rejects "t" (total arguments) and "comment" arguments:
+        if (arg.empty() || arg.length() > 2 || arg.find_first_not_of("0123456789") != std::string::npos)
+            return false;
+        const int n = atoi(arg.c_str());
+        if (n == 0)
+            return false;
+
+        if (isContext)
+        {
+            if (shape.context)
+                return false;
+            shape.context = n;
+        }
+        else if (!shape.msgid)
+            shape.msgid = n;
+        else if (!shape.plural)
+            shape.plural = n;
+        else
+            return false;
+
+        if (end == spec.length())
+            break;
+        pos = end + 1;
+    }
+
+    return shape.msgid != 0;
+}
+
+/// Creates keywords map for given spec; returns false if the scanner can't handle them.
+bool BuildKeywords(const SourceCodeSpec& sources, KeywordsMap& keywords)
+{
+    std::vector<std::string> specs;
+    for (const char * const *k = DEFAULT_KEYWORDS; *k; k++)
+        specs.push_back(*k);
+    for (auto& k: sources.Keywords)
+        specs.push_back(str::to_utf8(k));
+
+    for (auto& s: specs)
+    {
+        std::string name;
+        KeywordShape shape;
+        if (!ParseKeyword(s, name, shape))
+            return false;
+        // xgettext handles multiple shapes of the same keyword, but we don't:
+        auto i = keywords.emplace(name, shape);
+        if (!i.second && !(i.first->second == shape))
+            return false;
+    }
+    return true;
+}
+
+
+bool IsValidUTF8(const char *p, const char *end)
+{
+    while (p < end)
+    {
+        const unsigned char c = *p;
+        size_t len;
+        if (c < 0x80)
+        {
+            p++;
+            continue;
+        }
+        else if ((c & 0xE0) == 0xC0 && c >= 0xC2)
+            len = 2;
+        else if ((c & 0xF0) == 0xE0)
+            len = 3;
+        else if ((c & 0xF8) == 0xF0 && c <= 0xF4)
+            len = 4;
+        else
+            return false;
+
+        if (end - p < (ptrdiff_t)len)
+            return false;
+        for (size_t i = 1; i < len; i++)
+        {
+            if ((p[i] & 0xC0) != 0x80)
+                return false;
+        }
+        p += len;
+    }
+    return true;
+}
+
+void AppendUTF8(std::string& out, uint32_t c)
+{
+    if (c < 0x80)
+    {
+        out += (char)c;
+    }
+    else if (c < 0x800)
+    {
+        out += (char)(0xC0 | (c >> 6));
+        out += (char)(0x80 | (c & 0x3F));
+    }
+    else if (c < 0x10000)
+    {
+        out += (char)(0xE0 | (c >> 12));
+        out += (char)(0x80 | ((c >> 6) & 0x3F));
+        out += (char)(0x80 | (c & 0x3F));
+    }
+    else
+    {
+        out += (char)(0xF0 | (c >> 18));
+        out += (char)(0x80 | ((c >> 12) & 0x3F));
+        out += (char)(0x80 | ((c >> 6) & 0x3F));
+        out += (char)(0x80 | (c & 0x3F));
+    }
+}
+
+
+/**
+    Checks if @a s is a C format string.
+
+    Returns 1 if it contains printf directives, 0 if it has none and -1 if
+    it's not possible to say reliably how xgettext would classify it.
+ */
+int CheckCFormat(const std::string& s)
+{
+    const size_t len = s.length();
+    auto at = [&](size_t i) { return i < len ? s[i] : '\0'; };
+
+    int directives = 0;
+    bool percentSign = false;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (s[i] != '%')
+            continue;
+
+        i++;
+        if (at(i) == '%')
+        {
+            percentSign = true;
+            continue;
+        }
+
+        while (at(i) && strchr("-+ #0'", at(i)))
+            i++;
+        if (at(i) == '*')
+            i++;
+        else
+            while (isdigit((unsigned char)at(i))) i++;
+        if (at(i) == '.')
+        {
+            i++;
+            if (at(i) == '*')
+                i++;
+            else
+                while (isdigit((unsigned char)at(i))) i++;
+        }
+
+        if ((at(i) == 'h' && at(i + 1) == 'h') || (at(i) == 'l' && at(i + 1) == 'l'))
+            i += 2;
+        else if (at(i) && strchr("hlLqjzt", at(i)))
+            i++;
+
+        // positional arguments, %m etc. aren't handled:
+        if (!at(i) || !strchr("diouxXeEfFgGaAcspn", at(i)))
+            return -1;
+        directives++;
+    }
+
+    if (directives == 0 && percentSign)
+        return -1;
+    return directives > 0 ? 1 : 0;
+}
+
+
+/// Message found in a source file
+struct Message
+{
+    bool hasContext = false;
+    std::string context;
+    std::string msgid;
+    bool hasPlural = false;
+    std::string plural;
+    bool cFormat = false;
+    int line = 0;
+    std::vector<std::string> comments;
+};
+
+
+/// Scanner of a single C or C++ source file.
+class SourceScanner
+{
+public:
+    SourceScanner(const char *begin, const char *end, const KeywordsMap& keywords, bool isCXX)
+        : m_begin(begin), m_end(end), m_keywords(keywords), m_isCXX(isCXX) {}
+
+    /**
+        Scans the file for messages.
+
+        Returns false if the file contains something that isn't handled
+        exactly the way xgettext does and so should be processed by it.
+     */
+    bool Scan(std::vector<Message>& messages);
+
+private:
+    enum class TokenType
+    {
+        Identifier,
+        String,
+        PrefixedString,
+        Punctuation,
+        Other
+    };
+
+    struct Token
+    {
+        TokenType type;
+        const char *begin, *end;
+        int line;
+        // range in m_comments of comments preceding the token:
+        size_t commentsBegin, commentsEnd;
+    };
+
+    bool Tokenize();
+    void AddCommentLine(const char *begin, const char *end);
+    bool DecodeString(const Token& token, std::string& out) const;
+
+    /// Argument's value: 1 if it's a string, 0 if it isn't, -1 if unsupported
+    int GetArgument(size_t begin, size_t end, std::string& value, size_t& firstToken) const;
+
+    bool IsPunctuation(size_t i, char c) const
+    {
+        return i < m_tokens.size() && m_tokens[i].type == TokenType::Punctuation && *m_tokens[i].begin == c;
+    }
+
+    const char *m_begin, *m_end;
+    const KeywordsMap& m_keywords;
+    bool m_isCXX;
+
+    std::vector<Token> m_tokens;
+    std::vector<std::string> m_comments;
+};
+
+
+void SourceScanner::AddCommentLine(const char *begin, const char *end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+        begin++;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t'))
+        end--;
+    m_comments.emplace_back(begin, end);
+}
+
+
+bool SourceScanner::Tokenize()
+{
+    const char *p = m_begin;
+    int line = 1;
+
+    // Comments are associated with following tokens the way xgettext does:
+    // they are forgotten at the end of a line with some code after them.
+    int lastCommentLine = 0, lastNonCommentLine = 0;
+    size_t commentsBegin = 0;
+
+    auto isIdentChar = [](char c) { return isalnum((unsigned char)c) || c == '_'; };
+
+    auto skipLiteral = [&](char quote) -> bool
+    {
+        // p points to the opening quote
+        for (p++; p < m_end; p++)
+        {
+            if (*p == '\\')
+            {
+                if (++p == m_end || *p == '\n')
+                    return false;
+            }
+            else if (*p == quote)
+            {
+                p++;
+                return true;
+            }
+            else if (*p == '\n')
+            {
+                return false;
+            }
+        }
+        return false;
+    };
+
+    while (p < m_end)
+    {
+        const char c = *p;
+
+        if (c == '\n')
+        {
+            if (lastNonCommentLine > lastCommentLine)
+                commentsBegin = m_comments.size();
+            line++;
+            p++;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\f' || c == '\v')
+        {
+            p++;
+            continue;
+        }
+        // line continuations, DOS line endings and non-ASCII identifiers
+        // are handled differently by xgettext's lexer:
+        if (c == '\\' || c == '\r' || (unsigned char)c >= 0x80)
+            return false;
+
+        if (c == '/' && p + 1 < m_end && (p[1] == '/' || p[1] == '*'))
+        {
+            if (p[1] == '/')
+            {
+                const char *start = p + 2;
+                p = std::find(start, m_end, '\n');
+                AddCommentLine(start, p);
+                // xgettext consumes the newline as part of the comment, so
+                // the comment counts as being on the next line:
+                if (p < m_end)
+                {
+                    p++;
+                    line++;
+                }
+            }
+            else
+            {
+                const char *start = p + 2;
+                const char *close = start;
+                for (;;)
+                {
+                    close = std::find(close, m_end, '*');
+                    if (close >= m_end - 1)
+                        return false;
+                    if (close[1] == '/')
+                        break;
+                    close++;
+                }
+                const char *lineStart = start;
+                for (const char *i = start; i < close; i++)
+                {
+                    if (*i == '\n')
+                    {
+                        AddCommentLine(lineStart, i);
+                        lineStart = i + 1;
+                        line++;
+                    }
+                }
+                AddCommentLine(lineStart, close);
+                p = close + 2;
+            }
+            lastCommentLine = line;
+            continue;
+        }
+
+        Token t;
+        t.begin = p;
+        t.line = line;
+        t.commentsBegin = commentsBegin;
+        t.commentsEnd = m_comments.size();
+
+        if (c == '"')
+        {
+            if (!skipLiteral('"'))
+                return false;
+            t.type = TokenType::String;
+        }
+        else if (c == '\'')
+        {
+            if (!skipLiteral('\''))
+                return false;
+            t.type = TokenType::Other;
+        }
+        else if (isalpha((unsigned char)c) || c == '_')
+        {
+            while (p < m_end && isIdentChar(*p))
+                p++;
+            t.type = TokenType::Identifier;
+
+            if (p < m_end && (*p == '"' || *p == '\''))
+            {
+                const std::string prefix(t.begin, p);
+                if (prefix == "L" || prefix == "u" || prefix == "U" || prefix == "u8")
+                {
+                    if (!skipLiteral(*p))
+                        return false;
+                    t.type = (*(p - 1) == '"') ? TokenType::PrefixedString : TokenType::Other;
+                }
+                else
+                {
+                    // raw strings or something unexpected
+                    return false;
+                }
+            }
+        }
+        else if (isdigit((unsigned char)c) || (c == '.' && p + 1 < m_end && isdigit((unsigned char)p[1])))
+        {
+            for (p++; p < m_end; p++)
+            {
+                if (isIdentChar(*p) || *p == '.')
+                    continue;
+                if ((*p == '+' || *p == '-') && strchr("eEpP", p[-1]))
+                    continue;
+                if (*p == '\'' && p + 1 < m_end && isIdentChar(p[1]))
+                    continue; // C++14 digit separator
+                break;
+            }
+            t.type = TokenType::Other;
+        }
+        else
+        {
+            p++;
+            t.type = TokenType::Punctuation;
+        }
+
+        t.end = p;
+        m_tokens.push_back(t);
+        lastNonCommentLine = line;
+    }
+
+    return true;
+}
+
+
+bool SourceScanner::DecodeString(const Token& token, std::string& out) const
+{
+    const char *end = token.end - 1;
+    for (const char *p = token.begin + 1; p < end; p++)
+    {
+        if (*p != '\\')
+        {
+            out += *p;
+            continue;
+        }
+
+        auto hexValue = [](char c) -> int
+        {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+
+        switch (*++p)
+        {
+            case 'n':  out += '\n'; break;
+            case 't':  out += '\t'; break;
+            case 'r':  out += '\r'; break;
+            case 'a':  out += '\a'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'v':  out += '\v'; break;
+            case '\\': out += '\\'; break;
+            case '"':  out += '"';  break;
+            case '\'': out += '\''; break;
+            case '?':  out += '?';  break;
+
+            case '0': case '1': case '2': case '3':
+            case '4': case '5': case '6': case '7':
+            {
+                unsigned value = 0;
+                for (int i = 0; i < 3 && p < end && *p >= '0' && *p <= '7'; i++, p++)
+                    value = value * 8 + (*p - '0');
+                p--;
+                // xgettext's handling of NULs and non-ASCII bytes is charset-dependent:
+                if (value == 0 || value >= 0x80)
+                    return false;
+                out += (char)value;
+                break;
+            }
+
+            case 'x':
+            {
+                unsigned value = 0;
+                int digits = 0;
+                for (p++; p < end && hexValue(*p) != -1 && digits < 8; p++, digits++)
+                    value = value * 16 + hexValue(*p);
+                p--;
+                if (digits == 0 || digits == 8 || value == 0 || value >= 0x80)
+                    return false;
+                out += (char)value;
+                break;
+            }
+
+            case 'u':
+            case 'U':
+            {
+                const int digits = (*p == 'u') ? 4 : 8;
+                uint32_t value = 0;
+                for (int i = 0; i < digits; i++)
+                {
+                    if (++p >= end || hexValue(*p) == -1)
+                        return false;
+                    value = value * 16 + hexValue(*p);
+                }
+                if (value == 0 || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF))
+                    return false;
+                AppendUTF8(out, value);
+                break;
+            }
+
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+
+int SourceScanner::GetArgument(size_t begin, size_t end, std::string& value, size_t& firstToken) const
+{
+    bool hasStrings = false, hasOther = false;
+    for (size_t i = begin; i < end; i++)
+    {
+        switch (m_tokens[i].type)
+        {
+            case TokenType::String:
+                hasStrings = true;
+                break;
+            case TokenType::PrefixedString:
+                return -1;
+            default:
+                hasOther = true;
+                break;
+        }
+    }
+
+    if (!hasStrings)
+        return 0;
+    // strings mixed with other tokens, e.g. macros or nested calls:
+    if (hasOther)
+        return -1;
+
+    value.clear();
+    for (size_t i = begin; i < end; i++)
+    {
+        if (!DecodeString(m_tokens[i], value))
+            return -1;
+    }
+    firstToken = begin;
+    return 1;
+}
+
+
+bool SourceScanner::Scan(std::vector<Message>& messages)
+{
+    if (!IsValidUTF8(m_begin, m_end))
+        return false;
+
+    // special comments can change the output in many ways:
+    static const char XGETTEXT_COMMENT[] = "xgettext:";
+    if (std::search(m_begin, m_end, XGETTEXT_COMMENT, XGETTEXT_COMMENT + strlen(XGETTEXT_COMMENT)) != m_end)
+        return false;
+
+    if (!Tokenize())
+        return false;
+
+    // xgettext remembers messages when the call's closing parenthesis is
+    // reached, so messages from nested calls come first:
+    std::vector<std::pair<size_t, Message>> found;
+
+    const size_t count = m_tokens.size();
+    for (size_t i = 0; i + 1 < count; i++)
+    {
+        auto& t = m_tokens[i];
+        if (t.type != TokenType::Identifier || !IsPunctuation(i + 1, '('))
+            continue;
+
+        auto kw = m_keywords.find(std::string(t.begin, t.end));
+        if (kw == m_keywords.end())
+            continue;
+        const auto& shape = kw->second;
+
+        // split arguments at top level commas:
+        std::vector<std::pair<size_t, size_t>> args;
+        size_t argStart = i + 2;
+        size_t depth = 0;
+        size_t j = i + 2;
+        for (; j < count; j++)
+        {
+            if (m_tokens[j].type != TokenType::Punctuation)
+                continue;
+            const char c = *m_tokens[j].begin;
+            if (c == '(')
+            {
+                depth++;
+            }
+            else if (c == ')')
+            {
+                if (depth == 0)
+                    break;
+                depth--;
+            }
+            else if (c == ',' && depth == 0)
+            {
+                args.emplace_back(argStart, j);
+                argStart = j + 1;
+            }
+            else if (c == ';' || c == '{' || c == '}')
+            {
+                return false;
+            }
+        }
+        if (j == count)
+            return false;
+        args.emplace_back(argStart, j);
+
+        const int maxArg = std::max({shape.msgid, shape.plural, shape.context});
+        if ((int)args.size() < maxArg)
+            return false;
+
+        Message msg;
+        size_t msgidToken = 0, unused;
+        const int hasMsgid = GetArgument(args[shape.msgid - 1].first, args[shape.msgid - 1].second, msg.msgid, msgidToken);
+        int hasPlural = hasMsgid, hasContext = hasMsgid;
+        if (shape.plural)
+        {
+            hasPlural = GetArgument(args[shape.plural - 1].first, args[shape.plural - 1].second, msg.plural, unused);
+            msg.hasPlural = true;
+        }
+        if (shape.context)
+        {
+            hasContext = GetArgument(args[shape.context - 1].first, args[shape.context - 1].second, msg.context, unused);
+            msg.hasContext = true;
+        }
+
+        if (hasMsgid == 0 && hasPlural == 0 && hasContext == 0)
+            continue; // not a literal, e.g. _(variable)
+        if (hasMsgid != 1 || hasPlural != 1 || hasContext != 1)
+            return false;
+        if (msg.msgid.empty())
+            return false; // xgettext warns about it and ignores it
+
+        const int format = CheckCFormat(msg.msgid);
+        if (format == -1 || (msg.hasPlural && CheckCFormat(msg.plural) != format))
+            return false;
+        msg.cFormat = (format == 1);
+
+        // C++ std::format strings are detected by newer xgettext versions:
+        if (m_isCXX && (msg.msgid.find('{') != std::string::npos || msg.plural.find('{') != std::string::npos))
+            return false;
+
+        auto& st = m_tokens[msgidToken];
+        msg.line = st.line;
+
+        // extracted comments start with the first one with the tag:
+        for (size_t c = st.commentsBegin; c < st.commentsEnd; c++)
+        {
+            if (!msg.comments.empty() || m_comments[c].compare(0, strlen(COMMENTS_TAG), COMMENTS_TAG) == 0)
+            {
+                if (m_comments[c].empty())
+                    return false;
+                msg.comments.push_back(m_comments[c]);
+            }
+        }
+
+        found.emplace_back(j, std::move(msg));
+    }
+
+    std::stable_sort(found.begin(), found.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+    messages.reserve(found.size());
+    for (auto& f: found)
+        messages.push_back(std::move(f.second));
+
+    return true;
+}
+
+
+template<typename T>
+void AppendMissing(std::vector<T>& into, const std::vector<T>& items)
+{
+    for (auto& i: items)
+    {
+        if (std::find(into.begin(), into.end(), i) == into.end())
+            into.push_back(i);
+    }
+}
+
+} // anonymous namespace
+
+
+/// Built-in extractor for C and C++, see the comment at the top of the file.
+class NativeCExtractor : public Extractor
+{
+public:
+    NativeCExtractor(KeywordsMap&& keywords) : m_keywords(std::move(keywords))
+    {
+        for (const char * const *e = C_EXTENSIONS; *e != nullptr; e++)
+            RegisterExtension(*e);
+        for (const char * const *e = CXX_EXTENSIONS; *e != nullptr; e++)
+            RegisterExtension(*e);
+    }
+
+    wxString GetId() const override { return "native-c"; }
+
+    ExtractionOutput Extract(TempDirectory& tmpdir,
+                             const SourceCodeSpec& sourceSpec,
+                             const std::vector<wxString>& files) const override
+    {
+        struct Result
+        {
+            std::string filename;
+            bool ok = false;
+            std::vector<Message> messages;
+        };
+        std::vector<Result> results(files.size());
+
+        dispatch::parallel_for(files.size(), dispatch::default_parallelism(), [&](size_t i)
+        {
+            auto& r = results[i];
+            r.filename = str::to_utf8(files[i]);
+            // xgettext's quoting of filenames with spaces differs between versions:
+            if (r.filename.find_first_of(" \t") != std::string::npos)
+                return;
+
+            MappedFile data;
+            {
+                wxLogNull nolog;
+                if (!data.Open(sourceSpec.BasePath + files[i]))
+                    return;
+            }
+
+            SourceScanner scanner(data.begin(), data.end(), m_keywords, IsCXXFile(files[i]));
+            r.ok = scanner.Scan(r.messages);
+            if (!r.ok)
+                r.messages.clear();
+        });
+
+        std::vector<wxString> fallback;
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            if (!results[i].ok)
+                fallback.push_back(files[i]);
+        }
+
+        wxLogTrace("poedit.extractor", " .. scanned %d files natively, %d passed to xgettext",
+                   int(files.size() - fallback.size()), (int)fallback.size());
+
+        std::vector<ExtractionOutput> partials;
+        if (fallback.size() < files.size())
+            partials.push_back(WritePOT(tmpdir, results));
+
+        if (!fallback.empty())
+        {
+            auto sub = ExtractWithGettext(tmpdir, sourceSpec, fallback);
+            if (sub)
+                partials.push_back(sub);
+        }
+
+        return ConcatPartials(tmpdir, partials);
+    }
+
+private:
+    static ExtractionOutput ExtractWithGettext(TempDirectory& tmpdir,
+                                               const SourceCodeSpec& sourceSpec,
+                                               const std::vector<wxString>& files)
+    {
+        ExtractorsList gettext;
+        CreateGettextExtractors(gettext, sourceSpec);
+        for (auto& ex: gettext)
+        {
+            if (ex->GetId() == "gettext")
+                return ex->Extract(tmpdir, sourceSpec, files);
+        }
+        return {};
+    }
+
+    static bool IsCXXFile(const wxString& file)
+    {
+        const auto ext = file.AfterLast('.');
+        for (const char * const *e = C_EXTENSIONS; *e != nullptr; e++)
+        {
+            if (ext == *e)
+                return false;
+        }
+        return true;
+    }
+
+    template<typename Results>
+    ExtractionOutput WritePOT(TempDirectory& tmpdir, const Results& results) const
+    {
+        std::vector<POWriter::Entry> entries;
+        std::unordered_map<std::string, size_t> index;
+        bool hasPlurals = false;
+
+        for (auto& r: results)
+        {
+            for (auto& m: r.messages)
+            {
+                std::string key = m.hasContext ? "1" + m.context : "0";
+                key += '\x04';
+                key += m.msgid;
+
+                const std::string ref = r.filename + ":" + std::to_string(m.line);
+
+                auto i = index.find(key);
+                if (i != index.end())
+                {
+                    auto& e = entries[i->second];
+                    e.references.push_back(ref);
+                    AppendMissing(e.extractedComments, m.comments);
+                    if (m.cFormat && e.flags.empty())
+                        e.flags = ", c-format";
+                    if (!e.hasPlural && m.hasPlural)
+                    {
+                        e.hasPlural = true;
+                        e.msgidPlural = m.plural;
+                        e.translations.resize(2);
+                    }
+                    continue;
+                }
+
+                POWriter::Entry e;
+                e.extractedComments = m.comments;
+                e.references.push_back(ref);
+                if (m.cFormat)
+                    e.flags = ", c-format";
+                e.hasContext = m.hasContext;
+                e.context = m.context;
+                e.msgid = m.msgid;
+                e.hasPlural = m.hasPlural;
+                e.msgidPlural = m.plural;
+                e.translations.resize(m.hasPlural ? 2 : 1);
+                hasPlurals = hasPlurals || m.hasPlural;
+
+                index.emplace(std::move(key), entries.size());
+                entries.push_back(std::move(e));
+            }
+        }
+
+        bool isASCII = true;
+        for (auto& e: entries)
+        {
+            for (auto s: {&e.msgid, &e.msgidPlural, &e.context})
+            {
+                if (std::any_of(s->begin(), s->end(), [](char c){ return (unsigned char)c >= 0x80; }))
+                    isASCII = false;
+            }
+            for (auto& c: e.extractedComments)
+            {
+                if (std::any_of(c.begin(), c.end(), [](char c){ return (unsigned char)c >= 0x80; }))
+                    isASCII = false;
+            }
+        }
+
+        // the same header as xgettext writes:
+        POWriter::Entry header;
+        header.comments = {
+            "SOME DESCRIPTIVE TITLE.",
+            "Copyright (C) YEAR THE PACKAGE'S COPYRIGHT HOLDER",
+            "This file is distributed under the same license as the PACKAGE package.",
+            "FIRST AUTHOR <EMAIL@ADDRESS>, YEAR.",
+            ""
+        };
+        header.flags = ", fuzzy";
+        std::string text =
+            "Project-Id-Version: PACKAGE VERSION\n"
+            "Report-Msgid-Bugs-To: \n"
+            "POT-Creation-Date: " + str::to_utf8(wxDateTime::Now().Format("%Y-%m-%d %H:%M%z")) + "\n"
+            "PO-Revision-Date: YEAR-MO-DA HO:MI+ZONE\n"
+            "Last-Translator: FULL NAME <EMAIL@ADDRESS>\n"
+            "Language-Team: LANGUAGE <LL@li.org>\n"
+            "Language: \n"
+            "MIME-Version: 1.0\n"
+            "Content-Type: text/plain; charset=" + std::string(isASCII ? "CHARSET" : "UTF-8") + "\n"
+            "Content-Transfer-Encoding: 8bit\n";
+        if (hasPlurals)
+            text += "Plural-Forms: nplurals=INTEGER; plural=EXPRESSION;\n";
+        header.translations.push_back(text);
+
+        std::string output;
+        POWriter writer(output, POT_WRAPPING_WIDTH, "UTF-8", /*crlf=*/false);
+        writer.Write(header);
+        for (auto& e: entries)
+            writer.Write(e);
+        writer.Finish();
+
+        ExtractionOutput result;
+        result.pot_file = tmpdir.CreateFileName("native.pot");
+
+        wxFile f;
+        if (!f.Create(result.pot_file, /*overwrite=*/true) ||
+            f.Write(output.data(), output.size()) != output.size() ||
+            !f.Close())
+        {
+            BOOST_THROW_EXCEPTION(ExtractionException(ExtractionError::Unspecified));
+        }
+
+        return result;
+    }
+
+    KeywordsMap m_keywords;
+};
+
+
+void Extractor::CreateNativeExtractors(Extractor::ExtractorsList& into, const SourceCodeSpec& sources)
+{
+    // Any customization of xgettext's behavior could affect its output in
+    // ways the built-in scanner doesn't replicate:
+    auto flags = sources.XHeaders.find("X-Poedit-Flags-xgettext");
+    if (flags != sources.XHeaders.end() && !flags->second.empty())
+        return;
+
+    const auto charset = sources.Charset.Upper();
+    if (!charset.empty() && charset != "UTF-8" && charset != "ASCII" && charset != "US-ASCII")
+        return;
+
+    KeywordsMap keywords;
+    if (!BuildKeywords(sources, keywords))
+    {
+        wxLogTrace("poedit.extractor", "keywords not supported by built-in extractor, using xgettext");
+        return;
+    }
+
+    // Must be added before the gettext extractor, which handles the same
+    // files with the same priority:
+    into.push_back(std::make_shared<NativeCExtractor>(std::move(keywords)));
+}
@@ -27,86 +27,28 @@
 
 #include "edframe.h"
 #include "str_helpers.h"
+#include "extractors/extractor.h"
 
+#include <wx/dir.h>
 #include <wx/fswatcher.h>
+#include <wx/log.h>
 
 #include <algorithm>
 #include <memory>
 #include <vector>
 
 
-#ifdef __WXOSX__
-
-// We can't use wxFileSystemWatcher, because it monitors the directory, not the file, and that
-// triggers scary warnings on macOS if the directory is ~/Desktop, ~/Downloads etc.
-// So instead, use a minimal sufficient NSFilePresenter for the monitoring
-
-#include <Foundation/Foundation.h>
-
-@interface POFilePresenter : NSObject<NSFilePresenter>
-@property(readwrite, copy) NSURL* presentedItemURL;
-@property(readwrite, assign) NSOperationQueue* presentedItemOperationQueue;
-@property FileMonitor::Impl* owner;
-
--(instancetype)initWithOwner:(FileMonitor::Impl*)owner URL:(NSURL*)url;
-@end
-
-class FileMonitor::Impl
-{
-public:
-    Impl(const wxFileName& fn)
-    {
-        m_path = fn.GetFullPath();
-        NSURL *url = [NSURL fileURLWithPath:str::to_NS(m_path)];
-        m_presenter = [[POFilePresenter alloc] initWithOwner:this URL:url];
-        [NSFileCoordinator addFilePresenter:m_presenter];
-    }
-
-    ~Impl()
-    {
-        m_presenter.owner = nullptr;
-        [NSFileCoordinator removeFilePresenter:m_presenter];
-        m_presenter = nil;
-    }
-
-    void OnChanged()
-    {
-        FileMonitor::NotifyFileChanged(m_path);
-    }
-
-private:
-    wxString m_path;
-    POFilePresenter *m_presenter;
-};
-
-@implementation POFilePresenter
-
--(instancetype)initWithOwner:(FileMonitor::Impl*)owner URL:(NSURL*)url
-{
-    self = [super init];
-    if (self)
-    {
-        self.owner = owner;
-        self.presentedItemURL = url;
-        self.presentedItemOperationQueue = NSOperationQueue.mainQueue;
-    }
-    return self;
-}
-
-- (void)presentedItemDidChange
-{
-    if (self.owner)
-        self.owner->OnChanged();
-}
-
-@end
-
-#else // !__WXOSX__
+// wxFileSystemWatcher is used on all platforms for monitoring source code
+// trees (see SourcesMonitor), but only on some for monitoring files. On macOS,
+// it uses FSEvents for monitoring trees; that doesn't have the problem with
+// privacy warnings described below, because only the search paths are
+// monitored and those are read by extraction anyway.
 
 namespace
 {
 
 const int MONITORING_FLASG = wxFSW_EVENT_CREATE | wxFSW_EVENT_RENAME | wxFSW_EVENT_MODIFY;
+const int TREE_MONITORING_FLAGS = MONITORING_FLASG | wxFSW_EVENT_DELETE | wxFSW_EVENT_WARNING;
 
 class FSWatcher
 {
@@ -124,16 +66,16 @@ public:
         return ms_instance;
     }
 
-    void Add(const wxFileName& dir)
+    bool Add(const wxFileName& dir, int flags = MONITORING_FLASG)
     {
         if (m_watcher)
         {
-            m_watcher->Add(dir, MONITORING_FLASG);
+            return m_watcher->Add(dir, flags);
         }
         else
         {
-            m_pending.push_back(dir);
-            return;
+            m_pending.push_back({dir, flags});
+            return true;
         }
     }
 
@@ -145,10 +87,27 @@ public:
         }
         else
         {
-            m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), dir), m_pending.end());
+            m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [&dir](const auto& p){ return p.first == dir; }),
+                            m_pending.end());
         }
     }
 
+    void AddTree(const wxFileName& dir)
+    {
+        if (m_watcher)
+            m_watcher->AddTree(dir, TREE_MONITORING_FLAGS);
+        else
+            m_pendingTrees.push_back(dir);
+    }
+
+    void RemoveTree(const wxFileName& dir)
+    {
+        if (m_watcher)
+            m_watcher->RemoveTree(dir);
+        else
+            m_pendingTrees.erase(std::remove(m_pendingTrees.begin(), m_pendingTrees.end(), dir), m_pendingTrees.end());
+    }
+
     void EventLoopStarted()
     {
         if (m_watcher)
@@ -158,15 +117,28 @@ public:
         m_watcher->Bind(wxEVT_FSWATCHER, [=](wxFileSystemWatcherEvent& event)
         {
             event.Skip();
+            if (event.GetChangeType() == wxFSW_EVENT_WARNING)
+            {
+                // some changes in monitored trees may have been missed:
+                if (event.GetWarningType() == wxFSW_WARNING_OVERFLOW)
+                    SourcesMonitor::NotifyPathChanged(wxString());
+                return;
+            }
             auto fn = event.GetNewPath();
             if (!fn.IsOk())
                 return;
             FileMonitor::NotifyFileChanged(fn.GetFullPath());
+            SourcesMonitor::NotifyPathChanged(fn.GetFullPath());
+            if (event.GetChangeType() == wxFSW_EVENT_RENAME)
+                SourcesMonitor::NotifyPathChanged(event.GetPath().GetFullPath());
         });
 
-        for (auto& dir : m_pending)
-            Add(dir);
+        for (auto& p : m_pending)
+            Add(p.first, p.second);
         m_pending.clear();
+        for (auto& dir : m_pendingTrees)
+            AddTree(dir);
+        m_pendingTrees.clear();
     }
 
     static void CleanUp() { ms_instance.reset(); }
@@ -174,7 +146,8 @@ public:
 private:
     FSWatcher() {}
 
-    std::vector<wxFileName> m_pending;
+    std::vector<std::pair<wxFileName, int>> m_pending;
+    std::vector<wxFileName> m_pendingTrees;
     std::unique_ptr<wxFileSystemWatcher> m_watcher;
 
     static std::shared_ptr<FSWatcher> ms_instance;
@@ -184,6 +157,74 @@ std::shared_ptr<FSWatcher> FSWatcher::ms_instance;
 
 } // anonymous namespace
 
+#ifdef __WXOSX__
+
+// We can't use wxFileSystemWatcher, because it monitors the directory, not the file, and that
+// triggers scary warnings on macOS if the directory is ~/Desktop, ~/Downloads etc.
+// So instead, use a minimal sufficient NSFilePresenter for the monitoring
+
+#include <Foundation/Foundation.h>
+
+@interface POFilePresenter : NSObject<NSFilePresenter>
+@property(readwrite, copy) NSURL* presentedItemURL;
+@property(readwrite, assign) NSOperationQueue* presentedItemOperationQueue;
+@property FileMonitor::Impl* owner;
+
+-(instancetype)initWithOwner:(FileMonitor::Impl*)owner URL:(NSURL*)url;
+@end
+
+class FileMonitor::Impl
+{
+public:
+    Impl(const wxFileName& fn)
+    {
+        m_path = fn.GetFullPath();
+        NSURL *url = [NSURL fileURLWithPath:str::to_NS(m_path)];
+        m_presenter = [[POFilePresenter alloc] initWithOwner:this URL:url];
+        [NSFileCoordinator addFilePresenter:m_presenter];
+    }
+
+    ~Impl()
+    {
+        m_presenter.owner = nullptr;
+        [NSFileCoordinator removeFilePresenter:m_presenter];
+        m_presenter = nil;
+    }
+
+    void OnChanged()
+    {
+        FileMonitor::NotifyFileChanged(m_path);
+    }
+
+private:
+    wxString m_path;
+    POFilePresenter *m_presenter;
+};
+
+@implementation POFilePresenter
+
+-(instancetype)initWithOwner:(FileMonitor::Impl*)owner URL:(NSURL*)url
+{
+    self = [super init];
+    if (self)
+    {
+        self.owner = owner;
+        self.presentedItemURL = url;
+        self.presentedItemOperationQueue = NSOperationQueue.mainQueue;
+    }
+    return self;
+}
+
+- (void)presentedItemDidChange
+{
+    if (self.owner)
+        self.owner->OnChanged();
+}
+
+@end
+
+#else // !__WXOSX__
+
 class FileMonitor::Impl
 {
 public:
@@ -214,18 +255,14 @@ private:
 
 void FileMonitor::EventLoopStarted()
 {
-#ifndef __WXOSX__
     auto watcher = FSWatcher::Get();
     if (watcher)
         watcher->EventLoopStarted();
-#endif
 }
 
 void FileMonitor::CleanUp()
 {
-#ifndef __WXOSX__
     FSWatcher::CleanUp();
-#endif
 }
 
 
@@ -270,3 +307,288 @@ void FileMonitor::NotifyFileChanged(const wxString& path)
         window->ReloadFileIfChanged();
 }
 
+
+
+// ----------------------------------------------------------------------
+// SourcesMonitor
+// ----------------------------------------------------------------------
+
+// wxFileSystemWatcher can watch whole trees natively on Windows and macOS;
+// with inotify, each directory has to be watched individually:
+#if defined(__WXMSW__) || defined(__WXOSX__)
+    #define USE_NATIVE_TREE_MONITORING
+#endif
+
+namespace
+{
+
+// delay after the last change before reporting changes, in milliseconds
+const int SOURCES_CHANGES_DELAY = 1500;
+
+// number of directories to start watching at once, see SourcesMonitor::Impl::WatchDirs()
+const size_t WATCHES_BATCH_SIZE = 1000;
+
+/// Is @a relative path to a file or directory in sources excluded by @a excludedPaths?
+bool IsExcludedPath(const PathsToMatch& excludedPaths, const wxString& relative)
+{
+    // as when collecting files, excluding a directory excludes its content,
+    // even if it was matched by a wildcard:
+    for (size_t slash = relative.find('/'); slash != wxString::npos; slash = relative.find('/', slash + 1))
+    {
+        if (excludedPaths.MatchesFile(relative.substr(0, slash)))
+            return true;
+    }
+    return excludedPaths.MatchesFile(relative);
+}
+
+/// Is @a relative path hidden, e.g. VCS metadata or editors' temporary files?
+inline bool IsHiddenPath(const wxString& relative)
+{
+    return relative.starts_with(".") || relative.Contains("/.");
+}
+
+#ifndef USE_NATIVE_TREE_MONITORING
+
+/// Collects @a dir and its subdirectories that aren't hidden or excluded
+void CollectDirs(const wxString& basePath, const PathsToMatch& excludedPaths,
+                 const wxString& dir, const dispatch::cancellation_token_ptr& cancellation,
+                 std::vector<wxString>& found)
+{
+    if (cancellation->is_cancelled() || !dir.starts_with(basePath))
+        return;
+
+    wxString relative = dir.substr(basePath.length());
+    if (relative.ends_with("/"))
+        relative.RemoveLast();
+    if (IsHiddenPath(relative) || (!relative.empty() && IsExcludedPath(excludedPaths, relative)))
+        return;
+
+    found.push_back(dir);
+
+    wxDir d;
+    {
+        wxLogNull nolog;
+        if (!d.Open(dir))
+            return;
+    }
+    const wxString prefix = dir.ends_with("/") ? dir : dir + "/";
+    wxString name;
+    for (bool cont = d.GetFirst(&name, wxEmptyString, wxDIR_DIRS); cont; cont = d.GetNext(&name))
+        CollectDirs(basePath, excludedPaths, prefix + name, cancellation, found);
+}
+
+#endif // !USE_NATIVE_TREE_MONITORING
+
+} // anonymous namespace
+
+
+class SourcesMonitor::Impl
+{
+public:
+    Impl(const SourceCodeSpec& spec)
+        : m_excludedPaths(spec.ExcludedPaths),
+          m_alive(std::make_shared<bool>(true))
+    {
+        wxFileName base = wxFileName::DirName(spec.BasePath);
+        base.MakeAbsolute();
+        m_basePath = base.GetFullPath();
+
+        m_watcher = FSWatcher::Get();
+
+        for (auto p: spec.SearchPaths)
+        {
+            if (p == ".")
+                p.clear();
+            if (!p.empty() && IsExcludedPath(m_excludedPaths, p))
+                continue;
+            m_searchPaths.push_back(p);
+
+            const wxString full = m_basePath + p;
+            if (wxFileName::DirExists(full))
+                WatchTree(full);
+            else if (wxFileName::FileExists(full))
+                WatchDir(wxFileName(full).GetPath());
+        }
+    }
+
+    ~Impl()
+    {
+        *m_alive = false;
+        m_cancellation->cancel();
+
+        if (auto watcher = m_watcher.lock())
+        {
+            wxLogNull nolog;  // directories may have been removed since
+            for (auto& dir: m_trees)
+                watcher->RemoveTree(dir);
+            for (auto& dir: m_dirs)
+                watcher->Remove(dir);
+        }
+    }
+
+    bool IsRelevantChange(const wxString& path) const
+    {
+        if (!path.starts_with(m_basePath))
+            return false;
+
+        wxString relative = path.substr(m_basePath.length());
+#ifdef __WXMSW__
+        relative.Replace("\\", "/");
+#endif
+
+        if (IsHiddenPath(relative) || !IsInSearchPaths(relative) || IsExcludedPath(m_excludedPaths, relative))
+            return false;
+
+        // translation files, including the one being edited:
+        auto ext = wxFileName(path).GetExt().Lower();
+        if (ext == "po" || ext == "pot" || ext == "mo")
+            return false;
+
+        return true;
+    }
+
+    void OnChanged(const wxString& path)
+    {
+#ifdef USE_NATIVE_TREE_MONITORING
+        wxUnusedVar(path);
+#else
+        // new directories must be watched too, including any subdirectories
+        // they were moved in with:
+        if (!path.empty() && wxFileName::DirExists(path))
+            WatchTree(path);
+#endif
+    }
+
+private:
+    bool IsInSearchPaths(const wxString& relative) const
+    {
+        for (auto& p: m_searchPaths)
+        {
+            if (p.empty() || (relative.starts_with(p) && (relative.length() == p.length() || relative[p.length()] == '/')))
+                return true;
+        }
+        return false;
+    }
+
+    void WatchDir(const wxString& dir)
+    {
+        auto watcher = m_watcher.lock();
+        if (!watcher)
+            return;
+        m_dirs.push_back(wxFileName::DirName(dir));
+        watcher->Add(m_dirs.back(), TREE_MONITORING_FLAGS);
+    }
+
+#ifdef USE_NATIVE_TREE_MONITORING
+    void WatchTree(const wxString& dir)
+    {
+        // The whole tree is watched natively, without enumerating it first:
+        auto watcher = m_watcher.lock();
+        if (!watcher)
+            return;
+        m_trees.push_back(wxFileName::DirName(dir));
+        watcher->AddTree(m_trees.back());
+    }
+#else
+    void WatchTree(const wxString& dir)
+    {
+        // Every directory needs its own inotify watch. Finding them takes long
+        // in large trees, so it is done in the background, skipping excluded
+        // and hidden directories to not waste the limited number of watches.
+        dispatch::async([basePath = m_basePath, excludedPaths = m_excludedPaths, dir, cancellation = m_cancellation]
+        {
+            std::vector<wxString> found;
+            CollectDirs(basePath, excludedPaths, dir, cancellation, found);
+            return found;
+        })
+        .then_on_main([this, alive = m_alive](std::vector<wxString> found)
+        {
+            if (*alive)
+                WatchDirs(std::make_shared<std::vector<wxString>>(std::move(found)), 0);
+        });
+    }
+
+    void WatchDirs(std::shared_ptr<std::vector<wxString>> dirs, size_t start)
+    {
+        auto watcher = m_watcher.lock();
+        if (!watcher || m_limitReached)
+            return;
+
+        // Adding watches is fast, but there may be very many of them, so do
+        // it in batches to keep the UI responsive:
+        const size_t end = std::min(dirs->size(), start + WATCHES_BATCH_SIZE);
+        for (size_t i = start; i < end; i++)
+        {
+            wxFileName fn = wxFileName::DirName((*dirs)[i]);
+            bool added;
+            {
+                wxLogNull nolog;
+                added = watcher->Add(fn, TREE_MONITORING_FLAGS);
+            }
+            if (!added)
+            {
+                // most likely the limit on inotify watches was reached; changes
+                // in the rest of the sources won't be noticed until reopening
+                wxLogTrace("poedit", "can't monitor more than %d directories of sources for changes", (int)m_dirs.size());
+                m_limitReached = true;
+                return;
+            }
+            m_dirs.push_back(fn);
+        }
+
+        if (end < dirs->size())
+        {
+            dispatch::on_main([this, alive = m_alive, dirs, end]
+            {
+                if (*alive)
+                    WatchDirs(dirs, end);
+            });
+        }
+    }
+#endif // !USE_NATIVE_TREE_MONITORING
+
+private:
+    wxString m_basePath;
+    std::vector<wxString> m_searchPaths;
+    PathsToMatch m_excludedPaths;
+
+    std::weak_ptr<FSWatcher> m_watcher;
+    std::vector<wxFileName> m_trees, m_dirs;
+#ifndef USE_NATIVE_TREE_MONITORING
+    bool m_limitReached = false;
+#endif
+
+    // for background tasks, which may finish after the monitor is gone:
+    std::shared_ptr<bool> m_alive;
+    dispatch::cancellation_token_ptr m_cancellation = std::make_shared<dispatch::cancellation_token>();
+};
+
+
+std::vector<SourcesMonitor*> SourcesMonitor::ms_instances;
+
+SourcesMonitor::SourcesMonitor(const SourceCodeSpec& spec, Handler handler)
+    : m_handler(handler)
+{
+    m_timer.Bind(wxEVT_TIMER, [=](wxTimerEvent&){ m_handler(); });
+    m_impl = std::make_unique<Impl>(spec);
+    ms_instances.push_back(this);
+}
+
+SourcesMonitor::~SourcesMonitor()
+{
+    ms_instances.erase(std::remove(ms_instances.begin(), ms_instances.end(), this), ms_instances.end());
+    m_timer.Stop();
+}
+
+void SourcesMonitor::NotifyPathChanged(const wxString& path)
+{
+    for (auto m: ms_instances)
+    {
+        // (re)starting the timer delays reporting until changes settle down:
+        if (path.empty() || m->m_impl->IsRelevantChange(path))
+        {
+            m->m_impl->OnChanged(path);
+            m->m_timer.StartOnce(SOURCES_CHANGES_DELAY);
+        }
+    }
+}
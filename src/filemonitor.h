@@ -30,8 +30,13 @@
 #include "edapp.h"
 
 #include <wx/filename.h>
+#include <wx/timer.h>
 
+#include <functional>
 #include <memory>
+#include <vector>
+
+struct SourceCodeSpec;
 
 
 class FileMonitor
@@ -106,4 +111,41 @@ private:
 };
 
 
+/**
+    Monitors source code of a catalog for changes.
+
+    Only the search paths are monitored and changes to excluded paths, hidden
+    files and directories (such as .git) and translation files are ignored.
+    Changes are reported with a delay, once no more of them happened for a
+    while, so that bursts of changes (e.g. switching git branches or running
+    a build) result in a single notification.
+ */
+class SourcesMonitor
+{
+public:
+    typedef std::function<void()> Handler;
+
+    /// Starts monitoring sources in @a spec, calling @a handler on the main thread after changes.
+    SourcesMonitor(const SourceCodeSpec& spec, Handler handler);
+    ~SourcesMonitor();
+
+    /// Are there changes that weren't reported yet?
+    bool HasPendingChanges() const { return m_timer.IsRunning(); }
+
+    // the following is public only for the needs of filemonitor.cpp implementations;
+    // empty @a path means that any file may have changed (e.g. events were lost):
+    static void NotifyPathChanged(const wxString& path);
+
+private:
+    class Impl;
+
+    Handler m_handler;
+    wxTimer m_timer;
+
+    std::unique_ptr<Impl> m_impl;
+
+    static std::vector<SourcesMonitor*> ms_instances;
+};
+
+
 #endif // Poedit_filemonitor_h
@@ -0,0 +1,110 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include "interned_string.h"
+
+#include <wx/hashmap.h>
+
+#include <mutex>
+#include <unordered_map>
+
+
+namespace
+{
+
+class StringPool
+{
+public:
+    static StringPool& Get()
+    {
+        // intentionally leaked, instances may be destroyed during static destruction
+        static StringPool *s_instance = new StringPool;
+        return *s_instance;
+    }
+
+    std::shared_ptr<const wxString> Intern(const wxString& s)
+    {
+        auto& shard = GetShard(s);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto& entry = shard.strings[s];
+        auto data = entry.lock();
+        if (!data)
+        {
+            data.reset(new wxString(s), [this](const wxString *p){ Release(p); });
+            entry = data;
+        }
+        return data;
+    }
+
+private:
+    // Strings are interned from several threads when loading catalogs, so
+    // the pool is split into independently locked shards:
+    static const size_t SHARDS_COUNT = 16;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<wxString, std::weak_ptr<const wxString>, wxStringHash, wxStringEqual> strings;
+    };
+
+    Shard& GetShard(const wxString& s)
+    {
+        return m_shards[wxStringHash()(s) % SHARDS_COUNT];
+    }
+
+    void Release(const wxString *p)
+    {
+        {
+            auto& shard = GetShard(*p);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            // The string may have been interned again after the last reference
+            // was released, but before we got here; keep it then:
+            auto i = shard.strings.find(*p);
+            if (i != shard.strings.end() && i->second.expired())
+                shard.strings.erase(i);
+        }
+        delete p;
+    }
+
+    Shard m_shards[SHARDS_COUNT];
+};
+
+} // anonymous namespace
+
+
+InternedString::InternedString(const wxString& s)
+{
+    if (!s.empty())
+        m_data = StringPool::Get().Intern(s);
+}
+
+
+const wxString& InternedString::EmptyString()
+{
+    static const wxString s_empty;
+    return s_empty;
+}
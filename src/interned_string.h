@@ -0,0 +1,68 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef Poedit_interned_string_h
+#define Poedit_interned_string_h
+
+#include <wx/string.h>
+
+#include <memory>
+
+
+/**
+    Immutable string shared by all instances with the same content.
+
+    This is useful for values that repeat many times, such as gettext flags
+    of catalog items (", c-format" etc.) or source paths in PO references:
+    their text is stored only once and comparing them is just a pointer
+    comparison.
+
+    Interning is thread-safe. The shared text is released when the last
+    instance using it is destroyed.
+ */
+class InternedString
+{
+public:
+    InternedString() {}
+    InternedString(const wxString& s);
+    InternedString(const char *s) : InternedString(wxString(s)) {}
+    InternedString(const wchar_t *s) : InternedString(wxString(s)) {}
+
+    const wxString& str() const { return m_data ? *m_data : EmptyString(); }
+    operator const wxString&() const { return str(); }
+
+    bool empty() const { return !m_data; }
+
+    bool operator==(const InternedString& other) const { return m_data == other.m_data; }
+    bool operator!=(const InternedString& other) const { return m_data != other.m_data; }
+
+private:
+    static const wxString& EmptyString();
+
+    std::shared_ptr<const wxString> m_data;
+};
+
+#endif // Poedit_interned_string_h
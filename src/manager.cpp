@@ -605,27 +605,10 @@ void ManagerFrame::OnUpdateProject(wxCommandEvent&)
 
         auto cancellation = std::make_shared<dispatch::cancellation_token>();
         wxWindowPtr<ProgressWindow> progress(new ProgressWindow(this, _("Updating project catalogs"), cancellation));
+        auto files = m_catalogs;
         progress->RunTaskThenDo([=]()
         {
-            Progress progress((int)m_catalogs.GetCount());
-
-            for (size_t i = 0; i < m_catalogs.GetCount(); i++)
-            {
-                if (cancellation->is_cancelled())
-                    return;
-
-                wxString f = m_catalogs[i];
-
-                Progress subtask(1, progress, 1);
-
-                auto cat = POCatalog::Create(f);
-                if (auto merged = PerformUpdateFromSourcesSimple(cat))
-                {
-                    Catalog::ValidationResults validation_results;
-                    Catalog::CompilationStatus mo_status;
-                    merged.updated_catalog->Save(f, false, validation_results, mo_status);
-                }
-             }
+            PerformUpdateFromSourcesBatch(files, cancellation);
         },
         [progress, this]()
         {
@@ -781,6 +781,12 @@ public:
         sizer->AddSpacer(PX(1));
         sizer->Add(buttonSizer, wxSizerFlags().BORDER_MACOS(wxLEFT, PX(1)));
 
+        m_background = new wxCheckBox(this, wxID_ANY, _("Watch source code for changes and extract strings in the background"));
+        sizer->AddSpacer(PX(10));
+        sizer->Add(m_background);
+        auto backgroundExplain = new ExplanationLabel(this, _(L"Updating from source code will be nearly instantaneous and the number of new and removed strings will be shown in the status bar. Recommended for projects you actively develop."));
+        sizer->Add(backgroundExplain, wxSizerFlags().Expand().Border(wxLEFT, UnderCheckboxIndent()));
+
         ColorScheme::SetupWindowColors(this, [=]
         {
             customExLabel->SetForegroundColour(ExplanationLabel::GetTextColor());
@@ -799,6 +805,9 @@ public:
         m_delete->Bind(wxEVT_BUTTON, &ExtractorsPageWindow::OnDeleteExtractor, this);
 
         m_list->Bind(wxEVT_CHECKLISTBOX, &ExtractorsPageWindow::OnEnableExtractor, this);
+
+        if (wxPreferencesEditor::ShouldApplyChangesImmediately())
+            m_background->Bind(wxEVT_CHECKBOX, &ExtractorsPageWindow::TransferDataFromWindowAndUpdateUI, this);
         m_list->Bind(wxEVT_LISTBOX_DCLICK, &ExtractorsPageWindow::OnEditExtractor, this);
 
         m_edit->Bind(wxEVT_UPDATE_UI, [=](wxUpdateUIEvent& e) { e.Enable(m_list->GetSelection() != wxNOT_FOUND); });
@@ -841,11 +850,21 @@ public:
             m_list->SetSelection(0);
             m_list->EnsureVisible(0);
         }
+
+        m_background->SetValue(Config::UpdateFromSourcesInBackground());
     }
 
     void SaveValues(wxConfigBase& cfg) override
     {
         m_extractors.Write(&cfg);
+        Config::UpdateFromSourcesInBackground(m_background->GetValue());
+
+        // On Windows, we must update the UI here; on other platforms, it was done
+        // via TransferDataFromWindowAndUpdateUI immediately:
+        if (!wxPreferencesEditor::ShouldApplyChangesImmediately())
+        {
+            PoeditFrame::UpdateAllAfterPreferencesChange();
+        }
     }
 
 private:
@@ -1088,6 +1107,7 @@ private:
 
     wxCheckListBox *m_list;
     wxButton *m_new, *m_edit, *m_delete;
+    wxCheckBox *m_background;
 };
 
 class ExtractorsPage : public wxPreferencesPage
@@ -26,6 +26,7 @@
 #include "utility.h"
 
 #include <stdio.h>
+#include <string.h>
 
 #include <wx/filename.h>
 #include <wx/log.h>
@@ -42,6 +43,11 @@
     #include <sys/types.h>
     #include <sys/stat.h>
     #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+#endif
+#ifdef __WXMSW__
+    #include <wx/msw/wrapwin.h>
 #endif
 
 #include "str_helpers.h"
@@ -336,6 +342,128 @@ TempOutputFileFor::~TempOutputFileFor()
 #endif
 }
 
+// ----------------------------------------------------------------------
+// MappedFile
+// ----------------------------------------------------------------------
+
+bool MappedFile::Open(const wxString& filename)
+{
+    Close();
+
+#ifdef __UNIX__
+    int fd = open(filename.fn_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    m_size = (size_t)st.st_size;
+    if (m_size > 0)
+    {
+        void *addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            close(fd);
+            m_size = 0;
+            return false;
+        }
+        // we're going to read the whole file sequentially:
+        madvise(addr, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(addr);
+    }
+
+    // the mapping stays valid after closing the descriptor:
+    close(fd);
+#endif // __UNIX__
+
+#ifdef __WXMSW__
+    HANDLE file = ::CreateFileW(filename.wc_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(file, &size))
+    {
+        Close();
+        return false;
+    }
+
+    m_size = (size_t)size.QuadPart;
+    if (m_size > 0)
+    {
+        m_mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping)
+        {
+            Close();
+            return false;
+        }
+        m_data = static_cast<const char*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!m_data)
+        {
+            Close();
+            return false;
+        }
+    }
+#endif // __WXMSW__
+
+    m_ok = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef __UNIX__
+    if (m_data)
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+#ifdef __WXMSW__
+    if (m_data)
+        ::UnmapViewOfFile(m_data);
+    if (m_mapping)
+        ::CloseHandle(m_mapping);
+    if (m_file)
+        ::CloseHandle(m_file);
+    m_mapping = m_file = nullptr;
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_ok = false;
+}
+
+
+uint64_t HashBytes(const char *data, size_t size)
+{
+    // Not a cryptographic hash, it only needs to detect changes to files
+    // (together with their size and mtime) and be fast on multi-MB files:
+    const uint64_t k = 0xff51afd7ed558ccdULL;
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ size;
+
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * k;
+        h ^= h >> 32;
+    }
+
+    uint64_t tail = 0;
+    if (i < size)
+        memcpy(&tail, data + i, size - i);
+    h = (h ^ tail) * k;
+    h ^= h >> 33;
+    return h;
+}
+
+
 #ifdef __WXMSW__
 wxString CliSafeFileName(const wxString& fn)
 {
@@ -26,6 +26,7 @@
 #ifndef Poedit_utility_h
 #define Poedit_utility_h
 
+#include <stdint.h>
 #include <map>
 
 #include <wx/arrstr.h>
@@ -290,6 +291,48 @@ public:
 };
 
 
+/// Read-only memory mapping of a file's content.
+/// The mapping is released when the object is destroyed, so any pointers
+/// obtained from Data() must not outlive it.
+class MappedFile
+{
+public:
+    MappedFile() {}
+    explicit MappedFile(const wxString& filename) { Open(filename); }
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Maps the file into memory, returns false on failure.
+    /// Empty files are opened successfully, but have no data.
+    bool Open(const wxString& filename);
+    void Close();
+
+    bool IsOk() const { return m_ok; }
+
+    const char *Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+    const char *begin() const { return m_data; }
+    const char *end() const { return m_data + m_size; }
+
+private:
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+    bool m_ok = false;
+#ifdef __WXMSW__
+    void *m_file = nullptr;
+    void *m_mapping = nullptr;
+#endif
+};
+
+
+/// Fast non-cryptographic hash of the data, suitable for detecting changes
+/// in files' content.
+uint64_t HashBytes(const char *data, size_t size);
+
+
 #ifdef __WXMSW__
 /// Return filename safe for passing to CLI tools (gettext).
 /// Uses 8.3 short names to avoid Unicode and codepage issues.
@@ -0,0 +1,164 @@
+#!/bin/sh
+#
+# Checks that Poedit produces the same output as GNU gettext tools:
+#
+#   - PO files saved by Poedit must be formatted exactly as msgcat formats
+#     them, with any wrapping width and line endings.
+#
+#   - Poedit's native extractor must give the same output as xgettext for
+#     the C and C++ sources in tests/sources.
+#
+#   - Extracting from source files in parts, possibly cached, must give the
+#     same POT file as extracting from all of them at once.
+#
+# Expected outputs aren't stored anywhere, they are produced by the gettext
+# tools installed on the system. Run by "make check", or directly with
+# GETTEXT_COMPAT set to the gettext-compat driver to use.
+#
+
+: "${srcdir:=.}"
+: "${GETTEXT_COMPAT:=./gettext-compat}"
+
+if ! command -v msgcat >/dev/null 2>&1; then
+    echo "msgcat not found, skipping"
+    exit 77
+fi
+
+tmp=$(mktemp -d "${TMPDIR:-/tmp}/gettext-compat.XXXXXX") || exit 1
+trap 'rm -rf "$tmp"' EXIT
+
+failed=0
+
+# check_same EXPECTED ACTUAL DESCRIPTION
+check_same()
+{
+    if cmp -s "$1" "$2"; then
+        echo "PASS: $3"
+    else
+        echo "FAIL: $3"
+        diff -u "$1" "$2" | head -n 50
+        failed=1
+    fi
+}
+
+# width_option WIDTH: prints option for WIDTH, which is a number or "no-wrap"
+width_option()
+{
+    case "$1" in
+        no-wrap) echo "--no-wrap" ;;
+        *)       echo "--width=$1" ;;
+    esac
+}
+
+
+#
+# PO files formatting:
+#
+
+for po in "$srcdir"/po/*.po "$srcdir"/po/*.pot "$srcdir"/its/*.po; do
+    name=$(basename "$po")
+
+    # Files are first formatted by msgcat with some width and then saved with
+    # another one, so that Poedit both reformats entries and keeps those that
+    # are already formatted as they should be:
+    for from in 79 60 no-wrap; do
+        from_opt=$(width_option $from)
+        input="$tmp/input-$from-$name"
+        msgcat --force-po $from_opt -o "$input" "$po" || { failed=1; continue; }
+
+        for to in 79 40 60 100 no-wrap; do
+            to_opt=$(width_option $to)
+            "$GETTEXT_COMPAT" format $to_opt "$input" "$tmp/saved.po" || { echo "FAIL: saving $name"; failed=1; continue; }
+            msgcat --force-po $to_opt -o "$tmp/expected.po" "$tmp/saved.po"
+            check_same "$tmp/expected.po" "$tmp/saved.po" "$name formatted with $from_opt, saved with $to_opt"
+        done
+
+        "$GETTEXT_COMPAT" format --keep $from_opt "$input" "$tmp/saved.po" || { echo "FAIL: saving $name"; failed=1; continue; }
+        msgcat --force-po $from_opt -o "$tmp/expected.po" "$tmp/saved.po"
+        check_same "$tmp/expected.po" "$tmp/saved.po" "$name formatted with $from_opt, saved keeping its formatting"
+    done
+
+    # msgcat doesn't handle DOS line endings well, so give it the same content
+    # with Unix line endings and convert its output instead:
+    "$GETTEXT_COMPAT" format --dos "$po" "$tmp/saved.po" || { echo "FAIL: saving $name"; failed=1; continue; }
+    tr -d '\r' < "$tmp/saved.po" > "$tmp/unix.po"
+    msgcat --force-po "$tmp/unix.po" | awk '{ printf "%s\r\n", $0 }' > "$tmp/expected.po"
+    check_same "$tmp/expected.po" "$tmp/saved.po" "$name saved with DOS line endings"
+done
+
+
+#
+# Extraction:
+#
+
+if ! command -v xgettext >/dev/null 2>&1; then
+    echo "SKIP: xgettext not found, extraction not checked"
+    exit $failed
+fi
+
+# check_same_pot EXPECTED ACTUAL DESCRIPTION: same as check_same, but ignores
+# POT-Creation-Date, which differs between extractions
+check_same_pot()
+{
+    grep -v '^"POT-Creation-Date:' "$1" > "$1.cmp"
+    grep -v '^"POT-Creation-Date:' "$2" > "$2.cmp"
+    check_same "$1.cmp" "$2.cmp" "$3"
+}
+
+# Poedit's native extractor must give the same output as xgettext, for files
+# that it scans itself as well as with some files passed to xgettext:
+for tree in native fallback; do
+    sources="$srcdir/sources/$tree"
+    "$GETTEXT_COMPAT" extract --extractor=gettext --serial "$sources" "$tmp/xgettext.pot" || { echo "FAIL: xgettext extraction from $tree"; failed=1; continue; }
+    WXTRACE=poedit.extractor "$GETTEXT_COMPAT" extract --extractor=native-c --serial "$sources" "$tmp/native.pot" 2> "$tmp/trace.txt"
+    check_same_pot "$tmp/xgettext.pot" "$tmp/native.pot" "native extraction from $tree sources"
+
+    # All files in sources/native must be scanned natively (if tracing is
+    # available in the build):
+    if [ "$tree" = native ] && grep -q "files natively" "$tmp/trace.txt"; then
+        if ! grep -q "files natively, 0 passed to xgettext" "$tmp/trace.txt"; then
+            echo "FAIL: some files in $tree sources passed to xgettext"
+            failed=1
+        fi
+    fi
+done
+
+# Generate more files than are extracted in a single part, with some strings
+# present in files from different parts:
+tree="$tmp/tree"
+mkdir -p "$tree/sub"
+i=0
+while [ $i -lt 260 ]; do
+    dir="$tree"
+    [ $((i % 3)) -eq 0 ] && dir="$tree/sub"
+    cat > "$dir/file$i.c" <<EOF
+/* TRANSLATORS: Comment in file $i. */
+const char *a = gettext("String from file $i");
+const char *b = gettext("String shared by files ending with $((i % 10))");
+const char *c = ngettext("One item in file $i", "%d items in file $i", n);
+EOF
+    i=$((i + 1))
+done
+
+for extractor in gettext native-c; do
+    "$GETTEXT_COMPAT" extract --extractor=$extractor --serial "$tree" "$tmp/serial.pot" || { echo "FAIL: $extractor extraction"; failed=1; continue; }
+
+    "$GETTEXT_COMPAT" extract --extractor=$extractor "$tree" "$tmp/parts.pot"
+    check_same_pot "$tmp/serial.pot" "$tmp/parts.pot" "$extractor extraction in parts"
+
+    rm -rf "$tmp/cache"
+    "$GETTEXT_COMPAT" extract --extractor=$extractor --cache="$tmp/cache" "$tree" "$tmp/parts.pot"
+    check_same_pot "$tmp/serial.pot" "$tmp/parts.pot" "$extractor extraction in parts, cache empty"
+    "$GETTEXT_COMPAT" extract --extractor=$extractor --cache="$tmp/cache" "$tree" "$tmp/parts.pot"
+    check_same_pot "$tmp/serial.pot" "$tmp/parts.pot" "$extractor extraction in parts, all files cached"
+
+    # A modified file is extracted on its own and the cached output of its
+    # group can't be used anymore:
+    echo "const char *d = gettext(\"String added for $extractor\");" >> "$tree/file42.c"
+    "$GETTEXT_COMPAT" extract --extractor=$extractor --serial "$tree" "$tmp/serial.pot"
+    "$GETTEXT_COMPAT" extract --extractor=$extractor --cache="$tmp/cache" "$tree" "$tmp/parts.pot"
+    check_same_pot "$tmp/serial.pot" "$tmp/parts.pot" "$extractor extraction in parts, file modified"
+done
+
+
+exit $failed
@@ -0,0 +1,279 @@
+/*
+ *  This file is part of Poedit (https://poedit.com)
+ *
+ *  Copyright (C) 2026 Vaclav Slavik
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a
+ *  copy of this software and associated documentation files (the "Software"),
+ *  to deal in the Software without restriction, including without limitation
+ *  the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *  and/or sell copies of the Software, and to permit persons to whom the
+ *  Software is furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *  DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+/*
+    Command line driver for check_gettext_compat.sh, which compares Poedit's
+    output with gettext tools' output for the same input.
+
+    Usage:
+
+      gettext-compat format [--width=N|--no-wrap|--keep] [--dos] INPUT.po OUTPUT.po
+
+        Loads INPUT.po and saves it as OUTPUT.po with given formatting options,
+        as if they were set in preferences. With --keep, the file's existing
+        wrapping and line endings are preserved.
+
+      gettext-compat extract [--extractor=ID [--serial]] [--cache=DIR] SOURCES OUTPUT.pot
+
+        Extracts strings from all files in SOURCES directory into OUTPUT.pot,
+        as updating from sources does. With --extractor, only the extractor
+        with given ID (e.g. "gettext" or "native-c") is used, for the files
+        it supports; its files are extracted in parts, unless --serial is
+        used to extract them all at once. --cache enables the extraction
+        cache, with cache files stored in DIR.
+
+    Commands run on a background thread, as they would in Poedit, while the
+    main thread runs the event loop needed for running gettext tools.
+ */
+
+#include "catalog_po.h"
+#include "concurrency.h"
+#include "errors.h"
+#include "extractors/extraction_cache.h"
+#include "extractors/extractor.h"
+
+#include <wx/app.h>
+#include <wx/cmdline.h>
+#include <wx/config.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+#include <wx/memconf.h>
+
+#include <stdio.h>
+#include <vector>
+
+
+namespace
+{
+
+const char *CL_WIDTH = "width";
+const char *CL_NO_WRAP = "no-wrap";
+const char *CL_KEEP = "keep";
+const char *CL_DOS = "dos";
+const char *CL_EXTRACTOR = "extractor";
+const char *CL_SERIAL = "serial";
+const char *CL_CACHE = "cache";
+
+/// Parsed command line
+struct Options
+{
+    wxString command;
+    std::vector<wxString> files;
+
+    long width = 79;
+    bool noWrap = false;
+    bool keep = false;
+    bool dos = false;
+
+    wxString extractor;
+    bool serial = false;
+    wxString cacheDir;
+};
+
+
+int Format(const Options& opt)
+{
+    if (opt.files.size() != 2)
+    {
+        fprintf(stderr, "format: expected INPUT and OUTPUT files\n");
+        return 2;
+    }
+
+    auto cfg = wxConfigBase::Get();
+    cfg->Write("keep_crlf", opt.keep);
+    cfg->Write("wrap_po_files", !opt.noWrap);
+    cfg->Write("wrap_po_files_width", opt.width);
+    cfg->Write("crlf_format", opt.dos ? "win" : "unix");
+
+    auto catalog = POCatalog::Create(opt.files[0]);
+
+    Catalog::ValidationResults validation;
+    Catalog::CompilationStatus mo_status;
+    if (!catalog->Save(opt.files[1], /*save_mo=*/false, validation, mo_status))
+        return 1;
+
+    return 0;
+}
+
+
+int Extract(const Options& opt)
+{
+    if (opt.files.size() != 2)
+    {
+        fprintf(stderr, "extract: expected SOURCES directory and OUTPUT file\n");
+        return 2;
+    }
+
+    wxFileName basepath = wxFileName::DirName(opt.files[0]);
+    basepath.MakeAbsolute();
+
+    SourceCodeSpec spec;
+    spec.BasePath = basepath.GetFullPath();
+    spec.SearchPaths.push_back(".");
+    spec.Charset = "UTF-8";
+
+    if (!opt.cacheDir.empty())
+        ExtractionCache::Enable(opt.cacheDir);
+
+    auto cancellation = std::make_shared<dispatch::cancellation_token>();
+    auto files = Extractor::CollectAllFiles(spec, cancellation);
+
+    TempDirectory tmpdir;
+    ExtractionOutput output;
+
+    if (opt.extractor.empty())
+    {
+        output = Extractor::ExtractWithAll(tmpdir, spec, files, cancellation);
+    }
+    else
+    {
+        std::shared_ptr<Extractor> extractor;
+        for (auto& ex: Extractor::CreateAllExtractors(spec))
+        {
+            if (ex->GetId() == opt.extractor)
+            {
+                extractor = ex;
+                break;
+            }
+        }
+        if (!extractor)
+        {
+            fprintf(stderr, "extract: unknown extractor: %s\n", opt.extractor.utf8_str().data());
+            return 2;
+        }
+
+        files = extractor->FilterFiles(files);
+        if (opt.serial)
+            output = extractor->Extract(tmpdir, spec, files);
+        else
+            output = extractor->ExtractIncrementally(tmpdir, spec, files, cancellation);
+    }
+
+    if (!output || !wxCopyFile(output.pot_file, opt.files[1]))
+        return 1;
+
+    return 0;
+}
+
+
+int Run(const Options& opt)
+{
+    if (opt.command == "format")
+        return Format(opt);
+    if (opt.command == "extract")
+        return Extract(opt);
+
+    fprintf(stderr, "unknown command: %s\n", opt.command.utf8_str().data());
+    return 2;
+}
+
+} // anonymous namespace
+
+
+class GettextCompatApp : public wxAppConsole
+{
+public:
+    bool OnInit() override
+    {
+        // Don't touch user's Poedit settings:
+        wxConfigBase::Set(new wxMemoryConfig);
+
+        if (!wxAppConsole::OnInit())
+            return false;
+
+        dispatch::async([opt = m_options]
+        {
+            try
+            {
+                return Run(opt);
+            }
+            catch (...)
+            {
+                fprintf(stderr, "error: %s\n", DescribeCurrentException().utf8_str().data());
+                return 2;
+            }
+        })
+        .then_on_main([this](int exitCode)
+        {
+            m_exitCode = exitCode;
+            ExitMainLoop();
+        });
+
+        return true;
+    }
+
+    int OnRun() override
+    {
+        wxAppConsole::OnRun();
+        return m_exitCode;
+    }
+
+    int OnExit() override
+    {
+        dispatch::cleanup();
+        return wxAppConsole::OnExit();
+    }
+
+    void OnInitCmdLine(wxCmdLineParser& parser) override
+    {
+        wxAppConsole::OnInitCmdLine(parser);
+
+        parser.AddLongOption(CL_WIDTH, "wrap lines at given width", wxCMD_LINE_VAL_NUMBER);
+        parser.AddLongSwitch(CL_NO_WRAP, "don't wrap lines");
+        parser.AddLongSwitch(CL_KEEP, "keep file's wrapping and line endings");
+        parser.AddLongSwitch(CL_DOS, "use DOS line endings");
+        parser.AddLongOption(CL_EXTRACTOR, "use only extractor with given ID");
+        parser.AddLongSwitch(CL_SERIAL, "extract all files at once");
+        parser.AddLongOption(CL_CACHE, "use extraction cache in given directory");
+        parser.AddParam("command", wxCMD_LINE_VAL_STRING);
+        parser.AddParam("files", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_MULTIPLE);
+    }
+
+    bool OnCmdLineParsed(wxCmdLineParser& parser) override
+    {
+        if (!wxAppConsole::OnCmdLineParsed(parser))
+            return false;
+
+        m_options.command = parser.GetParam(0);
+        for (size_t i = 1; i < parser.GetParamCount(); i++)
+            m_options.files.push_back(parser.GetParam(i));
+
+        parser.Found(CL_WIDTH, &m_options.width);
+        m_options.noWrap = parser.Found(CL_NO_WRAP);
+        m_options.keep = parser.Found(CL_KEEP);
+        m_options.dos = parser.Found(CL_DOS);
+        parser.Found(CL_EXTRACTOR, &m_options.extractor);
+        m_options.serial = parser.Found(CL_SERIAL);
+        parser.Found(CL_CACHE, &m_options.cacheDir);
+
+        return true;
+    }
+
+private:
+    Options m_options;
+    int m_exitCode = 2;
+};
+
+wxIMPLEMENT_APP_CONSOLE(GettextCompatApp);
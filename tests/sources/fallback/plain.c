@@ -0,0 +1,13 @@
+/*
+ * Sample C source handled by Poedit's native extractor, in the same tree as
+ * files that it passes to xgettext. Strings aren't shared with those files,
+ * so that the output doesn't depend on the order of files.
+ */
+
+#include <libintl.h>
+
+const char *plain_message(void)
+{
+    /* TRANSLATORS: Extracted natively. */
+    return gettext("Plain message");
+}
@@ -0,0 +1,13 @@
+/*
+ * Sample C source with format strings that Poedit's native extractor doesn't
+ * classify itself and passes to xgettext.
+ */
+
+#include <libintl.h>
+#include <stdio.h>
+
+void print_copy(const char *from, const char *to)
+{
+    printf(gettext("Copying %2$s to %1$s"), to, from);
+    printf(gettext("Error: %m"));
+}
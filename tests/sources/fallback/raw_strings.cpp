@@ -0,0 +1,15 @@
+// Sample C++ source with raw string literals, which Poedit's native extractor
+// passes to xgettext.
+
+#include <libintl.h>
+
+const char *raw_message()
+{
+    return gettext(R"(Raw "string" with \ backslashes)");
+}
+
+const char *regular_message()
+{
+    // TRANSLATORS: In a file extracted by xgettext.
+    return gettext("Regular message next to a raw string");
+}
@@ -0,0 +1,15 @@
+/*
+ * Sample C source with special xgettext comments, which Poedit's native
+ * extractor passes to xgettext.
+ */
+
+#include <libintl.h>
+#include <stdio.h>
+
+void print_progress(int percent)
+{
+    /* xgettext:no-c-format */
+    puts(gettext("100% done"));
+
+    printf(gettext("%d%% complete"), percent);
+}
@@ -0,0 +1,18 @@
+/*
+ * Sample C header for comparing Poedit's native extractor with xgettext.
+ */
+
+#ifndef APP_H
+#define APP_H
+
+#define APP_NAME gettext("Sample Application")
+
+/* TRANSLATORS: Name of the application's main window. */
+#define MAIN_WINDOW_TITLE gettext("Main Window")
+
+static inline const char *app_description(void)
+{
+    return gettext("Application used for testing string extraction.");
+}
+
+#endif /* APP_H */
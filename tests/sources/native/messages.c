@@ -0,0 +1,74 @@
+/*
+ * Sample C source for comparing Poedit's native extractor with xgettext.
+ * Only uses constructs that the native extractor handles itself.
+ */
+
+#include <libintl.h>
+#include <stdio.h>
+
+#include "include/app.h"
+
+static const char *names[] = {
+    gettext_noop("Red"),
+    gettext_noop("Green"),
+    gettext_noop("Blue")
+};
+
+void print_summary(int files, int errors, const char *name)
+{
+    /* TRANSLATORS: Shown when processing finished. */
+    puts(gettext("Done."));
+
+    // TRANSLATORS: %d is the number of files, always more than one.
+    printf(gettext("Processed %d files.\n"), files);
+
+    printf(ngettext("Found %d error", "Found %d errors", errors), errors);
+
+    /* This comment isn't extracted, because it doesn't have the tag. */
+    puts(gettext("Untagged comment"));
+
+    /* TRANSLATORS: A comment spanning
+       several lines, which are all
+       extracted. */
+    puts(gettext("Multi-line comment"));
+
+    // TRANSLATORS: Comments on consecutive lines
+    // are extracted together.
+    // Even those without the tag.
+    puts(gettext("Consecutive comments"));
+
+    /* TRANSLATORS: Forgotten, because code follows on the same line. */ int unused = 0;
+    puts(gettext("Comment forgotten"));
+
+    printf(gettext("Hello, %s!"), name);
+
+    puts(gettext("Adjacent literals "
+                 "are concatenated "
+                 "into one string."));
+
+    puts(gettext("Escapes: \"quotes\", \\backslash, \ttab and newline\n"));
+    puts(gettext("Octal \101\102\103 and hex \x44\x45\x46 escapes"));
+    puts(gettext("Unicode escape: caf\u00e9"));
+    puts(gettext("Non-ASCII text: Příliš žluťoučký kůň úpěl ďábelské ódy"));
+
+    puts(pgettext("menu", "Open"));
+    puts(pgettext("verb", "Open"));
+    printf(npgettext("status", "%d file selected", "%d files selected", files), files);
+
+    puts(dgettext("domain", "String from a domain"));
+    puts(dcgettext("domain", "String from a domain and category", LC_MESSAGES));
+
+    /* Strings used repeatedly have all their references listed: */
+    puts(gettext("Done."));
+
+    /* Calls with a variable aren't extracted: */
+    puts(gettext(name));
+
+    /* Several calls in one statement: */
+    printf(gettext("Outer %s"), gettext("inner"));
+
+    puts(gettext("A string long enough to be wrapped by xgettext, because it doesn't fit on a single line of the POT file."));
+
+    (void)names;
+    (void)unused;
+}
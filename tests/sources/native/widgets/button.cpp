@@ -0,0 +1,45 @@
+// Sample C++ source for comparing Poedit's native extractor with xgettext.
+// Only uses constructs that the native extractor handles itself.
+
+#include <libintl.h>
+
+#include <string>
+#include <vector>
+
+namespace widgets
+{
+
+template<typename T>
+class Button
+{
+public:
+    explicit Button(T handler) : m_handler(handler), m_label(gettext("Click me")) {}
+
+    std::string Tooltip(int clicks) const
+    {
+        // TRANSLATORS: %d is how many times the button was clicked.
+        return ngettext("Clicked %d time", "Clicked %d times", clicks);
+    }
+
+    std::vector<std::string> Actions() const
+    {
+        auto label = [](const char *context) { return pgettext("button", "Press"); };
+        return { label("a"), gettext("Release"), gettext("Hold") };
+    }
+
+    char Shortcut() const { return 'c'; }
+
+    const char *Description() const
+    {
+        return gettext("A button, which is a \"widget\" "
+                       "that can be clicked.");
+    }
+
+    std::string Encoded() const { return u8"not extracted"; }
+
+private:
+    T m_handler;
+    std::string m_label;
+};
+
+} // namespace widgets